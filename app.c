@@ -28,11 +28,14 @@
  *
  ******************************************************************************/
 #include "app.h"
+#include "kmesh.h"
 
 void app_init(void)
 {
+  kmesh_init();
 }
 
 void app_process_action(void)
 {
+  kmesh_process_action();
 }
@@ -384,6 +384,70 @@ void setWhiteningInitVal(sl_cli_command_arg_t *arguments);
 void setCrcInitVal(sl_cli_command_arg_t *arguments);
 void resetWhiteningInitVal(sl_cli_command_arg_t *arguments);
 void resetCrcInitVal(sl_cli_command_arg_t *arguments);
+void cliSeparatorHack(sl_cli_command_arg_t *arguments);
+void setNodeAddress(sl_cli_command_arg_t *arguments);
+void setRouting(sl_cli_command_arg_t *arguments);
+void addRoute(sl_cli_command_arg_t *arguments);
+void removeRoute(sl_cli_command_arg_t *arguments);
+void printRoutes(sl_cli_command_arg_t *arguments);
+void advertiseRoutes(sl_cli_command_arg_t *arguments);
+void meshTx(sl_cli_command_arg_t *arguments);
+void getMeshCounters(sl_cli_command_arg_t *arguments);
+void configArq(sl_cli_command_arg_t *arguments);
+void meshTxAck(sl_cli_command_arg_t *arguments);
+void getArqCounters(sl_cli_command_arg_t *arguments);
+void meshTxAggr(sl_cli_command_arg_t *arguments);
+void configAggr(sl_cli_command_arg_t *arguments);
+void flushAggr(sl_cli_command_arg_t *arguments);
+void getAggrCounters(sl_cli_command_arg_t *arguments);
+void meshCrc(sl_cli_command_arg_t *arguments);
+void compileScript(sl_cli_command_arg_t *arguments);
+void runCompiledScript(sl_cli_command_arg_t *arguments);
+void stopCompiledScript(sl_cli_command_arg_t *arguments);
+void printCompiledScript(sl_cli_command_arg_t *arguments);
+void clearCompiledScript(sl_cli_command_arg_t *arguments);
+void getScriptVariables(sl_cli_command_arg_t *arguments);
+void saveScript(sl_cli_command_arg_t *arguments);
+void loadScript(sl_cli_command_arg_t *arguments);
+void deleteScript(sl_cli_command_arg_t *arguments);
+void listScripts(sl_cli_command_arg_t *arguments);
+void setScriptAutorun(sl_cli_command_arg_t *arguments);
+void getConsoleCounters(sl_cli_command_arg_t *arguments);
+void setRxLog(sl_cli_command_arg_t *arguments);
+void getRxLogCounters(sl_cli_command_arg_t *arguments);
+void setNotifySummary(sl_cli_command_arg_t *arguments);
+void setPrintRateLimit(sl_cli_command_arg_t *arguments);
+void getStackUsage(sl_cli_command_arg_t *arguments);
+void getSlabCounters(sl_cli_command_arg_t *arguments);
+void setListenMode(sl_cli_command_arg_t *arguments);
+void getPowerResidency(sl_cli_command_arg_t *arguments);
+void setConsoleSleep(sl_cli_command_arg_t *arguments);
+void getIdleCounters(sl_cli_command_arg_t *arguments);
+void getEnergy(sl_cli_command_arg_t *arguments);
+void getTxEnergy(sl_cli_command_arg_t *arguments);
+void setTxPowerControl(sl_cli_command_arg_t *arguments);
+void getTxPowerControl(sl_cli_command_arg_t *arguments);
+void setRateAdaptation(sl_cli_command_arg_t *arguments);
+void getLinkRates(sl_cli_command_arg_t *arguments);
+void setMeshLbt(sl_cli_command_arg_t *arguments);
+void getLbtChannels(sl_cli_command_arg_t *arguments);
+void getLbtStats(sl_cli_command_arg_t *arguments);
+void getLbtHistogram(sl_cli_command_arg_t *arguments);
+void lbtBenchmark(sl_cli_command_arg_t *arguments);
+void setRssiStream(sl_cli_command_arg_t *arguments);
+void getRssiStreamCounters(sl_cli_command_arg_t *arguments);
+void batchTxAdd(sl_cli_command_arg_t *arguments);
+void batchTxClear(sl_cli_command_arg_t *arguments);
+void batchTxList(sl_cli_command_arg_t *arguments);
+void batchTxStart(sl_cli_command_arg_t *arguments);
+void batchTxStop(sl_cli_command_arg_t *arguments);
+void prbsTxStart(sl_cli_command_arg_t *arguments);
+void prbsTxStop(sl_cli_command_arg_t *arguments);
+void setPrbsRx(sl_cli_command_arg_t *arguments);
+void getPrbsRx(sl_cli_command_arg_t *arguments);
+void getPrbsErrors(sl_cli_command_arg_t *arguments);
+void meshThroughput(sl_cli_command_arg_t *arguments);
+void meshThroughputStop(sl_cli_command_arg_t *arguments);
 
 // Command structs. Names are in the format : cli_cmd_{command group name}_{command name}
 // In order to support hyphen in command and group name, every occurence of it while
@@ -1960,6 +2024,390 @@ static const sl_cli_command_info_t cli_cmd__resetCrcInitVal = \
                   "",
                  {SL_CLI_ARG_END, });
 
+static const sl_cli_command_info_t cli_cmd_________kmesh_Mesh_Networking_____ = \
+  SL_CLI_COMMAND(cliSeparatorHack,
+                 "",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setNodeAddress = \
+  SL_CLI_COMMAND(setNodeAddress,
+                 "Get or set the kmesh node address.",
+                  "address" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setRouting = \
+  SL_CLI_COMMAND(setRouting,
+                 "Enable route advertisements and next-hop forwarding.",
+                  "0=Disable 1=Enable" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__addRoute = \
+  SL_CLI_COMMAND(addRoute,
+                 "Add a static route to the kmesh routing table.",
+                  "destination" SL_CLI_UNIT_SEPARATOR "nextHop" SL_CLI_UNIT_SEPARATOR "[1] metric" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__removeRoute = \
+  SL_CLI_COMMAND(removeRoute,
+                 "Remove a route from the kmesh routing table.",
+                  "destination" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__printRoutes = \
+  SL_CLI_COMMAND(printRoutes,
+                 "Print the kmesh routing table.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__advertiseRoutes = \
+  SL_CLI_COMMAND(advertiseRoutes,
+                 "Send a route advertisement now.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__meshTx = \
+  SL_CLI_COMMAND(meshTx,
+                 "Send a kmesh data frame via the routing table.",
+                  "destination" SL_CLI_UNIT_SEPARATOR "byte0 byte1 ..." SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getMeshCounters = \
+  SL_CLI_COMMAND(getMeshCounters,
+                 "Print kmesh origination and forwarding counters.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__configArq = \
+  SL_CLI_COMMAND(configArq,
+                 "Configure kmesh ACK retries and exponential backoff.",
+                  "retries" SL_CLI_UNIT_SEPARATOR "minBo" SL_CLI_UNIT_SEPARATOR "maxBo" SL_CLI_UNIT_SEPARATOR "backoffUs" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT16, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__meshTxAck = \
+  SL_CLI_COMMAND(meshTxAck,
+                 "Send a kmesh data frame with acknowledgement and retries.",
+                  "destination" SL_CLI_UNIT_SEPARATOR "byte0 byte1 ..." SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getArqCounters = \
+  SL_CLI_COMMAND(getArqCounters,
+                 "Print kmesh delivered/retried/failed counters.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__meshTxAggr = \
+  SL_CLI_COMMAND(meshTxAggr,
+                 "Queue a kmesh message for aggregation with others to the same next hop.",
+                  "destination" SL_CLI_UNIT_SEPARATOR "byte0 byte1 ..." SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__configAggr = \
+  SL_CLI_COMMAND(configAggr,
+                 "Set the kmesh aggregation flush deadline and maximum frame length.",
+                  "flushDeadlineMs" SL_CLI_UNIT_SEPARATOR "maxLength" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT16OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__flushAggr = \
+  SL_CLI_COMMAND(flushAggr,
+                 "Transmit all open kmesh aggregates now.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getAggrCounters = \
+  SL_CLI_COMMAND(getAggrCounters,
+                 "Print kmesh aggregation counters.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__meshCrc = \
+  SL_CLI_COMMAND(meshCrc,
+                 "Compute the PHY CRC over the given payload bytes.",
+                  "byte0 byte1 ..." SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__compileScript = \
+  SL_CLI_COMMAND(compileScript,
+                 "Compile the RAM script (enterScript ... endScript) and append it to the compiled script.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__runCompiledScript = \
+  SL_CLI_COMMAND(runCompiledScript,
+                 "Play the compiled script.",
+                  "iterations, 0=until stopped [1]" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__stopCompiledScript = \
+  SL_CLI_COMMAND(stopCompiledScript,
+                 "Stop playing the compiled script.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__printCompiledScript = \
+  SL_CLI_COMMAND(printCompiledScript,
+                 "Print the compiled script.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__clearCompiledScript = \
+  SL_CLI_COMMAND(clearCompiledScript,
+                 "Clear the compiled script.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getScriptVariables = \
+  SL_CLI_COMMAND(getScriptVariables,
+                 "Print the compiled script variables and event wait timeouts.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__saveScript = \
+  SL_CLI_COMMAND(saveScript,
+                 "Save the compiled script to a flash slot.",
+                  "slot" SL_CLI_UNIT_SEPARATOR "name" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_STRING, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__loadScript = \
+  SL_CLI_COMMAND(loadScript,
+                 "Replace the compiled script with the one saved in a flash slot.",
+                  "slot" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__deleteScript = \
+  SL_CLI_COMMAND(deleteScript,
+                 "Erase a saved script slot.",
+                  "slot" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__listScripts = \
+  SL_CLI_COMMAND(listScripts,
+                 "List the saved script slots.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setScriptAutorun = \
+  SL_CLI_COMMAND(setScriptAutorun,
+                 "Load and run a saved script at every boot.",
+                  "slot, 255=off" SL_CLI_UNIT_SEPARATOR "iterations, 0=until stopped [1]" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getConsoleCounters = \
+  SL_CLI_COMMAND(getConsoleCounters,
+                 "Print console TX ring counters.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setRxLog = \
+  SL_CLI_COMMAND(setRxLog,
+                 "Enable or disable the binary RX packet log.",
+                  "enable" SL_CLI_UNIT_SEPARATOR "max payload bytes per record" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getRxLogCounters = \
+  SL_CLI_COMMAND(getRxLogCounters,
+                 "Print binary RX log counters.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setNotifySummary = \
+  SL_CLI_COMMAND(setNotifySummary,
+                 "Print RX/TX counts and RSSI every interval.",
+                  "interval ms, 0 = off" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT32, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setPrintRateLimit = \
+  SL_CLI_COMMAND(setPrintRateLimit,
+                 "Limit per-packet meshRx prints.",
+                  "prints per second, 0 = unlimited" SL_CLI_UNIT_SEPARATOR "burst" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT16OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getStackUsage = \
+  SL_CLI_COMMAND(getStackUsage,
+                 "Print main stack high-water mark and RAIL interrupt depth.",
+                  "1 = reset the marks after printing" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getSlabCounters = \
+  SL_CLI_COMMAND(getSlabCounters,
+                 "Print packet buffer usage per size class.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setListenMode = \
+  SL_CLI_COMMAND(setListenMode,
+                 "Duty-cycle the receiver so the node can sleep between RX windows.",
+                  "1 = listen duty-cycled, 0 = continuous RX" SL_CLI_UNIT_SEPARATOR "window us" SL_CLI_UNIT_SEPARATOR "sleep between windows us" SL_CLI_UNIT_SEPARATOR "1 = keep the window open on preamble" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getPowerResidency = \
+  SL_CLI_COMMAND(getPowerResidency,
+                 "Print time spent in EM0, EM1 and EM2 and listen window counts.",
+                  "1 = reset after printing" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setConsoleSleep = \
+  SL_CLI_COMMAND(setConsoleSleep,
+                 "Let the console sleep in EM2 after idleMs and wake on RX activity.",
+                  "1 = sleep when idle, 0 = stay awake" SL_CLI_UNIT_SEPARATOR "idle ms before sleeping" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getIdleCounters = \
+  SL_CLI_COMMAND(getIdleCounters,
+                 "Print how main loop passes slept against the next deadline.",
+                  "1 = reset after printing" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getEnergy = \
+  SL_CLI_COMMAND(getEnergy,
+                 "Print the estimated energy spent in TX, RX, MCU and sleep since the last reset.",
+                  "1 = reset after printing, also resets getPowerResidency" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getTxEnergy = \
+  SL_CLI_COMMAND(getTxEnergy,
+                 "Print TX packets, time and energy per PA mode, and each mode's current at the present power.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setTxPowerControl = \
+  SL_CLI_COMMAND(setTxPowerControl,
+                 "Drive TX power per neighbor down to a target RSSI reported in ACKs; the present power is the ceiling.",
+                  "1 = enable, 0 = transmit at the ceiling" SL_CLI_UNIT_SEPARATOR "target RSSI in dBm" SL_CLI_UNIT_SEPARATOR "hysteresis in dB" SL_CLI_UNIT_SEPARATOR "lowest power in deci-dBm" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_INT8OPT, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_INT16OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getTxPowerControl = \
+  SL_CLI_COMMAND(getTxPowerControl,
+                 "Print each neighbor's TX power, last reported RSSI, ACKs and misses.",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setRateAdaptation = \
+  SL_CLI_COMMAND(setRateAdaptation,
+                 "Pick a channel group (PHY) per neighbor from ACK loss and RSSI, scanning all groups on RX",
+                  "0 = disable, 1 = enable" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getLinkRates = \
+  SL_CLI_COMMAND(getLinkRates,
+                 "Show the rate and link statistics of each neighbor",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setMeshLbt = \
+  SL_CLI_COMMAND(setMeshLbt,
+                 "Listen before talk for kmesh frames: 0 off, 1 fixed threshold, 2 noise-tracking threshold and backoff",
+                  "0 = off, 1 = fixed, 2 = adaptive" SL_CLI_UNIT_SEPARATOR "Adaptive threshold above the noise floor (dB)" SL_CLI_UNIT_SEPARATOR "Fixed threshold (dBm)" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_INT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getLbtChannels = \
+  SL_CLI_COMMAND(getLbtChannels,
+                 "Show noise floor, CCA threshold, busy ratio and backoff per channel",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getLbtStats = \
+  SL_CLI_COMMAND(getLbtStats,
+                 "Show channel access delay statistics of kmesh transmissions",
+                  "1 = reset after printing" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getLbtHistogram = \
+  SL_CLI_COMMAND(getLbtHistogram,
+                 "Show the channel access delay histogram",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__lbtBenchmark = \
+  SL_CLI_COMMAND(lbtBenchmark,
+                 "Broadcast frames and report the channel access delay distribution; 0 stops",
+                  "Number of frames, 0 = stop" SL_CLI_UNIT_SEPARATOR "Payload length (bytes)" SL_CLI_UNIT_SEPARATOR "Minimum period between frames (ms)" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT32, SL_CLI_ARG_UINT16OPT, SL_CLI_ARG_UINT16OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setRssiStream = \
+  SL_CLI_COMMAND(setRssiStream,
+                 "Stream timestamped RSSI samples to the console as binary bursts",
+                  "0 = disable, 1 = enable" SL_CLI_UNIT_SEPARATOR "Sample period (us), 0 = RSSI update period of the PHY" SL_CLI_UNIT_SEPARATOR "Bursts to send before stopping, 0 = until disabled" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT16OPT, SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getRssiStreamCounters = \
+  SL_CLI_COMMAND(getRssiStreamCounters,
+                 "Show RSSI samples taken, bursts sent, samples lost and late sampling interrupts",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__batchTxAdd = \
+  SL_CLI_COMMAND(batchTxAdd,
+                 "Queue a packet for batch TX; bytes not given are filled with an incrementing pattern",
+                  "Packet length (bytes), length header included" SL_CLI_UNIT_SEPARATOR "Channel" SL_CLI_UNIT_SEPARATOR "TX power (deci-dBm), 32767 = power at batchTxStart" SL_CLI_UNIT_SEPARATOR "Start time after the start of the pass (us), 0 = back to back" SL_CLI_UNIT_SEPARATOR "byte0 byte1 ..." SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT16, SL_CLI_ARG_INT16, SL_CLI_ARG_UINT32, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__batchTxClear = \
+  SL_CLI_COMMAND(batchTxClear,
+                 "Empty the batch TX queue",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__batchTxList = \
+  SL_CLI_COMMAND(batchTxList,
+                 "Show the packets in the batch TX queue",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__batchTxStart = \
+  SL_CLI_COMMAND(batchTxStart,
+                 "Send the batch TX queue back to back; prints batchTxDone at the end",
+                  "Passes through the queue, 0 = until batchTxStop (default 1)" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__batchTxStop = \
+  SL_CLI_COMMAND(batchTxStop,
+                 "Stop batch TX after the packet in progress",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__prbsTxStart = \
+  SL_CLI_COMMAND(prbsTxStart,
+                 "Send PRBS test frames back to back: pattern 0 PRBS9, 1 PRBS15, 2 PRBS23, 3 counter, 4 increment",
+                  "pattern" SL_CLI_UNIT_SEPARATOR "Frame length in bytes, length header included" SL_CLI_UNIT_SEPARATOR "Channel" SL_CLI_UNIT_SEPARATOR "Frames to send, 0 until stopped (default 1)" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT32OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__prbsTxStop = \
+  SL_CLI_COMMAND(prbsTxStop,
+                 "Stop sending PRBS test frames",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__setPrbsRx = \
+  SL_CLI_COMMAND(setPrbsRx,
+                 "Check received PRBS test frames, resetting the counters and error log",
+                  "0 = off, 1 = on" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getPrbsRx = \
+  SL_CLI_COMMAND(getPrbsRx,
+                 "Print PRBS checker counters and bit error rate",
+                  "1 = reset after printing" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__getPrbsErrors = \
+  SL_CLI_COMMAND(getPrbsErrors,
+                 "List the positions of the first wrong bytes the PRBS checker found",
+                  "",
+                 {SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__meshThroughput = \
+  SL_CLI_COMMAND(meshThroughput,
+                 "Measure goodput and round-trip latency to a kmesh peer",
+                  "Destination address" SL_CLI_UNIT_SEPARATOR "Frame length in bytes, kmesh header included" SL_CLI_UNIT_SEPARATOR "Frames to send" SL_CLI_UNIT_SEPARATOR "1 = peer echoes each frame (default), 0 = one-way" SL_CLI_UNIT_SEPARATOR "Echoed frames in flight (default 1)" SL_CLI_UNIT_SEPARATOR,
+                 {SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT16, SL_CLI_ARG_UINT32, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_UINT8OPT, SL_CLI_ARG_END, });
+
+static const sl_cli_command_info_t cli_cmd__meshThroughputStop = \
+  SL_CLI_COMMAND(meshThroughputStop,
+                 "Stop the throughput benchmark and print what it measured",
+                  "",
+                 {SL_CLI_ARG_END, });
+
 
 // Create group command tables and structs if cli_groups given
 // in template. Group name is suffixed with _group_table for tables
@@ -2243,6 +2691,70 @@ const sl_cli_command_entry_t sl_cli_default_command_table[] = {
   { "setCrcInitVal", &cli_cmd__setCrcInitVal, false },
   { "resetWhiteningInitVal", &cli_cmd__resetWhiteningInitVal, false },
   { "resetCrcInitVal", &cli_cmd__resetCrcInitVal, false },
+  { "_______kmesh_Mesh_Networking_____", &cli_cmd_________kmesh_Mesh_Networking_____, false },
+  { "setNodeAddress", &cli_cmd__setNodeAddress, false },
+  { "setRouting", &cli_cmd__setRouting, false },
+  { "addRoute", &cli_cmd__addRoute, false },
+  { "removeRoute", &cli_cmd__removeRoute, false },
+  { "printRoutes", &cli_cmd__printRoutes, false },
+  { "advertiseRoutes", &cli_cmd__advertiseRoutes, false },
+  { "meshTx", &cli_cmd__meshTx, false },
+  { "getMeshCounters", &cli_cmd__getMeshCounters, false },
+  { "configArq", &cli_cmd__configArq, false },
+  { "meshTxAck", &cli_cmd__meshTxAck, false },
+  { "getArqCounters", &cli_cmd__getArqCounters, false },
+  { "meshTxAggr", &cli_cmd__meshTxAggr, false },
+  { "configAggr", &cli_cmd__configAggr, false },
+  { "flushAggr", &cli_cmd__flushAggr, false },
+  { "getAggrCounters", &cli_cmd__getAggrCounters, false },
+  { "meshCrc", &cli_cmd__meshCrc, false },
+  { "compileScript", &cli_cmd__compileScript, false },
+  { "runCompiledScript", &cli_cmd__runCompiledScript, false },
+  { "stopCompiledScript", &cli_cmd__stopCompiledScript, false },
+  { "printCompiledScript", &cli_cmd__printCompiledScript, false },
+  { "clearCompiledScript", &cli_cmd__clearCompiledScript, false },
+  { "getScriptVariables", &cli_cmd__getScriptVariables, false },
+  { "saveScript", &cli_cmd__saveScript, false },
+  { "loadScript", &cli_cmd__loadScript, false },
+  { "deleteScript", &cli_cmd__deleteScript, false },
+  { "listScripts", &cli_cmd__listScripts, false },
+  { "setScriptAutorun", &cli_cmd__setScriptAutorun, false },
+  { "getConsoleCounters", &cli_cmd__getConsoleCounters, false },
+  { "setRxLog", &cli_cmd__setRxLog, false },
+  { "getRxLogCounters", &cli_cmd__getRxLogCounters, false },
+  { "setNotifySummary", &cli_cmd__setNotifySummary, false },
+  { "setPrintRateLimit", &cli_cmd__setPrintRateLimit, false },
+  { "getStackUsage", &cli_cmd__getStackUsage, false },
+  { "getSlabCounters", &cli_cmd__getSlabCounters, false },
+  { "setListenMode", &cli_cmd__setListenMode, false },
+  { "getPowerResidency", &cli_cmd__getPowerResidency, false },
+  { "setConsoleSleep", &cli_cmd__setConsoleSleep, false },
+  { "getIdleCounters", &cli_cmd__getIdleCounters, false },
+  { "getEnergy", &cli_cmd__getEnergy, false },
+  { "getTxEnergy", &cli_cmd__getTxEnergy, false },
+  { "setTxPowerControl", &cli_cmd__setTxPowerControl, false },
+  { "getTxPowerControl", &cli_cmd__getTxPowerControl, false },
+  { "setRateAdaptation", &cli_cmd__setRateAdaptation, false },
+  { "getLinkRates", &cli_cmd__getLinkRates, false },
+  { "setMeshLbt", &cli_cmd__setMeshLbt, false },
+  { "getLbtChannels", &cli_cmd__getLbtChannels, false },
+  { "getLbtStats", &cli_cmd__getLbtStats, false },
+  { "getLbtHistogram", &cli_cmd__getLbtHistogram, false },
+  { "lbtBenchmark", &cli_cmd__lbtBenchmark, false },
+  { "setRssiStream", &cli_cmd__setRssiStream, false },
+  { "getRssiStreamCounters", &cli_cmd__getRssiStreamCounters, false },
+  { "batchTxAdd", &cli_cmd__batchTxAdd, false },
+  { "batchTxClear", &cli_cmd__batchTxClear, false },
+  { "batchTxList", &cli_cmd__batchTxList, false },
+  { "batchTxStart", &cli_cmd__batchTxStart, false },
+  { "batchTxStop", &cli_cmd__batchTxStop, false },
+  { "prbsTxStart", &cli_cmd__prbsTxStart, false },
+  { "prbsTxStop", &cli_cmd__prbsTxStop, false },
+  { "setPrbsRx", &cli_cmd__setPrbsRx, false },
+  { "getPrbsRx", &cli_cmd__getPrbsRx, false },
+  { "getPrbsErrors", &cli_cmd__getPrbsErrors, false },
+  { "meshThroughput", &cli_cmd__meshThroughput, false },
+  { "meshThroughputStop", &cli_cmd__meshThroughputStop, false },
   { NULL, NULL, false },
 };
 
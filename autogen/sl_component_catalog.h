@@ -21,6 +21,7 @@
 #define SL_CATALOG_RETARGET_STDIO_PRESENT
 #define SL_CATALOG_IOSTREAM_UART_COMMON_PRESENT
 #define SL_CATALOG_MPU_PRESENT
+#define SL_CATALOG_NVM3_PRESENT
 #define SL_CATALOG_POWER_MANAGER_PRESENT
 #define SL_CATALOG_PRINTF_PRESENT
 #define SL_CATALOG_RADIO_CONFIG_SIMPLE_RAIL_SINGLEPHY_PRESENT
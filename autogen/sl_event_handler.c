@@ -9,6 +9,7 @@
 #include "sl_hfxo_manager.h"
 #include "sl_device_init_hfxo.h"
 #include "sl_device_init_clocks.h"
+#include "nvm3_default.h"
 #include "sl_rail_util_dma.h"
 #include "pa_conversions_efr32.h"
 #include "sl_rail_util_power_manager_init.h"
@@ -42,6 +43,7 @@ void sl_platform_init(void)
   sl_device_init_hfxo();
   sl_device_init_clocks();
   sl_board_init();
+  nvm3_initDefault();
   sl_power_manager_init();
 }
 
@@ -46,6 +46,7 @@
 #endif
 #include "sl_rail_util_callbacks_config.h"
 #include "pa_conversions_efr32.h"
+#include "kmesh.h"
 
 // Provide weak function called by callback RAILCb_AssertFailed.
 __WEAK
@@ -114,5 +115,6 @@ void sl_rail_util_on_event(RAIL_Handle_t rail_handle,
 void sli_rail_util_on_event(RAIL_Handle_t rail_handle,
                             RAIL_Events_t events)
 {
+  kmesh_on_rail_event(rail_handle, events);
   sl_rail_util_on_event(rail_handle, events);
 }
@@ -0,0 +1,551 @@
+/***************************************************************************//**
+ * @file kmesh_config.h
+ * @brief Configuration file for the kmesh networking layer.
+ ******************************************************************************/
+
+#ifndef KMESH_CONFIG_H
+#define KMESH_CONFIG_H
+
+// <<< Use Configuration Wizard in Context Menu >>>
+// <h> kmesh Configuration
+
+// <o KMESH_DEFAULT_ADDRESS> Node address used on boot
+// <0x0000-0xFFFE:1>
+// <i> 0 derives the address from the low 16 bits of the EUI-64.
+// <i> Default: 0
+#define KMESH_DEFAULT_ADDRESS  0
+
+// <o KMESH_FRAME_MAX_LENGTH> Maximum kmesh frame length in bytes
+// <i> Includes the 2-byte length header. Must not exceed the TX FIFO size.
+// <i> Default: 255
+#define KMESH_FRAME_MAX_LENGTH  255
+
+// <o KMESH_DEFAULT_HOP_LIMIT> Hop limit given to originated frames
+// <1-255:1>
+// <i> Default: 8
+#define KMESH_DEFAULT_HOP_LIMIT  8
+
+// </h>
+
+// <h> Routing Configuration
+
+// <o KMESH_ROUTE_TABLE_SIZE> Number of routing table entries
+// <1-64:1>
+// <i> Default: 16
+#define KMESH_ROUTE_TABLE_SIZE  16
+
+// <o KMESH_ROUTE_LIFETIME_S> Lifetime of a learned route (seconds)
+// <i> Default: 90
+#define KMESH_ROUTE_LIFETIME_S  90
+
+// <o KMESH_ROUTE_ADVERTISE_PERIOD_S> Route advertisement period (seconds)
+// <i> Default: 30
+#define KMESH_ROUTE_ADVERTISE_PERIOD_S  30
+
+// <o KMESH_ROUTE_METRIC_INFINITY> Metric treated as unreachable
+// <2-255:1>
+// <i> Default: 16
+#define KMESH_ROUTE_METRIC_INFINITY  16
+
+// </h>
+
+// <h> ARQ Configuration
+
+// <o KMESH_ARQ_DESTINATIONS> Destinations with a frame in flight at once
+// <1-16:1>
+// <i> Each slot holds one KMESH_FRAME_MAX_LENGTH retransmission buffer.
+// <i> Default: 4
+#define KMESH_ARQ_DESTINATIONS  4
+
+// <o KMESH_ARQ_MAX_RETRIES> Retransmissions before a frame is dropped
+// <0-15:1>
+// <i> Default: 3
+#define KMESH_ARQ_MAX_RETRIES  3
+
+// <o KMESH_ARQ_ACK_MARGIN_US> Slack added to the computed ACK timeout (us)
+// <i> Covers interrupt latency on the receiver before it starts the ACK.
+// <i> Default: 500
+#define KMESH_ARQ_ACK_MARGIN_US  500
+
+// <o KMESH_ARQ_MIN_BACKOFF> Initial backoff window (backoff periods)
+// <i> Same meaning as minBo of setLbtParams.
+// <i> Default: 1
+#define KMESH_ARQ_MIN_BACKOFF  1
+
+// <o KMESH_ARQ_MAX_BACKOFF> Maximum backoff window (backoff periods)
+// <i> Same meaning as maxBo of setLbtParams.
+// <i> Default: 16
+#define KMESH_ARQ_MAX_BACKOFF  16
+
+// <o KMESH_ARQ_BACKOFF_US> Backoff period (us)
+// <i> Same meaning as backoffUs of setLbtParams.
+// <i> Default: 1000
+#define KMESH_ARQ_BACKOFF_US  1000
+
+// </h>
+
+// <h> TX Power Control Configuration
+
+// <o KMESH_TPC_NEIGHBORS> Neighbors with their own TX power
+// <1-32:1>
+// <i> Default: 8
+#define KMESH_TPC_NEIGHBORS  8
+
+// <o KMESH_TPC_TARGET_RSSI_DBM> Default RSSI the neighbor should report, in dBm
+// <i> Sensitivity of the PHY plus the link margin to keep.
+// <i> Default: -85
+#define KMESH_TPC_TARGET_RSSI_DBM  -85
+
+// <o KMESH_TPC_HYSTERESIS_DB> Default RSSI error ignored, in dB
+// <i> Default: 3
+#define KMESH_TPC_HYSTERESIS_DB  3
+
+// <o KMESH_TPC_MIN_POWER_DDBM> Default lowest TX power, in deci-dBm
+// <i> Default: -100
+#define KMESH_TPC_MIN_POWER_DDBM  -100
+
+// <o KMESH_TPC_MAX_STEP_DOWN_DB> Largest power decrease per ACK, in dB
+// <i> Default: 6
+#define KMESH_TPC_MAX_STEP_DOWN_DB  6
+
+// <o KMESH_TPC_MISS_STEP_DB> Power increase after a missed ACK, in dB
+// <i> Default: 3
+#define KMESH_TPC_MISS_STEP_DB  3
+
+// </h>
+
+// <h> Rate Adaptation Configuration
+
+// <o KMESH_RATE_MAX> Channel groups used as rates
+// <2-8:1>
+// <i> Sizes the scan buffers; the rates are the groups of the generated
+// <i> channel config, up to this many. Keep it at the number of groups in
+// <i> radio_settings.radioconf, ordered from the slowest PHY to the fastest.
+// <i> Default: 3
+#define KMESH_RATE_MAX  3
+
+// <o KMESH_RATE_COMMON_GROUP> Channel group of the common PHY
+// <0-7:1>
+// <i> Broadcasts and new neighbors use it; slower groups are fallbacks.
+// <i> Group 0 is used if the channel config has fewer groups.
+// <i> Default: 1
+#define KMESH_RATE_COMMON_GROUP  1
+
+// <o KMESH_RATE_NEIGHBORS> Neighbors with their own rate
+// <1-32:1>
+// <i> Default: 8
+#define KMESH_RATE_NEIGHBORS  8
+
+// <o KMESH_RATE_DWELL_US> Time on each rate while scanning without a preamble, in us
+// <i> Default: 1000
+#define KMESH_RATE_DWELL_US  1000
+
+// <o KMESH_RATE_UP_ACKS> ACKs in a row before trying the next rate
+// <i> Default: 16
+#define KMESH_RATE_UP_ACKS  16
+
+// <o KMESH_RATE_UP_PER_PERMILLE> Highest ACK loss that allows a faster rate, in per mille
+// <i> Default: 50
+#define KMESH_RATE_UP_PER_PERMILLE  50
+
+// <o KMESH_RATE_DOWN_PER_PERMILLE> ACK loss that drops to a slower rate, in per mille
+// <i> Default: 200
+#define KMESH_RATE_DOWN_PER_PERMILLE  200
+
+// <o KMESH_RATE_BASE_RSSI_DBM> Reported RSSI the common PHY needs, in dBm
+// <i> Default: -100
+#define KMESH_RATE_BASE_RSSI_DBM  -100
+
+// <o KMESH_RATE_STEP_DB> Extra RSSI each faster rate needs, in dB
+// <i> Default: 6
+#define KMESH_RATE_STEP_DB  6
+
+// </h>
+
+// <h> Listen Before Talk Configuration
+
+// <o KMESH_LBT_CHANNELS> Channels with their own noise floor and backoff
+// <1-32:1>
+// <i> Default: 8
+#define KMESH_LBT_CHANNELS  8
+
+// <o KMESH_LBT_THRESHOLD_DBM> Default fixed CCA threshold, in dBm
+// <i> Also used by adaptive mode until a channel has KMESH_LBT_MIN_SAMPLES.
+// <i> Default: -75
+#define KMESH_LBT_THRESHOLD_DBM  -75
+
+// <o KMESH_LBT_MARGIN_DB> Default adaptive CCA threshold above the noise floor, in dB
+// <i> Default: 10
+#define KMESH_LBT_MARGIN_DB  10
+
+// <o KMESH_LBT_MIN_THRESHOLD_DBM> Lowest adaptive CCA threshold, in dBm
+// <i> Default: -110
+#define KMESH_LBT_MIN_THRESHOLD_DBM  -110
+
+// <o KMESH_LBT_MAX_THRESHOLD_DBM> Highest adaptive CCA threshold, in dBm
+// <i> Default: -50
+#define KMESH_LBT_MAX_THRESHOLD_DBM  -50
+
+// <o KMESH_LBT_SAMPLE_MS> Noise floor sampling period in adaptive mode, in ms
+// <i> Default: 100
+#define KMESH_LBT_SAMPLE_MS  100
+
+// <o KMESH_LBT_MIN_SAMPLES> Samples before the noise floor sets the threshold
+// <i> Default: 8
+#define KMESH_LBT_MIN_SAMPLES  8
+
+// <o KMESH_LBT_MIN_BO_EXP> Initial backoff exponent
+// <0-8:1>
+// <i> Adaptive mode raises it on busy channels.
+// <i> Default: 3
+#define KMESH_LBT_MIN_BO_EXP  3
+
+// <o KMESH_LBT_MAX_BO_EXP> Maximum backoff exponent
+// <0-8:1>
+// <i> Default: 5
+#define KMESH_LBT_MAX_BO_EXP  5
+
+// <o KMESH_LBT_TRIES> CCA attempts before giving up with TX_CHANNEL_BUSY
+// <1-15:1>
+// <i> Default: 5
+#define KMESH_LBT_TRIES  5
+
+// <o KMESH_LBT_BACKOFF_US> Backoff period, in us
+// <i> Default: 320
+#define KMESH_LBT_BACKOFF_US  320
+
+// <o KMESH_LBT_CCA_US> CCA duration, in us
+// <i> Default: 128
+#define KMESH_LBT_CCA_US  128
+
+// <o KMESH_LBT_BUSY_HIGH_PERMILLE> Busy ratio that raises the backoff exponent, in per mille
+// <i> Default: 300
+#define KMESH_LBT_BUSY_HIGH_PERMILLE  300
+
+// <o KMESH_LBT_BUSY_LOW_PERMILLE> Busy ratio that lowers it again, in per mille
+// <i> Default: 100
+#define KMESH_LBT_BUSY_LOW_PERMILLE  100
+
+// </h>
+
+// <h> Batch TX Configuration
+
+// <o KMESH_BATCH_ENTRIES> Packets the batch TX queue holds
+// <1-255:1>
+// <i> Default: 32
+#define KMESH_BATCH_ENTRIES  32
+
+// <o KMESH_BATCH_POOL_SIZE> Bytes of packet data the batch TX queue holds
+// <64-16384:4>
+// <i> Default: 2048
+#define KMESH_BATCH_POOL_SIZE  2048
+
+// </h>
+
+// <h> PRBS Test Traffic Configuration
+
+// <o KMESH_PRBS_TX_THRESHOLD> TX FIFO fill level that triggers a refill, in bytes
+// <16-4096:1>
+// <i> Must be below the TX FIFO size. Each refill has the time the PHY
+// <i> takes to send this many bytes to run.
+// <i> Default: 128
+#define KMESH_PRBS_TX_THRESHOLD  128
+
+// <o KMESH_PRBS_ERROR_LOG> Wrong bytes whose position the checker keeps
+// <1-255:1>
+// <i> Default: 16
+#define KMESH_PRBS_ERROR_LOG  16
+
+// </h>
+
+// <h> Throughput Benchmark Configuration
+
+// <o KMESH_BENCH_WINDOW> Largest number of echoed frames in flight
+// <1-32:1>
+// <i> Default: 8
+#define KMESH_BENCH_WINDOW  8
+
+// <o KMESH_BENCH_MAX_RETRIES> Retransmissions before a frame counts as failed
+// <0-15:1>
+// <i> Also bounds the report requests of a run without echoes.
+// <i> Default: 3
+#define KMESH_BENCH_MAX_RETRIES  3
+
+// <o KMESH_BENCH_TIMEOUT_MARGIN_US> Slack added to the computed echo timeout (us)
+// <i> Covers the peer's processing and its listen-before-talk.
+// <i> Default: 2000
+#define KMESH_BENCH_TIMEOUT_MARGIN_US  2000
+
+// <o KMESH_BENCH_RTT_SAMPLES> Round trips kept for the percentiles
+// <16-1024:1>
+// <i> Four bytes of RAM each. Longer runs keep a uniform random sample.
+// <i> Default: 256
+#define KMESH_BENCH_RTT_SAMPLES  256
+
+// </h>
+
+// <h> Aggregation Configuration
+
+// <o KMESH_AGGR_BATCHES> Next hops that can have a batch open at once
+// <1-8:1>
+// <i> Each batch holds one KMESH_FRAME_MAX_LENGTH frame buffer.
+// <i> Default: 2
+#define KMESH_AGGR_BATCHES  2
+
+// <o KMESH_AGGR_FLUSH_DEADLINE_MS> Longest a message waits for company (ms)
+// <i> Default: 20
+#define KMESH_AGGR_FLUSH_DEADLINE_MS  20
+
+// <o KMESH_AGGR_RX_QUEUE_SIZE> Bytes buffered for received messages
+// <i> Messages split out of aggregates wait here until printed.
+// <i> Default: 256
+#define KMESH_AGGR_RX_QUEUE_SIZE  256
+
+// </h>
+
+// <h> CRC Configuration
+
+// <q KMESH_CRC_SLICE_BY_8> Use slice-by-8 software CRC
+// <i> Trades 8 kB of RAM for tables for several times the byte rate of the
+// <i> single-table CRC. The host tools always enable it.
+// <i> Default: 0
+#ifndef KMESH_CRC_SLICE_BY_8
+#define KMESH_CRC_SLICE_BY_8  0
+#endif
+
+// </h>
+
+// <h> Script Configuration
+
+// <o KMESH_SCRIPT_SIZE> Bytes of compiled script bytecode
+// <64-4096:4>
+// <i> A typical command with a couple of arguments takes 6 to 10 bytes,
+// <i> against SL_CLI_INPUT_BUFFER_SIZE per line in the RAM script store.
+// <i> Default: 1024
+#define KMESH_SCRIPT_SIZE  1024
+
+// <o KMESH_SCRIPT_LOOP_DEPTH> Nesting depth of repeat ... endRepeat
+// <1-16>
+// <i> Default: 4
+#define KMESH_SCRIPT_LOOP_DEPTH  4
+
+// <o KMESH_SCRIPT_SLOTS> Compiled scripts kept in NVM3
+// <1-16>
+// <i> Each saved slot takes up to KMESH_SCRIPT_SIZE plus a small header of
+// <i> the default NVM3 instance.
+// <i> Default: 4
+#define KMESH_SCRIPT_SLOTS  4
+
+// <o KMESH_SCRIPT_NVM3_KEY_BASE> First NVM3 key used for script slots
+// <0x0000-0xFF00:0x100>
+// <i> Slots use the keys from here on, the autorun setting the last key of
+// <i> the 256 key block.
+// <i> Default: 0x4B00
+#define KMESH_SCRIPT_NVM3_KEY_BASE  0x4B00
+
+// </h>
+
+// <h> Console Configuration
+
+// <o KMESH_CONSOLE_TX_BUFFER_SIZE> Console TX ring size in bytes
+// <256-16384:4>
+// <i> Responses queue here while DMA feeds the UART. At 115200 baud the
+// <i> UART drains about 11.5 bytes per millisecond; output beyond what
+// <i> fits is dropped and counted by getConsoleCounters.
+// <i> Default: 4096
+#define KMESH_CONSOLE_TX_BUFFER_SIZE  4096
+
+// </h>
+
+// <h> RX Log Configuration
+
+// <o KMESH_RXLOG_BUFFER_SIZE> Bytes of binary RX records held for the console
+// <256-8192:4>
+// <i> Absorbs bursts while the console ring is full.
+// <i> Default: 1024
+#define KMESH_RXLOG_BUFFER_SIZE  1024
+
+// <o KMESH_RXLOG_DEFAULT_PAYLOAD> Payload bytes logged per packet by default
+// <0-237>
+// <i> Default: 16
+#define KMESH_RXLOG_DEFAULT_PAYLOAD  16
+
+// </h>
+// <h> RSSI Stream Configuration
+
+// <o KMESH_RSSI_STREAM_BLOCK_SIZE> RSSI samples per burst
+// <16-1024:1>
+// <i> Two blocks of this many bytes are kept in RAM.
+// <i> Default: 256
+#define KMESH_RSSI_STREAM_BLOCK_SIZE  256
+
+// <o KMESH_RSSI_STREAM_UPDATE_SYMBOLS> RSSI update period of the PHY, in symbols
+// <i> From the radio configurator generation log.
+// <i> Default: 8
+#define KMESH_RSSI_STREAM_UPDATE_SYMBOLS  8
+
+// <o KMESH_RSSI_STREAM_MIN_PERIOD_US> Shortest sample period, in microseconds
+// <i> Default: 40
+#define KMESH_RSSI_STREAM_MIN_PERIOD_US  40
+
+// </h>
+// <h> Notification Configuration
+
+// <o KMESH_NOTIFY_RATE_PER_SECOND> Per-packet prints allowed per second
+// <0-65535>
+// <i> meshRx lines beyond this average rate are skipped and counted in the
+// <i> notifySummary line. 0 prints every packet.
+// <i> Default: 0
+#define KMESH_NOTIFY_RATE_PER_SECOND  0
+
+// <o KMESH_NOTIFY_BURST> Per-packet prints allowed back to back
+// <1-65535>
+// <i> Default: 10
+#define KMESH_NOTIFY_BURST  10
+
+// </h>
+// <h> Stack Configuration
+
+// <o KMESH_STACK_GUARD_SIZE> MPU guard at the bottom of the main stack
+// <0-256:32>
+// <i> Any access to the lowest bytes of the stack faults, so an overflow
+// <i> stops at the push that caused it. Comes out of SL_STACK_SIZE; 0
+// <i> disables the guard.
+// <i> Default: 32
+#define KMESH_STACK_GUARD_SIZE  32
+
+// </h>
+// <h> Packet Buffer Configuration
+
+// <o KMESH_SLAB_SMALL_SIZE> Small buffer size in bytes
+// <16-1024:4>
+// <i> RAILtest buffers hold its event record plus the packet, so a short
+// <i> packet needs somewhat more than its own length.
+// <i> Default: 128
+#define KMESH_SLAB_SMALL_SIZE  128
+
+// <o KMESH_SLAB_SMALL_COUNT> Number of small buffers
+// <1-255>
+// <i> Default: 12
+#define KMESH_SLAB_SMALL_COUNT  12
+
+// <o KMESH_SLAB_MEDIUM_SIZE> Medium buffer size in bytes
+// <16-2048:4>
+// <i> Default: 256
+#define KMESH_SLAB_MEDIUM_SIZE  256
+
+// <o KMESH_SLAB_MEDIUM_COUNT> Number of medium buffers
+// <1-255>
+// <i> Default: 4
+#define KMESH_SLAB_MEDIUM_COUNT  4
+
+// <o KMESH_SLAB_LARGE_SIZE> Large buffer size in bytes
+// <16-4096:4>
+// <i> At least BUFFER_POOL_ALLOCATOR_BUFFER_SIZE_MAX, the largest request
+// <i> RAILtest makes.
+// <i> Default: 1068
+#define KMESH_SLAB_LARGE_SIZE  1068
+
+// <o KMESH_SLAB_LARGE_COUNT> Number of large buffers
+// <1-255>
+// <i> Default: 2
+#define KMESH_SLAB_LARGE_COUNT  2
+
+// </h>
+// <h> Power Configuration
+
+// <o KMESH_POWER_LISTEN_ON_US> Default listen window in microseconds
+// <i> Long enough to catch the preamble of a frame sent with a preamble
+// <i> longer than the listen period.
+// <i> Default: 2000
+#define KMESH_POWER_LISTEN_ON_US  2000
+
+// <o KMESH_POWER_LISTEN_OFF_US> Default sleep between listen windows in microseconds
+// <i> Default: 98000
+#define KMESH_POWER_LISTEN_OFF_US  98000
+
+// </h>
+
+// <h> Console Wake Configuration
+
+// <o KMESH_CONSOLE_WAKE_IDLE_MS> Default console idle time before sleeping in milliseconds
+// <i> Only used once setConsoleSleep enables sleeping.
+// <i> Default: 5000
+#define KMESH_CONSOLE_WAKE_IDLE_MS  5000
+
+// </h>
+
+// <h> Idle Configuration
+
+// <o KMESH_IDLE_NO_SLEEP_US> Deadlines closer than this skip sleeping, in microseconds
+// <i> Default: 100
+#define KMESH_IDLE_NO_SLEEP_US  100
+
+// <o KMESH_IDLE_EM2_MIN_US> Deadlines closer than this sleep in EM1 only, in microseconds
+// <i> Must cover the HFXO startup and the EM2 entry and exit, or deadlines
+// <i> after EM2 are missed.
+// <i> Default: 2000
+#define KMESH_IDLE_EM2_MIN_US  2000
+
+// </h>
+
+// <h> Energy Model Configuration
+// <i> Datasheet typicals for the EFR32FG23 at 3.0 V with the DC-DC on.
+// <i> Replace them with currents measured on the board.
+
+// <o KMESH_ENERGY_SUPPLY_MV> Supply voltage in millivolts
+// <i> Default: 3000
+#define KMESH_ENERGY_SUPPLY_MV  3000
+
+// <o KMESH_ENERGY_EM0_UA> EM0 current in microamps
+// <i> Default: 1010
+#define KMESH_ENERGY_EM0_UA  1010
+
+// <o KMESH_ENERGY_EM1_UA> EM1 current in microamps
+// <i> Default: 690
+#define KMESH_ENERGY_EM1_UA  690
+
+// <o KMESH_ENERGY_EM2_NA> EM2 current in nanoamps
+// <i> Default: 1500
+#define KMESH_ENERGY_EM2_NA  1500
+
+// <o KMESH_ENERGY_RX_UA> RX current in microamps
+// <i> Default: 4200
+#define KMESH_ENERGY_RX_UA  4200
+
+// <o KMESH_ENERGY_TX_HP_UA> TX current at 20 dBm on the high-power PA in microamps
+// <i> Default: 85000
+#define KMESH_ENERGY_TX_HP_UA  85000
+
+// <o KMESH_ENERGY_TX_HP_BASE_UA> TX current with no output on the high-power PA in microamps
+// <i> Default: 12000
+#define KMESH_ENERGY_TX_HP_BASE_UA  12000
+
+// <o KMESH_ENERGY_TX_MP_UA> TX current at 10 dBm on the mid-power PA in microamps
+// <i> Default: 19000
+#define KMESH_ENERGY_TX_MP_UA  19000
+
+// <o KMESH_ENERGY_TX_MP_BASE_UA> TX current with no output on the mid-power PA in microamps
+// <i> Default: 8000
+#define KMESH_ENERGY_TX_MP_BASE_UA  8000
+
+// <o KMESH_ENERGY_TX_LP_UA> TX current at 0 dBm on the low-power PA in microamps
+// <i> Default: 8000
+#define KMESH_ENERGY_TX_LP_UA  8000
+
+// <o KMESH_ENERGY_TX_LP_BASE_UA> TX current with no output on the low-power PA in microamps
+// <i> Default: 6000
+#define KMESH_ENERGY_TX_LP_BASE_UA  6000
+
+// <o KMESH_ENERGY_TX_LLP_UA> TX current at -10 dBm on the lowest-power PA in microamps
+// <i> Default: 5500
+#define KMESH_ENERGY_TX_LLP_UA  5500
+
+// <o KMESH_ENERGY_TX_LLP_BASE_UA> TX current with no output on the lowest-power PA in microamps
+// <i> Default: 5000
+#define KMESH_ENERGY_TX_LLP_BASE_UA  5000
+
+// </h>
+// <<< end of configuration section >>>
+
+#endif // KMESH_CONFIG_H
@@ -107,7 +107,9 @@
 
 // <o SL_CLI_INST0_IOSTREAM_HANDLE> The iostream handle used by the cli instance
 // <i> Default: sl_iostream_get_default()
-  #define SL_CLI_INST0_IOSTREAM_HANDLE    sl_iostream_vcom_handle
+// <i> kmesh_console queues output for DMA and reads from sl_iostream_vcom_handle.
+  #include "kmesh_console.h"
+  #define SL_CLI_INST0_IOSTREAM_HANDLE    kmesh_console_handle
 
 // <o SL_CLI_INST0_COMMAND_GROUP> The default command group.
 // <i> Default: sl_cli_default_command_group.
@@ -37,7 +37,7 @@
 
 // <o SL_RAIL_UTIL_RAIL_POWER_MANAGER_INIT> Enable RAIL power manager initialization
 // <i> Default: 1
-#define SL_RAIL_UTIL_RAIL_POWER_MANAGER_INIT 0
+#define SL_RAIL_UTIL_RAIL_POWER_MANAGER_INIT 1
 
 // </h>
 // <<< end of configuration section >>>
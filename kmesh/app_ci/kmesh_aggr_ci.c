@@ -0,0 +1,80 @@
+/***************************************************************************//**
+ * @file kmesh_aggr_ci.c
+ * @brief CLI commands for kmesh message aggregation.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_aggr.h"
+
+#define KMESH_AGGR_CI_ERROR_INVALID_ARG 0x20U
+#define KMESH_AGGR_CI_ERROR_BUSY        0x21U
+
+void meshTxAggr(sl_cli_command_arg_t *args)
+{
+  uint8_t payload[UINT8_MAX];
+  uint16_t destination = sl_cli_get_argument_uint16(args, 0);
+  uint8_t length = 0U;
+  RAIL_Status_t status;
+
+  for (int i = 1; i < sl_cli_get_argument_count(args); i++) {
+    if (length >= sizeof(payload)) {
+      responsePrintError(sl_cli_get_command_string(args, 0),
+                         KMESH_AGGR_CI_ERROR_INVALID_ARG, "Payload too long");
+      return;
+    }
+    payload[length++] = sl_cli_get_argument_uint8(args, i);
+  }
+  status = kmesh_aggr_send(destination, payload, length);
+  if (status == RAIL_STATUS_INVALID_PARAMETER) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_AGGR_CI_ERROR_INVALID_ARG,
+                       "Payload exceeds maxLength %u",
+                       kmesh_aggr_get_max_length());
+    return;
+  }
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_AGGR_CI_ERROR_BUSY, "No batch available");
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Destination:0x%04x,Length:%u,PendingBatches:%u",
+                destination, length, kmesh_aggr_pending_batches());
+}
+
+void configAggr(sl_cli_command_arg_t *args)
+{
+  uint16_t maxLength = kmesh_aggr_get_max_length();
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    maxLength = sl_cli_get_argument_uint16(args, 1);
+  }
+  kmesh_aggr_configure(sl_cli_get_argument_uint16(args, 0), maxLength);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "FlushDeadlineMs:%u,MaxLength:%u",
+                kmesh_aggr_get_flush_deadline_ms(),
+                kmesh_aggr_get_max_length());
+}
+
+void flushAggr(sl_cli_command_arg_t *args)
+{
+  kmesh_aggr_flush();
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "PendingBatches:%u", kmesh_aggr_pending_batches());
+}
+
+void getAggrCounters(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Queued:%lu,Frames:%lu,Messages:%lu,Delivered:%lu,"
+                "Relayed:%lu,Dropped:%lu",
+                kmesh_aggr_counters.queued,
+                kmesh_aggr_counters.frames,
+                kmesh_aggr_counters.messages,
+                kmesh_aggr_counters.delivered,
+                kmesh_aggr_counters.relayed,
+                kmesh_aggr_counters.dropped);
+}
@@ -0,0 +1,74 @@
+/***************************************************************************//**
+ * @file kmesh_arq_ci.c
+ * @brief CLI commands for kmesh acknowledged delivery.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_arq.h"
+
+#define KMESH_ARQ_CI_ERROR_INVALID_ARG 0x10U
+#define KMESH_ARQ_CI_ERROR_BUSY        0x11U
+
+void configArq(sl_cli_command_arg_t *args)
+{
+  uint8_t retries = sl_cli_get_argument_uint8(args, 0);
+  uint8_t minBo = sl_cli_get_argument_uint8(args, 1);
+  uint8_t maxBo = sl_cli_get_argument_uint8(args, 2);
+  uint16_t backoffUs = sl_cli_get_argument_uint16(args, 3);
+
+  if (minBo == 0U) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_ARQ_CI_ERROR_INVALID_ARG, "minBo must be >= 1");
+    return;
+  }
+  kmesh_arq_configure(retries, minBo, maxBo, backoffUs);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Retries:%u,MinBo:%u,MaxBo:%u,BackoffUs:%u,AckTimeoutUs:%lu",
+                retries, minBo, (maxBo < minBo) ? minBo : maxBo, backoffUs,
+                kmesh_arq_get_ack_timeout());
+}
+
+void meshTxAck(sl_cli_command_arg_t *args)
+{
+  uint8_t payload[KMESH_FRAME_MAX_LENGTH - KMESH_FRAME_HEADER_LENGTH];
+  uint16_t destination = sl_cli_get_argument_uint16(args, 0);
+  uint16_t length = 0U;
+  RAIL_Status_t status;
+
+  for (int i = 1; i < sl_cli_get_argument_count(args); i++) {
+    if (length >= sizeof(payload)) {
+      responsePrintError(sl_cli_get_command_string(args, 0),
+                         KMESH_ARQ_CI_ERROR_INVALID_ARG, "Payload too long");
+      return;
+    }
+    payload[length++] = sl_cli_get_argument_uint8(args, i);
+  }
+  status = kmesh_arq_send(destination, payload, length);
+  if (status == RAIL_STATUS_INVALID_STATE) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_ARQ_CI_ERROR_BUSY,
+                       "Frame to 0x%04x still in flight", destination);
+    return;
+  }
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_ARQ_CI_ERROR_INVALID_ARG, "RAIL status %u", status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Destination:0x%04x,Length:%u", destination, length);
+}
+
+void getArqCounters(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Sent:%lu,Delivered:%lu,Retried:%lu,Failed:%lu,Duplicates:%lu",
+                kmesh_arq_counters.sent,
+                kmesh_arq_counters.delivered,
+                kmesh_arq_counters.retried,
+                kmesh_arq_counters.failed,
+                kmesh_arq_counters.duplicates);
+}
@@ -0,0 +1,91 @@
+/***************************************************************************//**
+ * @file kmesh_batch_ci.c
+ * @brief CLI commands for the batch TX queue.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_batch.h"
+
+#define KMESH_BATCH_CI_ERROR_ADD    0x70U
+#define KMESH_BATCH_CI_ERROR_STATE  0x71U
+
+void batchTxAdd(sl_cli_command_arg_t *args)
+{
+  uint8_t data[KMESH_FRAME_MAX_LENGTH];
+  uint16_t length = sl_cli_get_argument_uint16(args, 0);
+  uint16_t channel = sl_cli_get_argument_uint16(args, 1);
+  int16_t powerDdbm = sl_cli_get_argument_int16(args, 2);
+  uint32_t offsetUs = sl_cli_get_argument_uint32(args, 3);
+  uint16_t dataLength = 0U;
+  RAIL_Status_t status;
+
+  for (int i = 4; i < sl_cli_get_argument_count(args); i++) {
+    if (dataLength >= sizeof(data)) {
+      responsePrintError(sl_cli_get_command_string(args, 0),
+                         KMESH_BATCH_CI_ERROR_ADD, "Too many bytes");
+      return;
+    }
+    data[dataLength++] = sl_cli_get_argument_uint8(args, i);
+  }
+  status = kmesh_batch_add(data, dataLength, length, channel, powerDdbm, offsetUs);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_BATCH_CI_ERROR_ADD,
+                       "Cannot queue: %u of %u entries used, %u bytes free, RAIL status %u",
+                       kmesh_batch_get_count(), KMESH_BATCH_ENTRIES,
+                       kmesh_batch_get_free(), status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Index:%u,Length:%u,Free:%u",
+                kmesh_batch_get_count() - 1U, length, kmesh_batch_get_free());
+}
+
+void batchTxClear(sl_cli_command_arg_t *args)
+{
+  if (kmesh_batch_clear() != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_BATCH_CI_ERROR_STATE,
+                       "Batch TX is running");
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Free:%u", kmesh_batch_get_free());
+}
+
+void batchTxList(sl_cli_command_arg_t *args)
+{
+  kmesh_batch_entry_t entry;
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Index:%u,Length:%u,Channel:%u,PowerDdbm:%d,OffsetUs:%lu");
+  for (uint8_t i = 0U; kmesh_batch_get_entry(i, &entry); i++) {
+    responsePrintMulti("Index:%u,Length:%u,Channel:%u,PowerDdbm:%d,OffsetUs:%lu",
+                       i, entry.length, entry.channel, entry.power_ddbm, entry.offset_us);
+  }
+}
+
+void batchTxStart(sl_cli_command_arg_t *args)
+{
+  uint32_t passes = 1U;
+  RAIL_Status_t status;
+
+  if (sl_cli_get_argument_count(args) >= 1) {
+    passes = sl_cli_get_argument_uint32(args, 0);
+  }
+  status = kmesh_batch_start(passes);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_BATCH_CI_ERROR_STATE,
+                       "Cannot start: %u entries queued, RAIL status %u",
+                       kmesh_batch_get_count(), status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Entries:%u,Passes:%lu",
+                kmesh_batch_get_count(), passes);
+}
+
+void batchTxStop(sl_cli_command_arg_t *args)
+{
+  kmesh_batch_stop();
+  responsePrint(sl_cli_get_command_string(args, 0), "Running:%s",
+                kmesh_batch_is_running() ? "True" : "False");
+}
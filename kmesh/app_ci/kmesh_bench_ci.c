@@ -0,0 +1,47 @@
+/***************************************************************************//**
+ * @file kmesh_bench_ci.c
+ * @brief CLI commands for the kmesh throughput benchmark.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_bench.h"
+
+#define KMESH_BENCH_CI_ERROR_START  0x90U
+
+void meshThroughput(sl_cli_command_arg_t *args)
+{
+  uint16_t destination = sl_cli_get_argument_uint16(args, 0);
+  uint16_t length = sl_cli_get_argument_uint16(args, 1);
+  uint32_t count = sl_cli_get_argument_uint32(args, 2);
+  bool echo = true;
+  uint8_t window = 1U;
+  RAIL_Status_t status;
+
+  if (sl_cli_get_argument_count(args) >= 4) {
+    echo = sl_cli_get_argument_uint8(args, 3) != 0U;
+  }
+  if (sl_cli_get_argument_count(args) >= 5) {
+    window = sl_cli_get_argument_uint8(args, 4);
+  }
+  status = kmesh_bench_start(destination, length, count, echo, window);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_BENCH_CI_ERROR_START,
+                       "Cannot start: length %u to %u, window 1 to %u, RAIL status %u",
+                       KMESH_FRAME_HEADER_LENGTH + KMESH_BENCH_HEADER_LENGTH,
+                       KMESH_FRAME_MAX_LENGTH, KMESH_BENCH_WINDOW, status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Status:Started,Destination:0x%04x,Length:%u,Count:%lu,Echo:%s,Window:%u",
+                destination, length, count, echo ? "True" : "False", echo ? window : 1U);
+}
+
+void meshThroughputStop(sl_cli_command_arg_t *args)
+{
+  kmesh_bench_stop();
+  responsePrint(sl_cli_get_command_string(args, 0), "Running:%s",
+                kmesh_bench_is_running() ? "True" : "False");
+}
@@ -0,0 +1,329 @@
+/***************************************************************************//**
+ * @file kmesh_ci.c
+ * @brief CLI commands for kmesh addressing and routing.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_route.h"
+#include "kmesh_crc.h"
+#include "kmesh_console.h"
+#include "kmesh_console_wake.h"
+#include "kmesh_rxlog.h"
+#include "kmesh_rssi_stream.h"
+#include "kmesh_notify.h"
+#include "kmesh_slab.h"
+#include "kmesh_stack.h"
+
+#define KMESH_CI_ERROR_INVALID_ARG  0x01U
+#define KMESH_CI_ERROR_TABLE_FULL   0x02U
+#define KMESH_CI_ERROR_NOT_FOUND    0x03U
+#define KMESH_CI_ERROR_TX_FAILED    0x04U
+
+void setNodeAddress(sl_cli_command_arg_t *args)
+{
+  if (sl_cli_get_argument_count(args) >= 1) {
+    uint16_t address = sl_cli_get_argument_uint16(args, 0);
+    if (address == KMESH_ADDRESS_BROADCAST) {
+      responsePrintError(sl_cli_get_command_string(args, 0),
+                         KMESH_CI_ERROR_INVALID_ARG,
+                         "0xFFFF is the broadcast address");
+      return;
+    }
+    kmesh_set_address(address);
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Address:0x%04x",
+                kmesh_get_address());
+}
+
+void setRouting(sl_cli_command_arg_t *args)
+{
+  kmesh_route_set_enabled(sl_cli_get_argument_uint8(args, 0) != 0U);
+  responsePrint(sl_cli_get_command_string(args, 0), "Routing:%s",
+                kmesh_route_is_enabled() ? "Enabled" : "Disabled");
+}
+
+void addRoute(sl_cli_command_arg_t *args)
+{
+  uint16_t destination = sl_cli_get_argument_uint16(args, 0);
+  uint16_t nextHop = sl_cli_get_argument_uint16(args, 1);
+  uint8_t metric = 1U;
+
+  if (sl_cli_get_argument_count(args) >= 3) {
+    metric = sl_cli_get_argument_uint8(args, 2);
+  }
+  if (metric == 0U || metric >= KMESH_ROUTE_METRIC_INFINITY) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_CI_ERROR_INVALID_ARG,
+                       "Metric must be 1..%u", KMESH_ROUTE_METRIC_INFINITY - 1U);
+    return;
+  }
+  if (!kmesh_route_add(destination, nextHop, metric,
+                       KMESH_ROUTE_LIFETIME_STATIC)) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_CI_ERROR_TABLE_FULL, "Routing table full");
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Destination:0x%04x,NextHop:0x%04x,Metric:%u",
+                destination, nextHop, metric);
+}
+
+void removeRoute(sl_cli_command_arg_t *args)
+{
+  uint16_t destination = sl_cli_get_argument_uint16(args, 0);
+
+  if (!kmesh_route_remove(destination)) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_CI_ERROR_NOT_FOUND, "No route to 0x%04x",
+                       destination);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Destination:0x%04x",
+                destination);
+}
+
+void printRoutes(sl_cli_command_arg_t *args)
+{
+  kmesh_route_t route;
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Destination:0x%04x,NextHop:0x%04x,Metric:%u,Lifetime:%s");
+  for (uint8_t i = 0U; kmesh_route_get(i, &route); i++) {
+    char lifetime[8];
+    if (route.lifetime_s == KMESH_ROUTE_LIFETIME_STATIC) {
+      strcpy(lifetime, "static");
+    } else {
+      snprintf(lifetime, sizeof(lifetime), "%u", route.lifetime_s);
+    }
+    responsePrintMulti("Destination:0x%04x,NextHop:0x%04x,Metric:%u,Lifetime:%s",
+                       route.destination, route.next_hop, route.metric,
+                       lifetime);
+  }
+}
+
+void advertiseRoutes(sl_cli_command_arg_t *args)
+{
+  RAIL_Status_t status = kmesh_route_advertise();
+
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_CI_ERROR_TX_FAILED, "RAIL status %u", status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Routes:%u",
+                kmesh_route_count());
+}
+
+void meshTx(sl_cli_command_arg_t *args)
+{
+  uint8_t payload[KMESH_FRAME_MAX_LENGTH - KMESH_FRAME_HEADER_LENGTH];
+  uint16_t destination = sl_cli_get_argument_uint16(args, 0);
+  uint16_t length = 0U;
+  RAIL_Status_t status;
+
+  for (int i = 1; i < sl_cli_get_argument_count(args); i++) {
+    if (length >= sizeof(payload)) {
+      responsePrintError(sl_cli_get_command_string(args, 0),
+                         KMESH_CI_ERROR_INVALID_ARG, "Payload too long");
+      return;
+    }
+    payload[length++] = sl_cli_get_argument_uint8(args, i);
+  }
+  status = kmesh_send(destination, KMESH_FRAME_TYPE_DATA, payload, length);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_CI_ERROR_TX_FAILED, "RAIL status %u", status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Destination:0x%04x,Length:%u", destination, length);
+}
+
+void getMeshCounters(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Originated:%lu,Delivered:%lu,Forwarded:%lu,NoRoute:%lu,"
+                "HopLimitExceeded:%lu,TxErrors:%lu",
+                kmesh_counters.originated,
+                kmesh_counters.delivered,
+                kmesh_counters.forwarded,
+                kmesh_counters.no_route,
+                kmesh_counters.hop_limit_exceeded,
+                kmesh_counters.tx_errors);
+}
+
+void meshCrc(sl_cli_command_arg_t *args)
+{
+  uint8_t data[KMESH_FRAME_MAX_LENGTH];
+  uint16_t length = 0U;
+
+  for (int i = 0; i < sl_cli_get_argument_count(args); i++) {
+    if (length >= sizeof(data)) {
+      responsePrintError(sl_cli_get_command_string(args, 0),
+                         KMESH_CI_ERROR_INVALID_ARG, "Too many bytes");
+      return;
+    }
+    data[length++] = sl_cli_get_argument_uint8(args, i);
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Length:%u,Crc:0x%08lx",
+                length, kmesh_crc(data, length));
+}
+
+void getConsoleCounters(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Queued:%lu,Sent:%lu,DroppedWrites:%lu,DroppedBytes:%lu,"
+                "HighWater:%u,Size:%u",
+                kmesh_console_counters.bytes_queued,
+                kmesh_console_counters.bytes_sent,
+                kmesh_console_counters.writes_dropped,
+                kmesh_console_counters.bytes_dropped,
+                kmesh_console_counters.high_water,
+                KMESH_CONSOLE_TX_BUFFER_SIZE);
+}
+
+void setConsoleSleep(sl_cli_command_arg_t *args)
+{
+  bool enable = sl_cli_get_argument_uint8(args, 0) != 0U;
+  uint32_t idleMs = kmesh_console_wake_get_idle_ms();
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    idleMs = sl_cli_get_argument_uint32(args, 1);
+  }
+  kmesh_console_wake_configure(enable, idleMs);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "ConsoleSleep:%s,IdleMs:%lu,Wakes:%lu,DroppedBytes:%lu",
+                kmesh_console_wake_is_enabled() ? "Enabled" : "Disabled",
+                kmesh_console_wake_get_idle_ms(),
+                kmesh_console_wake_counters.wakes,
+                kmesh_console_wake_counters.dropped_bytes);
+}
+
+void setRxLog(sl_cli_command_arg_t *args)
+{
+  bool enable = sl_cli_get_argument_uint8(args, 0) != 0U;
+  uint8_t maxPayload = kmesh_rxlog_get_max_payload();
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    maxPayload = sl_cli_get_argument_uint8(args, 1);
+  }
+  kmesh_rxlog_configure(enable, maxPayload);
+  responsePrint(sl_cli_get_command_string(args, 0), "RxLog:%s,MaxPayload:%u",
+                kmesh_rxlog_is_enabled() ? "Enabled" : "Disabled",
+                kmesh_rxlog_get_max_payload());
+}
+
+void getRxLogCounters(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0), "Logged:%lu,Dropped:%lu",
+                kmesh_rxlog_counters.logged,
+                kmesh_rxlog_counters.dropped);
+}
+
+void setRssiStream(sl_cli_command_arg_t *args)
+{
+  bool enable = sl_cli_get_argument_uint8(args, 0) != 0U;
+  uint16_t periodUs = 0U;
+  uint32_t bursts = 0U;
+  RAIL_Status_t status;
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    periodUs = sl_cli_get_argument_uint16(args, 1);
+  }
+  if (sl_cli_get_argument_count(args) >= 3) {
+    bursts = sl_cli_get_argument_uint32(args, 2);
+  }
+  status = kmesh_rssi_stream_configure(enable, periodUs, bursts);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_CI_ERROR_INVALID_ARG,
+                       "Period must be at least %u us (RAIL status %u)",
+                       KMESH_RSSI_STREAM_MIN_PERIOD_US, status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "RssiStream:%s,PeriodUs:%u,BlockSize:%u,Bursts:%lu",
+                kmesh_rssi_stream_is_enabled() ? "Enabled" : "Disabled",
+                kmesh_rssi_stream_get_period(),
+                KMESH_RSSI_STREAM_BLOCK_SIZE,
+                bursts);
+}
+
+void getRssiStreamCounters(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Samples:%lu,Bursts:%lu,Lost:%lu,Late:%lu",
+                kmesh_rssi_stream_counters.samples,
+                kmesh_rssi_stream_counters.bursts,
+                kmesh_rssi_stream_counters.lost,
+                kmesh_rssi_stream_counters.late);
+}
+
+void setNotifySummary(sl_cli_command_arg_t *args)
+{
+  uint32_t interval_ms = sl_cli_get_argument_uint32(args, 0);
+
+  if (interval_ms > KMESH_NOTIFY_SUMMARY_INTERVAL_MAX_MS) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_CI_ERROR_INVALID_ARG,
+                       "Interval must be at most %lu ms",
+                       KMESH_NOTIFY_SUMMARY_INTERVAL_MAX_MS);
+    return;
+  }
+  kmesh_notify_configure_summary(interval_ms);
+  responsePrint(sl_cli_get_command_string(args, 0), "IntervalMs:%lu",
+                kmesh_notify_get_summary_interval());
+}
+
+void setPrintRateLimit(sl_cli_command_arg_t *args)
+{
+  uint16_t burst = kmesh_notify_get_burst();
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    burst = sl_cli_get_argument_uint16(args, 1);
+  }
+  kmesh_notify_configure_rate(sl_cli_get_argument_uint16(args, 0), burst);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "PerSecond:%u,Burst:%u,Suppressed:%lu",
+                kmesh_notify_get_rate(),
+                kmesh_notify_get_burst(),
+                kmesh_notify_get_suppressed());
+}
+
+void getStackUsage(sl_cli_command_arg_t *args)
+{
+  kmesh_stack_usage_t usage;
+
+  kmesh_stack_get_usage(&usage);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Size:%lu,Guard:%lu,HighWater:%lu,Free:%lu,"
+                "RailIsrEntry:%lu,RailIsrCalls:%lu",
+                usage.size,
+                usage.guard,
+                usage.high_water,
+                usage.size - usage.high_water,
+                usage.rail_isr_entry,
+                usage.rail_isr_calls);
+  if (sl_cli_get_argument_count(args) >= 1 && sl_cli_get_argument_uint8(args, 0) != 0U) {
+    kmesh_stack_reset();
+  }
+}
+
+void getSlabCounters(sl_cli_command_arg_t *args)
+{
+  kmesh_slab_class_info_t info;
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Size:%u,Count:%u,InUse:%u,Peak:%u,Allocations:%lu,"
+                      "Fallbacks:%lu,Failures:%lu");
+  for (uint8_t i = 0U; kmesh_slab_get_class_info(i, &info); i++) {
+    responsePrintMulti("Size:%u,Count:%u,InUse:%u,Peak:%u,Allocations:%lu,"
+                       "Fallbacks:%lu,Failures:%lu",
+                       info.size, info.count, info.in_use, info.peak,
+                       info.allocations, info.fallbacks, info.failures);
+  }
+}
@@ -0,0 +1,119 @@
+/***************************************************************************//**
+ * @file kmesh_lbt_ci.c
+ * @brief CLI commands for kmesh listen-before-talk and its benchmark.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_lbt.h"
+
+#define KMESH_LBT_CI_ERROR_MODE       0x60U
+#define KMESH_LBT_CI_ERROR_BENCHMARK  0x61U
+
+static const char *mode_names[] = { "Off", "Fixed", "Adaptive" };
+
+void setMeshLbt(sl_cli_command_arg_t *args)
+{
+  uint8_t mode = sl_cli_get_argument_uint8(args, 0);
+  uint8_t marginDb = kmesh_lbt_get_margin_db();
+  int8_t thresholdDbm = kmesh_lbt_get_threshold();
+
+  if (mode > KMESH_LBT_ADAPTIVE) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_LBT_CI_ERROR_MODE,
+                       "Mode must be 0 (off), 1 (fixed) or 2 (adaptive)");
+    return;
+  }
+  if (sl_cli_get_argument_count(args) >= 2) {
+    marginDb = sl_cli_get_argument_uint8(args, 1);
+  }
+  if (sl_cli_get_argument_count(args) >= 3) {
+    thresholdDbm = sl_cli_get_argument_int8(args, 2);
+  }
+  kmesh_lbt_configure((kmesh_lbt_mode_t)mode, marginDb, thresholdDbm);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Mode:%s,MarginDb:%u,ThresholdDbm:%d",
+                mode_names[kmesh_lbt_get_mode()],
+                kmesh_lbt_get_margin_db(),
+                kmesh_lbt_get_threshold());
+}
+
+void getLbtChannels(sl_cli_command_arg_t *args)
+{
+  kmesh_lbt_channel_t channel;
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Channel:%u,NoiseDbm:%d,Samples:%lu,ThresholdDbm:%d,"
+                      "BusyPermille:%u,MinBoExp:%u");
+  for (uint8_t i = 0U; kmesh_lbt_get_channel(i, &channel); i++) {
+    responsePrintMulti("Channel:%u,NoiseDbm:%d,Samples:%lu,ThresholdDbm:%d,"
+                       "BusyPermille:%u,MinBoExp:%u",
+                       channel.channel,
+                       (channel.samples != 0U) ? channel.noise_qdbm / 4 : RAIL_RSSI_INVALID_DBM,
+                       channel.samples, channel.threshold_dbm,
+                       channel.busy_permille, channel.min_bo_exp);
+  }
+}
+
+void getLbtStats(sl_cli_command_arg_t *args)
+{
+  kmesh_lbt_stats_t stats;
+
+  kmesh_lbt_get_stats(&stats);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Accesses:%lu,Failures:%lu,BusyCcas:%lu,MinUs:%lu,MeanUs:%lu,"
+                "P50Us:%lu,P90Us:%lu,P99Us:%lu,MaxUs:%lu",
+                stats.accesses, stats.failures, stats.busy_ccas,
+                (stats.accesses != 0U) ? stats.min_us : 0U,
+                (stats.accesses != 0U) ? (uint32_t)(stats.sum_us / stats.accesses) : 0U,
+                kmesh_lbt_percentile_us(&stats, 500U),
+                kmesh_lbt_percentile_us(&stats, 900U),
+                kmesh_lbt_percentile_us(&stats, 990U),
+                stats.max_us);
+  if (sl_cli_get_argument_count(args) >= 1 && sl_cli_get_argument_uint8(args, 0) != 0U) {
+    kmesh_lbt_reset_stats();
+  }
+}
+
+void getLbtHistogram(sl_cli_command_arg_t *args)
+{
+  kmesh_lbt_stats_t stats;
+
+  kmesh_lbt_get_stats(&stats);
+  responsePrintHeader(sl_cli_get_command_string(args, 0), "UpToUs:%lu,Count:%lu");
+  for (uint8_t b = 0U; b < KMESH_LBT_DELAY_BUCKETS; b++) {
+    // The last bucket is open ended.
+    responsePrintMulti("UpToUs:%lu,Count:%lu",
+                       (b + 1U < KMESH_LBT_DELAY_BUCKETS) ? (KMESH_LBT_BUCKET_US << b) : UINT32_MAX,
+                       stats.buckets[b]);
+  }
+}
+
+void lbtBenchmark(sl_cli_command_arg_t *args)
+{
+  uint32_t count = sl_cli_get_argument_uint32(args, 0);
+  uint16_t length = 16U;
+  uint16_t periodMs = 0U;
+
+  if (count == 0U) {
+    kmesh_lbt_stop_benchmark();
+    responsePrint(sl_cli_get_command_string(args, 0), "Status:Stopped");
+    return;
+  }
+  if (sl_cli_get_argument_count(args) >= 2) {
+    length = sl_cli_get_argument_uint16(args, 1);
+  }
+  if (sl_cli_get_argument_count(args) >= 3) {
+    periodMs = sl_cli_get_argument_uint16(args, 2);
+  }
+  if (kmesh_lbt_start_benchmark(count, length, periodMs) != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_LBT_CI_ERROR_BENCHMARK,
+                       "Payload length must be at most %u",
+                       KMESH_FRAME_MAX_LENGTH - KMESH_FRAME_HEADER_LENGTH);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Status:Started,Count:%lu,Length:%u,PeriodMs:%u,Mode:%s",
+                count, length, periodMs, mode_names[kmesh_lbt_get_mode()]);
+}
@@ -0,0 +1,127 @@
+/***************************************************************************//**
+ * @file kmesh_power_ci.c
+ * @brief CLI commands for duty-cycled listening and energy mode residency.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_energy.h"
+#include "kmesh_idle.h"
+#include "kmesh_power.h"
+
+#define KMESH_POWER_CI_ERROR_RAIL 0x40U
+
+void setListenMode(sl_cli_command_arg_t *args)
+{
+  bool enable = sl_cli_get_argument_uint8(args, 0) != 0U;
+  uint32_t onUs = kmesh_power_get_listen_on_us();
+  uint32_t offUs = kmesh_power_get_listen_off_us();
+  bool preambleSense = kmesh_power_get_listen_preamble_sense();
+  RAIL_Status_t status;
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    onUs = sl_cli_get_argument_uint32(args, 1);
+  }
+  if (sl_cli_get_argument_count(args) >= 3) {
+    offUs = sl_cli_get_argument_uint32(args, 2);
+  }
+  if (sl_cli_get_argument_count(args) >= 4) {
+    preambleSense = sl_cli_get_argument_uint8(args, 3) != 0U;
+  }
+  status = kmesh_power_configure_listen(enable, onUs, offUs, preambleSense);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_POWER_CI_ERROR_RAIL, "RAIL status %u", status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Listen:%s,OnUs:%lu,OffUs:%lu,PreambleSense:%s",
+                kmesh_power_is_listening() ? "Enabled" : "Disabled",
+                kmesh_power_get_listen_on_us(),
+                kmesh_power_get_listen_off_us(),
+                kmesh_power_get_listen_preamble_sense() ? "True" : "False");
+}
+
+void getPowerResidency(sl_cli_command_arg_t *args)
+{
+  kmesh_power_residency_t residency;
+
+  kmesh_power_get_residency(&residency);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Em0Ms:%lu,Em1Ms:%lu,Em2Ms:%lu,Em2Entries:%lu,"
+                "ListenWindows:%lu,ListenPackets:%lu",
+                kmesh_power_ticks_to_ms(residency.ticks[KMESH_POWER_EM0]),
+                kmesh_power_ticks_to_ms(residency.ticks[KMESH_POWER_EM1]),
+                kmesh_power_ticks_to_ms(residency.ticks[KMESH_POWER_EM2]),
+                residency.em2_entries,
+                residency.listen_windows,
+                residency.listen_packets);
+  if (sl_cli_get_argument_count(args) >= 1 && sl_cli_get_argument_uint8(args, 0) != 0U) {
+    kmesh_power_reset_residency();
+  }
+}
+
+void getIdleCounters(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "NoSleeps:%lu,Em1Sleeps:%lu,Em2Sleeps:%lu,Wakeups:%lu,MaxLateUs:%lu",
+                kmesh_idle_counters.no_sleeps,
+                kmesh_idle_counters.em1_sleeps,
+                kmesh_idle_counters.em2_sleeps,
+                kmesh_idle_counters.wakeups,
+                kmesh_idle_counters.max_late_us);
+  if (sl_cli_get_argument_count(args) >= 1 && sl_cli_get_argument_uint8(args, 0) != 0U) {
+    kmesh_idle_reset_counters();
+  }
+}
+
+void getEnergy(sl_cli_command_arg_t *args)
+{
+  kmesh_energy_report_t report;
+  uint32_t packets = 0U;
+
+  kmesh_energy_get_report(&report);
+  for (uint8_t i = 0U; i < KMESH_ENERGY_PAS; i++) {
+    packets += report.tx[i].packets;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "ElapsedMs:%lu,TxUj:%lu,RxUj:%lu,McuUj:%lu,SleepUj:%lu,TotalUj:%lu,"
+                "TxPackets:%lu,RxMs:%lu",
+                report.elapsed_ms,
+                report.tx_uj,
+                report.rx_uj,
+                report.mcu_uj,
+                report.sleep_uj,
+                report.total_uj,
+                packets,
+                (uint32_t)(report.rx_us / 1000U));
+  if (sl_cli_get_argument_count(args) >= 1 && sl_cli_get_argument_uint8(args, 0) != 0U) {
+    kmesh_energy_reset();
+  }
+}
+
+void getTxEnergy(sl_cli_command_arg_t *args)
+{
+  kmesh_energy_report_t report;
+  RAIL_Handle_t railHandle = kmesh_get_rail_handle();
+  RAIL_TxPower_t power = RAIL_GetTxPowerDbm(railHandle);
+
+  kmesh_energy_get_report(&report);
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Pa:%s,Packets:%lu,TxUs:%lu,TxUj:%lu,UjPerPacket:%lu,"
+                      "CurrentUaNow:%lu");
+  for (uint8_t i = 0U; i < KMESH_ENERGY_PAS; i++) {
+    const kmesh_energy_tx_t *tx = &report.tx[i];
+
+    responsePrintMulti("Pa:%s,Packets:%lu,TxUs:%lu,TxUj:%lu,UjPerPacket:%lu,"
+                       "CurrentUaNow:%lu",
+                       kmesh_energy_pa_name((kmesh_energy_pa_t)i),
+                       tx->packets,
+                       (uint32_t)tx->us,
+                       (uint32_t)(tx->nj / 1000U),
+                       (tx->packets == 0U) ? 0U : (uint32_t)(tx->nj / 1000U / tx->packets),
+                       kmesh_energy_tx_current_ua((kmesh_energy_pa_t)i, power));
+  }
+}
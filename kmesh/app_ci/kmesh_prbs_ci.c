@@ -0,0 +1,98 @@
+/***************************************************************************//**
+ * @file kmesh_prbs_ci.c
+ * @brief CLI commands for the PRBS test traffic generator and checker.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_prbs.h"
+
+#define KMESH_PRBS_CI_ERROR_PATTERN  0x80U
+#define KMESH_PRBS_CI_ERROR_STATE    0x81U
+
+static const char *pattern_names[] = { "Prbs9", "Prbs15", "Prbs23", "Counter", "Increment" };
+
+void prbsTxStart(sl_cli_command_arg_t *args)
+{
+  uint8_t pattern = sl_cli_get_argument_uint8(args, 0);
+  uint16_t length = sl_cli_get_argument_uint16(args, 1);
+  uint16_t channel = sl_cli_get_argument_uint16(args, 2);
+  uint32_t count = 1U;
+  RAIL_Status_t status;
+
+  if (pattern >= KMESH_PRBS_PATTERN_COUNT) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_PRBS_CI_ERROR_PATTERN,
+                       "Pattern must be 0 (PRBS9), 1 (PRBS15), 2 (PRBS23), "
+                       "3 (counter) or 4 (increment)");
+    return;
+  }
+  if (sl_cli_get_argument_count(args) >= 4) {
+    count = sl_cli_get_argument_uint32(args, 3);
+  }
+  status = kmesh_prbs_tx_start((kmesh_prbs_pattern_t)pattern, length, channel, count);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0), KMESH_PRBS_CI_ERROR_STATE,
+                       "Cannot start: length %u to %u, RAIL status %u",
+                       KMESH_FRAME_HEADER_LENGTH + KMESH_PRBS_HEADER_LENGTH + 1U,
+                       KMESH_FRAME_LENGTH_LIMIT, status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Pattern:%s,Length:%u,Channel:%u,Count:%lu",
+                pattern_names[pattern], length, channel, count);
+}
+
+void prbsTxStop(sl_cli_command_arg_t *args)
+{
+  kmesh_prbs_tx_stop();
+  responsePrint(sl_cli_get_command_string(args, 0), "Running:%s",
+                kmesh_prbs_tx_is_running() ? "True" : "False");
+}
+
+void setPrbsRx(sl_cli_command_arg_t *args)
+{
+  kmesh_prbs_rx_enable(sl_cli_get_argument_uint8(args, 0) != 0U);
+  responsePrint(sl_cli_get_command_string(args, 0), "Enabled:%s",
+                kmesh_prbs_rx_is_enabled() ? "True" : "False");
+}
+
+void getPrbsRx(sl_cli_command_arg_t *args)
+{
+  kmesh_prbs_rx_counters_t counters;
+
+  kmesh_prbs_rx_get_counters(&counters);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Packets:%lu,CrcErrors:%lu,ErroredPackets:%lu,Lost:%lu,Bytes:%lu,"
+                "ByteErrors:%lu,BitErrors:%lu,BerPpm:%lu",
+                counters.packets, counters.crc_errors, counters.errored_packets,
+                counters.lost, counters.bytes, counters.byte_errors, counters.bit_errors,
+                (counters.bytes != 0U)
+                ? (uint32_t)((uint64_t)counters.bit_errors * 1000000U
+                             / ((uint64_t)counters.bytes * 8U)) : 0U);
+  if (sl_cli_get_argument_count(args) >= 1 && sl_cli_get_argument_uint8(args, 0) != 0U) {
+    kmesh_prbs_rx_enable(kmesh_prbs_rx_is_enabled());
+  }
+}
+
+void getPrbsErrors(sl_cli_command_arg_t *args)
+{
+  kmesh_prbs_error_t error;
+  uint8_t mask;
+  uint8_t bit;
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Packet:%lu,Offset:%u,FirstBit:%lu,Expected:0x%02x,"
+                      "Received:0x%02x,Mask:0x%02x");
+  for (uint8_t i = 0U; kmesh_prbs_rx_get_error(i, &error); i++) {
+    // Bits go out MSB first, so the first wrong bit is the highest one set.
+    mask = error.expected ^ error.received;
+    for (bit = 0U; (mask & (0x80U >> bit)) == 0U; bit++) {
+    }
+    responsePrintMulti("Packet:%lu,Offset:%u,FirstBit:%lu,Expected:0x%02x,"
+                       "Received:0x%02x,Mask:0x%02x",
+                       error.packet, error.offset, (uint32_t)error.offset * 8U + bit,
+                       error.expected, error.received, mask);
+  }
+}
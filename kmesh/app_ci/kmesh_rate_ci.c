@@ -0,0 +1,49 @@
+/***************************************************************************//**
+ * @file kmesh_rate_ci.c
+ * @brief CLI commands for per-neighbor rate adaptation.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_rate.h"
+
+#define KMESH_RATE_CI_ERROR_RAIL 0x50U
+
+void setRateAdaptation(sl_cli_command_arg_t *args)
+{
+  bool enable = sl_cli_get_argument_uint8(args, 0) != 0U;
+  RAIL_Status_t status = kmesh_rate_configure(enable);
+
+  if (status != RAIL_STATUS_NO_ERROR) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_RATE_CI_ERROR_RAIL, "RAIL status %u", status);
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "RateAdaptation:%s,Rates:%u,CommonRate:%u,CommonChannel:%u,Scanning:%s",
+                kmesh_rate_is_enabled() ? "Enabled" : "Disabled",
+                kmesh_rate_get_count(),
+                kmesh_rate_get_common_rate(),
+                kmesh_rate_get_common_channel(),
+                kmesh_rate_is_scanning() ? "True" : "False");
+}
+
+void getLinkRates(sl_cli_command_arg_t *args)
+{
+  kmesh_rate_link_t link;
+  uint16_t channel = kmesh_rate_get_common_channel();
+
+  (void) RAIL_GetChannel(kmesh_get_rail_handle(), &channel);
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Neighbor:0x%04x,Rate:%u,Channel:%u,Rssi:%d,PerPermille:%u,"
+                      "Acks:%lu,Misses:%lu");
+  for (uint8_t i = 0U; kmesh_rate_get_link(i, &link); i++) {
+    responsePrintMulti("Neighbor:0x%04x,Rate:%u,Channel:%u,Rssi:%d,PerPermille:%u,"
+                       "Acks:%lu,Misses:%lu",
+                       link.address, link.rate,
+                       kmesh_rate_tx_channel(link.address, channel),
+                       link.rssi, link.per_permille, link.acks, link.misses);
+  }
+}
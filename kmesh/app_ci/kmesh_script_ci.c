@@ -0,0 +1,185 @@
+/***************************************************************************//**
+ * @file kmesh_script_ci.c
+ * @brief CLI commands for compiled scripts.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+#include "sl_cli_config.h"
+
+#include "kmesh.h"
+#include "kmesh_script.h"
+#include "kmesh_script_nvm.h"
+
+#define KMESH_SCRIPT_CI_ERROR_COMPILE 0x30U
+#define KMESH_SCRIPT_CI_ERROR_RUN     0x31U
+#define KMESH_SCRIPT_CI_ERROR_SLOT    0x32U
+
+void compileScript(sl_cli_command_arg_t *args)
+{
+  uint8_t failedLine;
+  kmesh_script_status_t status = kmesh_script_compile_ram_store(&failedLine);
+
+  if (status != KMESH_SCRIPT_OK) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_SCRIPT_CI_ERROR_COMPILE, "Line %u: %s",
+                       failedLine, kmesh_script_status_string(status));
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Instructions:%u,Bytes:%u,Free:%u",
+                kmesh_script_get_instruction_count(),
+                kmesh_script_get_size(),
+                KMESH_SCRIPT_SIZE - kmesh_script_get_size());
+}
+
+void runCompiledScript(sl_cli_command_arg_t *args)
+{
+  uint32_t iterations = 1U;
+  kmesh_script_status_t status;
+
+  if (sl_cli_get_argument_count(args) >= 1) {
+    iterations = sl_cli_get_argument_uint32(args, 0);
+  }
+  status = kmesh_script_run(iterations);
+  if (status != KMESH_SCRIPT_OK) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_SCRIPT_CI_ERROR_RUN, "%s",
+                       kmesh_script_status_string(status));
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Status:Running,Iterations:%lu", iterations);
+}
+
+void stopCompiledScript(sl_cli_command_arg_t *args)
+{
+  bool wasRunning = kmesh_script_is_running();
+
+  kmesh_script_stop();
+  responsePrint(sl_cli_get_command_string(args, 0), "Stopped:%s",
+                wasRunning ? "True" : "False");
+}
+
+void printCompiledScript(sl_cli_command_arg_t *args)
+{
+  char line[SL_CLI_INPUT_BUFFER_SIZE];
+  uint16_t offset = 0U;
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0), "Offset:%u,Line:%s");
+  while (offset < kmesh_script_get_size()) {
+    uint16_t next = kmesh_script_disassemble(offset, line, sizeof(line));
+    if (next == 0U) {
+      break;
+    }
+    responsePrintMulti("Offset:%u,Line:%s", offset, line);
+    offset = next;
+  }
+}
+
+void clearCompiledScript(sl_cli_command_arg_t *args)
+{
+  kmesh_script_clear();
+  responsePrint(sl_cli_get_command_string(args, 0), "Bytes:0,Free:%u",
+                KMESH_SCRIPT_SIZE);
+}
+
+void getScriptVariables(sl_cli_command_arg_t *args)
+{
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Running:%s,Channel:%ld,Power:%ld,Counter:%ld,EventTimeouts:%lu",
+                kmesh_script_is_running() ? "True" : "False",
+                kmesh_script_get_variable(KMESH_SCRIPT_VARIABLE_CHANNEL),
+                kmesh_script_get_variable(KMESH_SCRIPT_VARIABLE_POWER),
+                kmesh_script_get_variable(KMESH_SCRIPT_VARIABLE_COUNTER),
+                kmesh_script_get_event_timeouts());
+}
+
+void saveScript(sl_cli_command_arg_t *args)
+{
+  uint8_t slot = sl_cli_get_argument_uint8(args, 0);
+  const char *name = sl_cli_get_argument_string(args, 1);
+  kmesh_script_status_t status = kmesh_script_nvm_save(slot, name);
+
+  if (status != KMESH_SCRIPT_OK) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_SCRIPT_CI_ERROR_SLOT, "%s",
+                       kmesh_script_status_string(status));
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Slot:%u,Name:%s,Bytes:%u",
+                slot, name, kmesh_script_get_size());
+}
+
+void loadScript(sl_cli_command_arg_t *args)
+{
+  uint8_t slot = sl_cli_get_argument_uint8(args, 0);
+  kmesh_script_status_t status = kmesh_script_nvm_load(slot);
+
+  if (status != KMESH_SCRIPT_OK) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_SCRIPT_CI_ERROR_SLOT, "%s",
+                       kmesh_script_status_string(status));
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "Slot:%u,Instructions:%u,Bytes:%u", slot,
+                kmesh_script_get_instruction_count(), kmesh_script_get_size());
+}
+
+void deleteScript(sl_cli_command_arg_t *args)
+{
+  uint8_t slot = sl_cli_get_argument_uint8(args, 0);
+  kmesh_script_status_t status = kmesh_script_nvm_delete(slot);
+
+  if (status != KMESH_SCRIPT_OK) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_SCRIPT_CI_ERROR_SLOT, "%s",
+                       kmesh_script_status_string(status));
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Slot:%u", slot);
+}
+
+void listScripts(sl_cli_command_arg_t *args)
+{
+  uint32_t iterations;
+  uint8_t autorun = kmesh_script_nvm_get_autorun(&iterations);
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Slot:%u,Name:%s,Bytes:%u,Instructions:%u,Current:%s,Autorun:%s");
+  for (uint8_t slot = 0U; slot < KMESH_SCRIPT_SLOTS; slot++) {
+    kmesh_script_slot_info_t info;
+    if (kmesh_script_nvm_get_info(slot, &info) != KMESH_SCRIPT_OK) {
+      continue;
+    }
+    responsePrintMulti("Slot:%u,Name:%s,Bytes:%u,Instructions:%u,Current:%s,Autorun:%s",
+                       slot, info.name, info.size, info.instruction_count,
+                       info.current ? "True" : "False",
+                       (slot == autorun) ? "True" : "False");
+  }
+}
+
+void setScriptAutorun(sl_cli_command_arg_t *args)
+{
+  uint8_t slot = sl_cli_get_argument_uint8(args, 0);
+  uint32_t iterations = 1U;
+  kmesh_script_status_t status;
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    iterations = sl_cli_get_argument_uint32(args, 1);
+  }
+  status = kmesh_script_nvm_set_autorun(slot, iterations);
+  if (status != KMESH_SCRIPT_OK) {
+    responsePrintError(sl_cli_get_command_string(args, 0),
+                       KMESH_SCRIPT_CI_ERROR_SLOT, "%s",
+                       kmesh_script_status_string(status));
+    return;
+  }
+  if (slot == KMESH_SCRIPT_AUTORUN_NONE) {
+    responsePrint(sl_cli_get_command_string(args, 0), "Slot:Off");
+    return;
+  }
+  responsePrint(sl_cli_get_command_string(args, 0), "Slot:%u,Iterations:%lu",
+                slot, iterations);
+}
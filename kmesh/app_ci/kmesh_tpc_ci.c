@@ -0,0 +1,50 @@
+/***************************************************************************//**
+ * @file kmesh_tpc_ci.c
+ * @brief CLI commands for per-neighbor TX power control.
+ ******************************************************************************/
+
+#include "response_print.h"
+#include "sl_cli.h"
+
+#include "kmesh.h"
+#include "kmesh_tpc.h"
+
+void setTxPowerControl(sl_cli_command_arg_t *args)
+{
+  bool enable = sl_cli_get_argument_uint8(args, 0) != 0U;
+  int8_t targetRssi = kmesh_tpc_get_target_rssi();
+  uint8_t hysteresisDb = kmesh_tpc_get_hysteresis_db();
+  int16_t minPower = kmesh_tpc_get_min_power();
+
+  if (sl_cli_get_argument_count(args) >= 2) {
+    targetRssi = sl_cli_get_argument_int8(args, 1);
+  }
+  if (sl_cli_get_argument_count(args) >= 3) {
+    hysteresisDb = sl_cli_get_argument_uint8(args, 2);
+  }
+  if (sl_cli_get_argument_count(args) >= 4) {
+    minPower = sl_cli_get_argument_int16(args, 3);
+  }
+  kmesh_tpc_configure(enable, targetRssi, hysteresisDb, minPower);
+  responsePrint(sl_cli_get_command_string(args, 0),
+                "TxPowerControl:%s,TargetRssi:%d,HysteresisDb:%u,"
+                "MinPowerDdbm:%d,MaxPowerDdbm:%d",
+                kmesh_tpc_is_enabled() ? "Enabled" : "Disabled",
+                kmesh_tpc_get_target_rssi(),
+                kmesh_tpc_get_hysteresis_db(),
+                kmesh_tpc_get_min_power(),
+                kmesh_tpc_get_max_power());
+}
+
+void getTxPowerControl(sl_cli_command_arg_t *args)
+{
+  kmesh_tpc_neighbor_t neighbor;
+
+  responsePrintHeader(sl_cli_get_command_string(args, 0),
+                      "Neighbor:0x%04x,PowerDdbm:%d,LastRssi:%d,Acks:%lu,Misses:%lu");
+  for (uint8_t i = 0U; kmesh_tpc_get_neighbor(i, &neighbor); i++) {
+    responsePrintMulti("Neighbor:0x%04x,PowerDdbm:%d,LastRssi:%d,Acks:%lu,Misses:%lu",
+                       neighbor.address, neighbor.power_ddbm, neighbor.last_rssi,
+                       neighbor.acks, neighbor.misses);
+  }
+}
@@ -0,0 +1,323 @@
+/***************************************************************************//**
+ * @file kmesh.c
+ * @brief kmesh networking layer running on top of RAILtest.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "em_device.h"
+#include "sl_core.h"
+#include "sl_rail_util_init.h"
+#include "kmesh.h"
+#include "kmesh_route.h"
+#include "kmesh_arq.h"
+#include "kmesh_aggr.h"
+#include "kmesh_console.h"
+#include "kmesh_console_wake.h"
+#include "kmesh_energy.h"
+#include "kmesh_idle.h"
+#include "kmesh_notify.h"
+#include "kmesh_power.h"
+#include "kmesh_rssi_stream.h"
+#include "kmesh_rxlog.h"
+#include "kmesh_script.h"
+#include "kmesh_script_nvm.h"
+#include "kmesh_stack.h"
+#include "kmesh_batch.h"
+#include "kmesh_bench.h"
+#include "kmesh_lbt.h"
+#include "kmesh_prbs.h"
+#include "kmesh_rate.h"
+#include "kmesh_tpc.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_US_PER_SECOND 1000000UL
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void kmesh_on_rx_packet(RAIL_Handle_t rail_handle);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_counters_t kmesh_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static uint16_t kmesh_address;
+static uint8_t kmesh_sequence;
+static RAIL_Time_t kmesh_last_second;
+static uint32_t kmesh_random_state;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_init(void)
+{
+  kmesh_stack_init();
+  kmesh_console_init();
+  kmesh_console_wake_init();
+#if KMESH_DEFAULT_ADDRESS != 0
+  kmesh_address = KMESH_DEFAULT_ADDRESS;
+#else
+  kmesh_address = (uint16_t)DEVINFO->EUI64L;
+  if (kmesh_address == KMESH_ADDRESS_BROADCAST) {
+    kmesh_address = 0x0001U;
+  }
+#endif
+  kmesh_sequence = (uint8_t)DEVINFO->EUI64L;
+  kmesh_last_second = RAIL_GetTime();
+  kmesh_random_state = DEVINFO->EUI64L ^ DEVINFO->EUI64H ^ kmesh_last_second;
+  if (kmesh_random_state == 0U) {
+    kmesh_random_state = 1U;
+  }
+  kmesh_route_init();
+  kmesh_arq_init();
+  kmesh_aggr_init();
+  kmesh_script_init();
+  kmesh_script_nvm_init();
+  kmesh_notify_init();
+  kmesh_power_init();
+  kmesh_energy_init();
+  kmesh_rate_init();
+  kmesh_lbt_init();
+  kmesh_bench_init();
+}
+
+void kmesh_process_action(void)
+{
+  while ((RAIL_Time_t)(RAIL_GetTime() - kmesh_last_second) >= KMESH_US_PER_SECOND) {
+    kmesh_last_second += KMESH_US_PER_SECOND;
+    kmesh_route_on_second();
+  }
+  kmesh_aggr_process_action();
+  kmesh_script_process_action();
+  kmesh_rxlog_process_action();
+  kmesh_rssi_stream_process_action();
+  kmesh_notify_process_action();
+  kmesh_console_process_action();
+  kmesh_console_wake_process_action();
+  kmesh_energy_process_action();
+  kmesh_lbt_process_action();
+  kmesh_batch_process_action();
+  kmesh_prbs_process_action();
+  kmesh_bench_process_action();
+  kmesh_idle_process_action();
+}
+
+void kmesh_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events)
+{
+  kmesh_stack_on_rail_event();
+  if ((events & RAIL_EVENT_RX_PACKET_RECEIVED) != 0U) {
+    // Log before routing patches forwarded frames in the FIFO.
+    kmesh_rxlog_on_rx(rail_handle);
+    kmesh_on_rx_packet(rail_handle);
+  }
+  if ((events & RAIL_EVENTS_TX_COMPLETION) != 0U) {
+    kmesh_tpc_restore();
+    kmesh_arq_on_tx_events(events);
+    kmesh_batch_on_tx_events(events);
+    kmesh_bench_on_tx_events(rail_handle, events);
+  }
+  kmesh_script_on_rail_event(events);
+  kmesh_notify_on_rail_event(rail_handle, events);
+  kmesh_power_on_rail_event(events);
+  kmesh_energy_on_rail_event(rail_handle, events);
+  kmesh_lbt_on_rail_event(events);
+  kmesh_prbs_on_rail_event(rail_handle, events);
+}
+
+RAIL_Handle_t kmesh_get_rail_handle(void)
+{
+  return sl_rail_util_get_handle(SL_RAIL_UTIL_HANDLE_INST0);
+}
+
+uint16_t kmesh_get_address(void)
+{
+  return kmesh_address;
+}
+
+void kmesh_set_address(uint16_t address)
+{
+  kmesh_address = address;
+}
+
+uint16_t kmesh_build_frame(uint8_t *frame,
+                           uint8_t type,
+                           uint16_t destination,
+                           uint16_t next_hop,
+                           const uint8_t *payload,
+                           uint16_t payload_length)
+{
+  kmesh_frame_header_t header = {
+    .length = KMESH_FRAME_HEADER_LENGTH + payload_length,
+    .type = type & KMESH_FRAME_TYPE_MASK,
+    .flags = type & KMESH_FRAME_FLAGS_MASK,
+    .destination = destination,
+    .source = kmesh_address,
+    .next_hop = next_hop,
+    .hop_limit = KMESH_DEFAULT_HOP_LIMIT,
+  };
+  CORE_DECLARE_IRQ_STATE;
+
+  if (payload_length > (KMESH_FRAME_MAX_LENGTH - KMESH_FRAME_HEADER_LENGTH)) {
+    return 0U;
+  }
+  // ACKs are built in the RX interrupt while the main loop may be building.
+  CORE_ENTER_ATOMIC();
+  header.sequence = kmesh_sequence++;
+  CORE_EXIT_ATOMIC();
+  if (!kmesh_frame_encode_header(frame, &header)) {
+    return 0U;
+  }
+  if (payload_length > 0U) {
+    memcpy(&frame[KMESH_FRAME_HEADER_LENGTH], payload, payload_length);
+  }
+  return header.length;
+}
+
+RAIL_Status_t kmesh_transmit(const uint8_t *frame, uint16_t length)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  uint16_t next_hop = kmesh_frame_get_u16(frame, KMESH_FRAME_OFFSET_NEXT_HOP);
+  RAIL_Status_t status;
+  uint16_t channel;
+  CORE_DECLARE_IRQ_STATE;
+
+  // The main loop and the RX interrupt (ACKs, forwards, echoes) both send;
+  // an interrupt between the busy check and the start would have its frame
+  // wiped by our FIFO reset, or wipe ours.
+  CORE_ENTER_ATOMIC();
+  // Resetting the TX FIFO would cut short a frame still on its way out,
+  // whether it is ours, a batch or PRBS run or a RAILtest transmission.
+  if ((RAIL_GetRadioState(rail_handle) & RAIL_RF_STATE_TX) == RAIL_RF_STATE_TX) {
+    status = RAIL_STATUS_INVALID_STATE;
+  } else {
+    status = RAIL_GetChannel(rail_handle, &channel);
+    if (status != RAIL_STATUS_NO_ERROR) {
+      CORE_EXIT_ATOMIC();
+      return status;
+    }
+    channel = kmesh_rate_tx_channel(next_hop, channel);
+    if (RAIL_WriteTxFifo(rail_handle, frame, length, true) != length) {
+      status = RAIL_STATUS_INVALID_STATE;
+    } else {
+      kmesh_tpc_apply(next_hop);
+      // ACKs go out straight after the turnaround: CSMA backoff would outlast
+      // the sender's ACK timeout, which only allows for the turnarounds.
+      status = kmesh_lbt_start_tx(rail_handle, channel,
+                                  kmesh_frame_get_type(frame) != KMESH_FRAME_TYPE_ACK);
+      if (status != RAIL_STATUS_NO_ERROR) {
+        kmesh_tpc_restore();
+      }
+    }
+  }
+  if (status != RAIL_STATUS_NO_ERROR) {
+    kmesh_counters.tx_errors++;
+  }
+  CORE_EXIT_ATOMIC();
+  return status;
+}
+
+RAIL_Status_t kmesh_send(uint16_t destination,
+                         uint8_t type,
+                         const uint8_t *payload,
+                         uint16_t payload_length)
+{
+  static uint8_t frame[KMESH_FRAME_MAX_LENGTH];
+  uint16_t next_hop = KMESH_ADDRESS_BROADCAST;
+  uint16_t length;
+
+  if (destination != KMESH_ADDRESS_BROADCAST) {
+    (void) kmesh_route_lookup(destination, &next_hop);
+  }
+  length = kmesh_build_frame(frame, type, destination, next_hop,
+                             payload, payload_length);
+  if (length == 0U) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  kmesh_counters.originated++;
+  return kmesh_transmit(frame, length);
+}
+
+uint32_t kmesh_airtime_us(uint16_t length)
+{
+  uint32_t bits = KMESH_PHY_PREAMBLE_BITS + KMESH_PHY_SYNC_WORD_BITS
+                  + ((uint32_t)length + KMESH_PHY_CRC_LENGTH) * 8U;
+  uint32_t bit_rate = RAIL_GetBitRate(kmesh_get_rail_handle());
+
+  if (bit_rate == 0U) {
+    return 0U;
+  }
+  return (uint32_t)(((uint64_t)bits * 1000000U + bit_rate - 1U) / bit_rate);
+}
+
+// xorshift32; only used for backoff jitter, not for anything security related.
+uint32_t kmesh_random(void)
+{
+  uint32_t x = kmesh_random_state;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  kmesh_random_state = x;
+  return x;
+}
+
+uint8_t *kmesh_rx_byte(const RAIL_RxPacketInfo_t *info, uint16_t offset)
+{
+  if (offset < info->firstPortionBytes) {
+    return &info->firstPortionData[offset];
+  }
+  return &info->lastPortionData[offset - info->firstPortionBytes];
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static void kmesh_on_rx_packet(RAIL_Handle_t rail_handle)
+{
+  RAIL_RxPacketInfo_t info;
+  RAIL_RxPacketHandle_t packet;
+  uint8_t raw[KMESH_FRAME_HEADER_LENGTH];
+  kmesh_frame_header_t header;
+
+  packet = RAIL_GetRxPacketInfo(rail_handle, RAIL_RX_PACKET_HANDLE_NEWEST, &info);
+  if ((packet == RAIL_RX_PACKET_HANDLE_INVALID)
+      || (info.packetStatus != RAIL_RX_PACKET_READY_SUCCESS)
+      || (info.packetBytes < KMESH_FRAME_HEADER_LENGTH)) {
+    return;
+  }
+  (void) RAIL_PeekRxPacket(rail_handle, packet, raw, sizeof(raw), 0U);
+  // Anything whose length header disagrees with what RAIL received is not a
+  // kmesh frame (e.g. a raw RAILtest payload); leave it to RAILtest.
+  if (!kmesh_frame_decode_header(raw, info.packetBytes, &header)) {
+    return;
+  }
+  // Test traffic, left to the PRBS checker.
+  if (header.type == KMESH_FRAME_TYPE_PRBS) {
+    return;
+  }
+  if (header.type == KMESH_FRAME_TYPE_BENCH && header.destination == kmesh_address) {
+    kmesh_bench_on_rx(rail_handle, packet, &info, &header);
+    return;
+  }
+
+  if (kmesh_arq_on_rx(rail_handle, packet, &info, &header)) {
+    return;
+  }
+  if (header.type == KMESH_FRAME_TYPE_DATA && header.destination == kmesh_address) {
+    kmesh_counters.delivered++;
+  }
+  if (header.type == KMESH_FRAME_TYPE_AGGREGATE) {
+    kmesh_aggr_on_rx(rail_handle, packet, &info, &header);
+    return;
+  }
+  kmesh_route_on_rx(rail_handle, packet, &info, &header);
+}
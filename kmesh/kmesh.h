@@ -0,0 +1,71 @@
+/***************************************************************************//**
+ * @file kmesh.h
+ * @brief kmesh networking layer running on top of RAILtest.
+ ******************************************************************************/
+
+#ifndef KMESH_H
+#define KMESH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+#include "kmesh_config.h"
+#include "kmesh_frame.h"
+
+_Static_assert(KMESH_FRAME_MAX_LENGTH <= KMESH_FRAME_LENGTH_LIMIT,
+               "KMESH_FRAME_MAX_LENGTH exceeds what the 11-bit length header holds");
+
+typedef struct kmesh_counters {
+  uint32_t originated;
+  uint32_t delivered;
+  uint32_t forwarded;
+  uint32_t no_route;
+  uint32_t hop_limit_exceeded;
+  uint32_t tx_errors;
+} kmesh_counters_t;
+
+extern kmesh_counters_t kmesh_counters;
+
+// Called from app_init() / app_process_action().
+void kmesh_init(void);
+void kmesh_process_action(void);
+
+// Contributed to the RAIL util event dispatch; runs in interrupt context
+// ahead of the RAILtest event handler.
+void kmesh_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events);
+
+RAIL_Handle_t kmesh_get_rail_handle(void);
+uint16_t kmesh_get_address(void);
+void kmesh_set_address(uint16_t address);
+
+// Fill in the length and kmesh headers of a frame and return its total
+// length, or 0 if the payload does not fit in KMESH_FRAME_MAX_LENGTH.
+uint16_t kmesh_build_frame(uint8_t *frame,
+                           uint8_t type,
+                           uint16_t destination,
+                           uint16_t next_hop,
+                           const uint8_t *payload,
+                           uint16_t payload_length);
+
+// Load a complete frame into the TX FIFO and start transmitting it on the
+// current channel. RAIL_STATUS_INVALID_STATE while a transmission is still
+// in progress.
+RAIL_Status_t kmesh_transmit(const uint8_t *frame, uint16_t length);
+
+// Originate a frame towards destination using the routing table, falling
+// back to a broadcast next hop when no route is known.
+RAIL_Status_t kmesh_send(uint16_t destination,
+                         uint8_t type,
+                         const uint8_t *payload,
+                         uint16_t payload_length);
+
+// Time on air of a frame of the given length (length header included) at
+// the current bit rate, preamble, sync word and CRC included.
+uint32_t kmesh_airtime_us(uint16_t length);
+
+uint32_t kmesh_random(void);
+
+// Access a byte of a packet still held in the RAIL RX FIFO, which may wrap.
+uint8_t *kmesh_rx_byte(const RAIL_RxPacketInfo_t *info, uint16_t offset);
+
+#endif // KMESH_H
@@ -0,0 +1,383 @@
+/***************************************************************************//**
+ * @file kmesh_aggr.c
+ * @brief Aggregation of small kmesh messages into shared frames per next hop.
+ *
+ * Short messages pay the full preamble, sync word, headers and CRC on every
+ * transmission. Messages queued here are packed into a single aggregate frame
+ * per next hop, which is transmitted once it is full or once the oldest
+ * message in it has waited for the flush deadline. Receivers split the frame
+ * back into messages, delivering their own and re-queueing the rest towards
+ * the next hop of each message's destination.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "sl_core.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_aggr.h"
+#include "kmesh_idle.h"
+#include "kmesh_notify.h"
+#include "kmesh_route.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_AGGR_MIN_LENGTH \
+  (KMESH_FRAME_HEADER_LENGTH + KMESH_AGGR_HEADER_LENGTH + 1U)
+// Received messages are queued as source (2), length (1), payload.
+#define KMESH_AGGR_RX_RECORD_HEADER_LENGTH 3U
+
+typedef struct kmesh_aggr_batch {
+  uint16_t next_hop;
+  // Bytes used in frame, kmesh header included; 0 when the batch is free.
+  uint16_t length;
+  uint8_t messages;
+  RAIL_Time_t opened;
+  uint8_t frame[KMESH_FRAME_MAX_LENGTH];
+} kmesh_aggr_batch_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static uint8_t *reserve_message(uint16_t next_hop,
+                                const kmesh_aggr_message_t *message);
+static void flush_batch(kmesh_aggr_batch_t *batch);
+static void print_received(void);
+static void rx_queue_put(const uint8_t *data, uint16_t length);
+static void rx_queue_get(uint8_t *data, uint16_t length);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_aggr_counters_t kmesh_aggr_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static kmesh_aggr_batch_t batches[KMESH_AGGR_BATCHES];
+static RAIL_Time_t flush_deadline_us = KMESH_AGGR_FLUSH_DEADLINE_MS * 1000UL;
+static uint16_t max_length = KMESH_FRAME_MAX_LENGTH;
+
+static uint8_t rx_queue[KMESH_AGGR_RX_QUEUE_SIZE];
+static uint16_t rx_queue_head;
+static uint16_t rx_queue_count;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_aggr_init(void)
+{
+  memset(batches, 0, sizeof(batches));
+  rx_queue_head = 0U;
+  rx_queue_count = 0U;
+}
+
+void kmesh_aggr_process_action(void)
+{
+  RAIL_Time_t now = RAIL_GetTime();
+
+  for (uint8_t i = 0U; i < KMESH_AGGR_BATCHES; i++) {
+    if (batches[i].length != 0U
+        && (RAIL_Time_t)(now - batches[i].opened) >= flush_deadline_us) {
+      flush_batch(&batches[i]);
+    }
+  }
+  print_received();
+}
+
+uint32_t kmesh_aggr_idle_us(RAIL_Time_t now)
+{
+  uint32_t idle_us = KMESH_IDLE_FOREVER;
+
+  for (uint8_t i = 0U; i < KMESH_AGGR_BATCHES; i++) {
+    RAIL_Time_t age = now - batches[i].opened;
+
+    if (batches[i].length == 0U) {
+      continue;
+    }
+    if (age >= flush_deadline_us) {
+      return 0U;
+    }
+    if (flush_deadline_us - age < idle_us) {
+      idle_us = flush_deadline_us - age;
+    }
+  }
+  return idle_us;
+}
+
+void kmesh_aggr_configure(uint16_t flush_deadline_ms, uint16_t length)
+{
+  if (length > KMESH_FRAME_MAX_LENGTH) {
+    length = KMESH_FRAME_MAX_LENGTH;
+  }
+  if (length < KMESH_AGGR_MIN_LENGTH) {
+    length = KMESH_AGGR_MIN_LENGTH;
+  }
+  flush_deadline_us = (RAIL_Time_t)flush_deadline_ms * 1000UL;
+  max_length = length;
+}
+
+uint16_t kmesh_aggr_get_flush_deadline_ms(void)
+{
+  return (uint16_t)(flush_deadline_us / 1000UL);
+}
+
+uint16_t kmesh_aggr_get_max_length(void)
+{
+  return max_length;
+}
+
+RAIL_Status_t kmesh_aggr_send(uint16_t destination,
+                              const uint8_t *payload,
+                              uint8_t payload_length)
+{
+  uint16_t next_hop = KMESH_ADDRESS_BROADCAST;
+  kmesh_aggr_message_t message = {
+    .destination = destination,
+    .source = kmesh_get_address(),
+    .hop_limit = KMESH_DEFAULT_HOP_LIMIT,
+    .length = payload_length,
+  };
+  uint8_t *data;
+  CORE_DECLARE_IRQ_STATE;
+
+  if ((uint16_t)(KMESH_FRAME_HEADER_LENGTH + KMESH_AGGR_HEADER_LENGTH
+                 + payload_length) > max_length) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  if (destination != KMESH_ADDRESS_BROADCAST) {
+    (void) kmesh_route_lookup(destination, &next_hop);
+  }
+
+  CORE_ENTER_ATOMIC();
+  data = reserve_message(next_hop, &message);
+  if (data == NULL) {
+    // No room left in this next hop's batch: send it early and start over.
+    for (uint8_t i = 0U; i < KMESH_AGGR_BATCHES; i++) {
+      if (batches[i].length != 0U && batches[i].next_hop == next_hop) {
+        flush_batch(&batches[i]);
+      }
+    }
+    data = reserve_message(next_hop, &message);
+  }
+  if (data != NULL) {
+    memcpy(data, payload, payload_length);
+    kmesh_aggr_counters.queued++;
+  }
+  CORE_EXIT_ATOMIC();
+
+  return (data != NULL) ? RAIL_STATUS_NO_ERROR : RAIL_STATUS_INVALID_STATE;
+}
+
+void kmesh_aggr_flush(void)
+{
+  for (uint8_t i = 0U; i < KMESH_AGGR_BATCHES; i++) {
+    if (batches[i].length != 0U) {
+      flush_batch(&batches[i]);
+    }
+  }
+}
+
+uint8_t kmesh_aggr_pending_batches(void)
+{
+  uint8_t pending = 0U;
+
+  for (uint8_t i = 0U; i < KMESH_AGGR_BATCHES; i++) {
+    if (batches[i].length != 0U) {
+      pending++;
+    }
+  }
+  return pending;
+}
+
+void kmesh_aggr_on_rx(RAIL_Handle_t rail_handle,
+                      RAIL_RxPacketHandle_t packet,
+                      const RAIL_RxPacketInfo_t *info,
+                      const kmesh_frame_header_t *header)
+{
+  uint8_t raw[KMESH_AGGR_HEADER_LENGTH];
+  kmesh_aggr_message_t message;
+  uint16_t address = kmesh_get_address();
+  uint16_t offset = KMESH_FRAME_HEADER_LENGTH;
+
+  if ((header->next_hop != address && header->next_hop != KMESH_ADDRESS_BROADCAST)
+      || header->source == address) {
+    return;
+  }
+
+  while ((offset + KMESH_AGGR_HEADER_LENGTH) <= header->length) {
+    (void) RAIL_PeekRxPacket(rail_handle, packet, raw, sizeof(raw), offset);
+    offset += KMESH_AGGR_HEADER_LENGTH;
+    kmesh_aggr_decode_message(raw, &message);
+    if ((offset + message.length) > header->length) {
+      break;
+    }
+
+    if (message.destination == address
+        || message.destination == KMESH_ADDRESS_BROADCAST) {
+      uint8_t record[KMESH_AGGR_RX_RECORD_HEADER_LENGTH];
+      kmesh_frame_put_u16(record, 0U, message.source);
+      record[2] = message.length;
+      if ((rx_queue_count + sizeof(record) + message.length)
+          <= KMESH_AGGR_RX_QUEUE_SIZE) {
+        rx_queue_put(record, sizeof(record));
+        for (uint8_t i = 0U; i < message.length; i++) {
+          rx_queue_put(kmesh_rx_byte(info, offset + i), 1U);
+        }
+        kmesh_aggr_counters.delivered++;
+      } else {
+        kmesh_aggr_counters.dropped++;
+      }
+    } else if (kmesh_route_is_enabled()) {
+      uint16_t relay_hop;
+      uint8_t *data;
+      if (message.hop_limit <= 1U) {
+        kmesh_counters.hop_limit_exceeded++;
+      } else if (!kmesh_route_lookup(message.destination, &relay_hop)) {
+        kmesh_counters.no_route++;
+      } else {
+        message.hop_limit--;
+        data = reserve_message(relay_hop, &message);
+        if (data != NULL) {
+          (void) RAIL_PeekRxPacket(rail_handle, packet, data, message.length, offset);
+          kmesh_aggr_counters.relayed++;
+        } else {
+          kmesh_aggr_counters.dropped++;
+        }
+      }
+    }
+    offset += message.length;
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Append a message header to the batch for next_hop, opening one if needed,
+// and return where its payload goes. Called with interrupts masked or from
+// the RAIL interrupt itself.
+static uint8_t *reserve_message(uint16_t next_hop,
+                                const kmesh_aggr_message_t *message)
+{
+  kmesh_aggr_batch_t *batch = NULL;
+  uint8_t *data;
+
+  for (uint8_t i = 0U; i < KMESH_AGGR_BATCHES; i++) {
+    if (batches[i].length != 0U && batches[i].next_hop == next_hop) {
+      batch = &batches[i];
+      break;
+    }
+    if (batches[i].length == 0U && batch == NULL) {
+      batch = &batches[i];
+    }
+  }
+  if (batch == NULL) {
+    return NULL;
+  }
+  if (batch->length == 0U) {
+    batch->next_hop = next_hop;
+    batch->length = KMESH_FRAME_HEADER_LENGTH;
+    batch->messages = 0U;
+    batch->opened = RAIL_GetTime();
+  }
+  if ((batch->length + KMESH_AGGR_HEADER_LENGTH + message->length) > max_length) {
+    return NULL;
+  }
+
+  data = &batch->frame[batch->length];
+  kmesh_aggr_encode_message(data, message);
+  batch->length += KMESH_AGGR_HEADER_LENGTH + message->length;
+  batch->messages++;
+  return &data[KMESH_AGGR_HEADER_LENGTH];
+}
+
+// Aggregates are addressed to the next hop itself; the end-to-end
+// destinations live in the per-message headers.
+static void flush_batch(kmesh_aggr_batch_t *batch)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  uint16_t length;
+  CORE_DECLARE_IRQ_STATE;
+
+  // Leave a frame already on its way out of the TX FIFO alone; the batch is
+  // retried on the next pass.
+  if ((RAIL_GetRadioState(rail_handle) & RAIL_RF_STATE_TX) == RAIL_RF_STATE_TX) {
+    return;
+  }
+
+  CORE_ENTER_ATOMIC();
+  length = batch->length;
+  if (length != 0U) {
+    (void) kmesh_build_frame(batch->frame, KMESH_FRAME_TYPE_AGGREGATE,
+                             batch->next_hop, batch->next_hop, NULL, 0U);
+    (void) kmesh_frame_encode_length(batch->frame, length);
+    if (kmesh_transmit(batch->frame, length) == RAIL_STATUS_NO_ERROR) {
+      kmesh_aggr_counters.frames++;
+      kmesh_aggr_counters.messages += batch->messages;
+    } else {
+      kmesh_aggr_counters.dropped += batch->messages;
+    }
+    batch->length = 0U;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+static void print_received(void)
+{
+  uint8_t record[KMESH_AGGR_RX_RECORD_HEADER_LENGTH];
+  uint8_t byte;
+  CORE_DECLARE_IRQ_STATE;
+
+  for (;;) {
+    CORE_ENTER_ATOMIC();
+    if (rx_queue_count == 0U) {
+      CORE_EXIT_ATOMIC();
+      return;
+    }
+    rx_queue_get(record, sizeof(record));
+    CORE_EXIT_ATOMIC();
+
+    if (!kmesh_notify_take()) {
+      CORE_ENTER_ATOMIC();
+      for (uint8_t i = 0U; i < record[2]; i++) {
+        rx_queue_get(&byte, 1U);
+      }
+      CORE_EXIT_ATOMIC();
+      continue;
+    }
+    responsePrintStart("meshRx");
+    responsePrintContinue("Source:0x%04x,Length:%u",
+                          kmesh_frame_get_u16(record, 0U), record[2]);
+    printf("{Payload:");
+    for (uint8_t i = 0U; i < record[2]; i++) {
+      CORE_ENTER_ATOMIC();
+      rx_queue_get(&byte, 1U);
+      CORE_EXIT_ATOMIC();
+      printf(" 0x%02x", byte);
+    }
+    printf("}");
+    responsePrintEnd("");
+  }
+}
+
+// The caller checks there is room for the whole record first.
+static void rx_queue_put(const uint8_t *data, uint16_t length)
+{
+  for (uint16_t i = 0U; i < length; i++) {
+    rx_queue[(rx_queue_head + rx_queue_count) % KMESH_AGGR_RX_QUEUE_SIZE] = data[i];
+    rx_queue_count++;
+  }
+}
+
+static void rx_queue_get(uint8_t *data, uint16_t length)
+{
+  for (uint16_t i = 0U; i < length; i++) {
+    data[i] = rx_queue[rx_queue_head];
+    rx_queue_head = (rx_queue_head + 1U) % KMESH_AGGR_RX_QUEUE_SIZE;
+    rx_queue_count--;
+  }
+}
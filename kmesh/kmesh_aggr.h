@@ -0,0 +1,57 @@
+/***************************************************************************//**
+ * @file kmesh_aggr.h
+ * @brief Aggregation of small kmesh messages into shared frames per next hop.
+ ******************************************************************************/
+
+#ifndef KMESH_AGGR_H
+#define KMESH_AGGR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+#include "kmesh_frame.h"
+
+typedef struct kmesh_aggr_counters {
+  uint32_t queued;
+  uint32_t frames;
+  uint32_t messages;
+  uint32_t delivered;
+  uint32_t relayed;
+  uint32_t dropped;
+} kmesh_aggr_counters_t;
+
+extern kmesh_aggr_counters_t kmesh_aggr_counters;
+
+void kmesh_aggr_init(void);
+
+// Transmits batches whose flush deadline has passed and prints messages
+// split out of received aggregates. Called from kmesh_process_action().
+void kmesh_aggr_process_action(void);
+
+// Microseconds until the oldest open batch is due, or KMESH_IDLE_FOREVER.
+uint32_t kmesh_aggr_idle_us(RAIL_Time_t now);
+
+// Flush deadline in milliseconds and the largest aggregate frame to build,
+// length header included. max_length is clamped to KMESH_FRAME_MAX_LENGTH.
+void kmesh_aggr_configure(uint16_t flush_deadline_ms, uint16_t max_length);
+uint16_t kmesh_aggr_get_flush_deadline_ms(void);
+uint16_t kmesh_aggr_get_max_length(void);
+
+// Queue a message for the next hop towards destination. It goes out when the
+// batch is full or the flush deadline expires, whichever comes first.
+RAIL_Status_t kmesh_aggr_send(uint16_t destination,
+                              const uint8_t *payload,
+                              uint8_t payload_length);
+
+// Transmit every open batch now.
+void kmesh_aggr_flush(void);
+
+uint8_t kmesh_aggr_pending_batches(void);
+
+// Interrupt-context hook for received aggregate frames.
+void kmesh_aggr_on_rx(RAIL_Handle_t rail_handle,
+                      RAIL_RxPacketHandle_t packet,
+                      const RAIL_RxPacketInfo_t *info,
+                      const kmesh_frame_header_t *header);
+
+#endif // KMESH_AGGR_H
@@ -0,0 +1,409 @@
+/***************************************************************************//**
+ * @file kmesh_arq.c
+ * @brief Per-destination acknowledged delivery with retransmission.
+ *
+ * Stop-and-wait per destination. A data frame sent with
+ * KMESH_FRAME_FLAG_ACK_REQUEST is acknowledged either explicitly, by an ACK
+ * frame from the final destination (carrying the RSSI it received the frame
+ * at), or implicitly, by overhearing the next hop forward the same
+ * source/sequence pair. Frames that time out are retransmitted after a random
+ * backoff whose window doubles on every attempt, LBT style.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "sl_core.h"
+#include "kmesh.h"
+#include "kmesh_arq.h"
+#include "kmesh_idle.h"
+#include "kmesh_lbt.h"
+#include "kmesh_route.h"
+#include "kmesh_rate.h"
+#include "kmesh_tpc.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_ARQ_ACK_PAYLOAD_LENGTH 1U
+#define KMESH_ARQ_NO_SLOT            0xFFU
+
+typedef enum kmesh_arq_state {
+  KMESH_ARQ_IDLE,
+  KMESH_ARQ_TRANSMITTING,
+  KMESH_ARQ_WAIT_ACK,
+  KMESH_ARQ_BACKOFF,
+} kmesh_arq_state_t;
+
+typedef struct kmesh_arq_slot {
+  RAIL_MultiTimer_t timer;
+  kmesh_arq_state_t state;
+  bool assigned;
+  uint16_t destination;
+  uint8_t sequence;
+  uint8_t attempts;
+  uint16_t length;
+  uint8_t frame[KMESH_FRAME_MAX_LENGTH];
+} kmesh_arq_slot_t;
+
+typedef struct kmesh_arq_seen {
+  uint16_t source;
+  uint8_t sequence;
+  bool valid;
+} kmesh_arq_seen_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void transmit_slot(kmesh_arq_slot_t *slot);
+static void retry_or_fail(kmesh_arq_slot_t *slot);
+static RAIL_Time_t slot_timeout(const kmesh_arq_slot_t *slot);
+static void complete_slot(kmesh_arq_slot_t *slot);
+static void timer_expired(RAIL_MultiTimer_t *timer,
+                          RAIL_Time_t expected_time,
+                          void *cb_arg);
+static kmesh_arq_slot_t *find_slot(uint16_t destination);
+static kmesh_arq_slot_t *claim_slot(uint16_t destination);
+static bool check_duplicate(uint16_t source, uint8_t sequence);
+static void send_ack(const kmesh_frame_header_t *header, int8_t rssi);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_arq_counters_t kmesh_arq_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static kmesh_arq_slot_t slots[KMESH_ARQ_DESTINATIONS];
+static kmesh_arq_seen_t seen[KMESH_ARQ_DESTINATIONS];
+static uint8_t seen_next;
+// Slot whose frame currently occupies the TX FIFO.
+static uint8_t tx_slot = KMESH_ARQ_NO_SLOT;
+
+static uint8_t max_retries = KMESH_ARQ_MAX_RETRIES;
+static uint8_t min_backoff = KMESH_ARQ_MIN_BACKOFF;
+static uint8_t max_backoff = KMESH_ARQ_MAX_BACKOFF;
+static uint16_t backoff_us = KMESH_ARQ_BACKOFF_US;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_arq_init(void)
+{
+  (void) RAIL_ConfigMultiTimer(true);
+  for (uint8_t i = 0U; i < KMESH_ARQ_DESTINATIONS; i++) {
+    slots[i].state = KMESH_ARQ_IDLE;
+    slots[i].assigned = false;
+    seen[i].valid = false;
+  }
+}
+
+void kmesh_arq_configure(uint8_t retries,
+                         uint8_t min_bo,
+                         uint8_t max_bo,
+                         uint16_t period_us)
+{
+  max_retries = retries;
+  min_backoff = min_bo;
+  max_backoff = (max_bo < min_bo) ? min_bo : max_bo;
+  backoff_us = period_us;
+}
+
+RAIL_Time_t kmesh_arq_get_ack_timeout(void)
+{
+  RAIL_StateTiming_t timings = { 0 };
+
+  // Our TX->RX turnaround, the peer's RX->TX turnaround, then the ACK itself.
+  (void) RAIL_GetStateTiming(kmesh_get_rail_handle(), &timings);
+  return (RAIL_Time_t)timings.txToRx + timings.rxToTx
+         + kmesh_airtime_us(KMESH_FRAME_HEADER_LENGTH + KMESH_ARQ_ACK_PAYLOAD_LENGTH)
+         + KMESH_ARQ_ACK_MARGIN_US;
+}
+
+RAIL_Status_t kmesh_arq_send(uint16_t destination,
+                             const uint8_t *payload,
+                             uint16_t payload_length)
+{
+  kmesh_arq_slot_t *slot;
+  uint16_t next_hop = destination;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (destination == KMESH_ADDRESS_BROADCAST) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  (void) kmesh_route_lookup(destination, &next_hop);
+
+  CORE_ENTER_ATOMIC();
+  slot = claim_slot(destination);
+  if (slot == NULL || slot->state != KMESH_ARQ_IDLE) {
+    CORE_EXIT_ATOMIC();
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  slot->length = kmesh_build_frame(slot->frame, KMESH_FRAME_TYPE_DATA
+                                   | KMESH_FRAME_FLAG_ACK_REQUEST,
+                                   destination, next_hop, payload,
+                                   payload_length);
+  if (slot->length == 0U) {
+    CORE_EXIT_ATOMIC();
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  if (!slot->assigned) {
+    slot->assigned = true;
+    slot->destination = destination;
+    slot->sequence = (uint8_t)kmesh_random();
+  }
+  slot->frame[KMESH_FRAME_OFFSET_SEQUENCE] = ++slot->sequence;
+  slot->attempts = 0U;
+  kmesh_counters.originated++;
+  kmesh_arq_counters.sent++;
+  transmit_slot(slot);
+  CORE_EXIT_ATOMIC();
+  return RAIL_STATUS_NO_ERROR;
+}
+
+uint32_t kmesh_arq_idle_us(void)
+{
+  uint32_t idle_us = KMESH_IDLE_FOREVER;
+
+  for (uint8_t i = 0U; i < KMESH_ARQ_DESTINATIONS; i++) {
+    if (slots[i].state != KMESH_ARQ_IDLE && RAIL_IsMultiTimerRunning(&slots[i].timer)) {
+      RAIL_Time_t left = RAIL_GetMultiTimer(&slots[i].timer, RAIL_TIME_DELAY);
+
+      if (left < idle_us) {
+        idle_us = left;
+      }
+    }
+  }
+  return idle_us;
+}
+
+bool kmesh_arq_is_busy(uint16_t destination)
+{
+  kmesh_arq_slot_t *slot = find_slot(destination);
+
+  return (slot != NULL && slot->state != KMESH_ARQ_IDLE);
+}
+
+bool kmesh_arq_on_rx(RAIL_Handle_t rail_handle,
+                     RAIL_RxPacketHandle_t packet,
+                     const RAIL_RxPacketInfo_t *info,
+                     const kmesh_frame_header_t *header)
+{
+  uint8_t type = header->type;
+  uint8_t sequence = header->sequence;
+  uint16_t source = header->source;
+  uint16_t destination = header->destination;
+  uint16_t next_hop = header->next_hop;
+  uint16_t address = kmesh_get_address();
+
+  if (type == KMESH_FRAME_TYPE_ACK) {
+    kmesh_arq_slot_t *slot = find_slot(source);
+    if (destination == address && slot != NULL
+        && slot->state != KMESH_ARQ_IDLE && slot->sequence == sequence) {
+      // The reported RSSI is of our own frame only if it went out directly.
+      if (header->length >= KMESH_FRAME_HEADER_LENGTH + KMESH_ARQ_ACK_PAYLOAD_LENGTH
+          && kmesh_frame_get_u16(slot->frame, KMESH_FRAME_OFFSET_NEXT_HOP) == source) {
+        int8_t rssi = (int8_t)*kmesh_rx_byte(info, KMESH_FRAME_HEADER_LENGTH);
+
+        kmesh_tpc_on_ack(source, rssi);
+        kmesh_rate_on_ack(source, rssi);
+      }
+      complete_slot(slot);
+    }
+    return false;
+  }
+  if (type != KMESH_FRAME_TYPE_DATA) {
+    return false;
+  }
+
+  // Our own frame relayed by the next hop counts as its acknowledgement.
+  if (source == address) {
+    kmesh_arq_slot_t *slot = find_slot(destination);
+    if (slot != NULL && slot->state != KMESH_ARQ_IDLE
+        && slot->sequence == sequence) {
+      complete_slot(slot);
+    }
+    return false;
+  }
+
+  if ((header->flags & KMESH_FRAME_FLAG_ACK_REQUEST) == 0U
+      || (next_hop != address && next_hop != KMESH_ADDRESS_BROADCAST)) {
+    return false;
+  }
+  if (destination == address) {
+    RAIL_RxPacketDetails_t details;
+    if (RAIL_GetRxPacketDetailsAlt(rail_handle, packet, &details)
+        != RAIL_STATUS_NO_ERROR) {
+      details.rssi = RAIL_RSSI_INVALID_DBM;
+    }
+    send_ack(header, details.rssi);
+  }
+  if (check_duplicate(source, sequence)) {
+    kmesh_arq_counters.duplicates++;
+    // A relay forwards the retransmission again: overhearing the forward is
+    // the sender's only acknowledgement, so it must have missed the first.
+    // The final destination suppresses it.
+    return destination == address;
+  }
+  return false;
+}
+
+void kmesh_arq_on_tx_events(RAIL_Events_t events)
+{
+  kmesh_arq_slot_t *slot;
+
+  if (tx_slot == KMESH_ARQ_NO_SLOT) {
+    return;
+  }
+  slot = &slots[tx_slot];
+  tx_slot = KMESH_ARQ_NO_SLOT;
+  if (slot->state != KMESH_ARQ_TRANSMITTING) {
+    return;
+  }
+  if ((events & RAIL_EVENT_TX_PACKET_SENT) != 0U) {
+    slot->state = KMESH_ARQ_WAIT_ACK;
+    (void) RAIL_SetMultiTimer(&slot->timer, slot_timeout(slot),
+                              RAIL_TIME_DELAY, &timer_expired, slot);
+  } else {
+    retry_or_fail(slot);
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static void transmit_slot(kmesh_arq_slot_t *slot)
+{
+  slot->state = KMESH_ARQ_TRANSMITTING;
+  slot->attempts++;
+  tx_slot = (uint8_t)(slot - slots);
+  if (kmesh_transmit(slot->frame, slot->length) != RAIL_STATUS_NO_ERROR) {
+    tx_slot = KMESH_ARQ_NO_SLOT;
+    retry_or_fail(slot);
+  }
+}
+
+static void retry_or_fail(kmesh_arq_slot_t *slot)
+{
+  uint32_t window;
+  RAIL_Time_t delay;
+
+  if (slot->attempts > max_retries) {
+    slot->state = KMESH_ARQ_IDLE;
+    kmesh_arq_counters.failed++;
+    return;
+  }
+  kmesh_arq_counters.retried++;
+  window = (uint32_t)min_backoff << (slot->attempts - 1U);
+  if (window > max_backoff) {
+    window = max_backoff;
+  }
+  delay = (kmesh_random() % (window + 1U)) * backoff_us;
+  slot->state = KMESH_ARQ_BACKOFF;
+  (void) RAIL_SetMultiTimer(&slot->timer, (delay == 0U) ? 1U : delay,
+                            RAIL_TIME_DELAY, &timer_expired, slot);
+}
+
+// A frame to a relay is acknowledged by overhearing its forward, which is
+// as long as the frame and goes through CSMA like any data frame.
+static RAIL_Time_t slot_timeout(const kmesh_arq_slot_t *slot)
+{
+  RAIL_StateTiming_t timings = { 0 };
+
+  if (kmesh_frame_get_u16(slot->frame, KMESH_FRAME_OFFSET_NEXT_HOP) == slot->destination) {
+    return kmesh_arq_get_ack_timeout();
+  }
+  (void) RAIL_GetStateTiming(kmesh_get_rail_handle(), &timings);
+  return (RAIL_Time_t)timings.txToRx + timings.rxToTx
+         + kmesh_lbt_max_delay_us() + kmesh_airtime_us(slot->length)
+         + KMESH_ARQ_ACK_MARGIN_US;
+}
+
+static void complete_slot(kmesh_arq_slot_t *slot)
+{
+  (void) RAIL_CancelMultiTimer(&slot->timer);
+  if (tx_slot == (uint8_t)(slot - slots)) {
+    tx_slot = KMESH_ARQ_NO_SLOT;
+  }
+  slot->state = KMESH_ARQ_IDLE;
+  kmesh_arq_counters.delivered++;
+}
+
+static void timer_expired(RAIL_MultiTimer_t *timer,
+                          RAIL_Time_t expected_time,
+                          void *cb_arg)
+{
+  kmesh_arq_slot_t *slot = (kmesh_arq_slot_t *)cb_arg;
+
+  (void) timer;
+  (void) expected_time;
+  if (slot->state == KMESH_ARQ_WAIT_ACK) {
+    uint16_t next_hop = kmesh_frame_get_u16(slot->frame, KMESH_FRAME_OFFSET_NEXT_HOP);
+
+    kmesh_tpc_on_miss(next_hop);
+    kmesh_rate_on_miss(next_hop);
+    retry_or_fail(slot);
+  } else if (slot->state == KMESH_ARQ_BACKOFF) {
+    transmit_slot(slot);
+  }
+}
+
+static kmesh_arq_slot_t *find_slot(uint16_t destination)
+{
+  for (uint8_t i = 0U; i < KMESH_ARQ_DESTINATIONS; i++) {
+    if (slots[i].assigned && slots[i].destination == destination) {
+      return &slots[i];
+    }
+  }
+  return NULL;
+}
+
+// The slot already bound to destination, else an idle one to rebind, which
+// restarts the sequence numbering for that destination.
+static kmesh_arq_slot_t *claim_slot(uint16_t destination)
+{
+  kmesh_arq_slot_t *slot = find_slot(destination);
+
+  for (uint8_t i = 0U; (slot == NULL) && (i < KMESH_ARQ_DESTINATIONS); i++) {
+    if (slots[i].state == KMESH_ARQ_IDLE) {
+      slot = &slots[i];
+      slot->assigned = false;
+    }
+  }
+  return slot;
+}
+
+static bool check_duplicate(uint16_t source, uint8_t sequence)
+{
+  for (uint8_t i = 0U; i < KMESH_ARQ_DESTINATIONS; i++) {
+    if (seen[i].valid && seen[i].source == source) {
+      if (seen[i].sequence == sequence) {
+        return true;
+      }
+      seen[i].sequence = sequence;
+      return false;
+    }
+  }
+  seen[seen_next].valid = true;
+  seen[seen_next].source = source;
+  seen[seen_next].sequence = sequence;
+  seen_next = (seen_next + 1U) % KMESH_ARQ_DESTINATIONS;
+  return false;
+}
+
+static void send_ack(const kmesh_frame_header_t *header, int8_t rssi)
+{
+  static uint8_t ack[KMESH_FRAME_HEADER_LENGTH + KMESH_ARQ_ACK_PAYLOAD_LENGTH];
+  uint8_t payload = (uint8_t)rssi;
+  uint16_t next_hop = KMESH_ADDRESS_BROADCAST;
+  uint16_t length;
+
+  // A source several hops away is reached like any data frame, through the
+  // routing table.
+  (void) kmesh_route_lookup(header->source, &next_hop);
+  length = kmesh_build_frame(ack, KMESH_FRAME_TYPE_ACK, header->source,
+                             next_hop, &payload, sizeof(payload));
+  ack[KMESH_FRAME_OFFSET_SEQUENCE] = header->sequence;
+  (void) kmesh_transmit(ack, length);
+}
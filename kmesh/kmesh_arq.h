@@ -0,0 +1,57 @@
+/***************************************************************************//**
+ * @file kmesh_arq.h
+ * @brief Per-destination acknowledged delivery with retransmission.
+ ******************************************************************************/
+
+#ifndef KMESH_ARQ_H
+#define KMESH_ARQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+#include "kmesh_frame.h"
+
+typedef struct kmesh_arq_counters {
+  uint32_t sent;
+  uint32_t delivered;
+  uint32_t retried;
+  uint32_t failed;
+  uint32_t duplicates;
+} kmesh_arq_counters_t;
+
+extern kmesh_arq_counters_t kmesh_arq_counters;
+
+void kmesh_arq_init(void);
+
+// Retry and backoff parameters; the backoff arguments mirror setLbtParams.
+void kmesh_arq_configure(uint8_t max_retries,
+                         uint8_t min_backoff,
+                         uint8_t max_backoff,
+                         uint16_t backoff_us);
+
+// ACK timeout derived from the current state timings and bit rate. Frames
+// sent through a relay wait longer, for the relay's forward.
+RAIL_Time_t kmesh_arq_get_ack_timeout(void);
+
+// Send a data frame that must be acknowledged by its next hop. Only one frame
+// per destination is in flight; RAIL_STATUS_INVALID_STATE means busy.
+RAIL_Status_t kmesh_arq_send(uint16_t destination,
+                             const uint8_t *payload,
+                             uint16_t payload_length);
+
+// Microseconds until the next ACK timeout or retransmission, or
+// KMESH_IDLE_FOREVER.
+uint32_t kmesh_arq_idle_us(void);
+
+bool kmesh_arq_is_busy(uint16_t destination);
+
+// Interrupt-context hooks. kmesh_arq_on_rx() returns true if the frame is a
+// retransmission already delivered here, in which case it must not be
+// processed again. Retransmissions to relay are still passed on.
+bool kmesh_arq_on_rx(RAIL_Handle_t rail_handle,
+                     RAIL_RxPacketHandle_t packet,
+                     const RAIL_RxPacketInfo_t *info,
+                     const kmesh_frame_header_t *header);
+void kmesh_arq_on_tx_events(RAIL_Events_t events);
+
+#endif // KMESH_ARQ_H
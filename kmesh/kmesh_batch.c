@@ -0,0 +1,319 @@
+/***************************************************************************//**
+ * @file kmesh_batch.c
+ * @brief Batch TX: a queue of distinct packets sent back to back.
+ *
+ * txAtN, setNextTxRepeat and configTxRepeatStartToStart repeat one payload.
+ * The batch queue holds up to KMESH_BATCH_ENTRIES packets, each with its own
+ * length, channel, power and optional start time, their bytes packed into one
+ * pool. A run starts the first packet from the CLI; every later one is
+ * loaded into the TX FIFO and started from the TX completion interrupt of
+ * the one before, so there is no CLI or main loop latency between packets.
+ *
+ * Powers are converted to raw PA levels when a packet is queued, so the
+ * per-packet cost is a FIFO write, a PA register write and the start.
+ * Timed packets are scheduled relative to the start of their pass through
+ * the queue; one whose time has already gone goes out at once and counts
+ * as late.
+ *
+ * The FIFO write resets the TX FIFO, so a packet is never started while
+ * another transmission (an ARQ frame, an ACK, a forward) is on the air; the
+ * run waits for that transmission's completion instead and counts the wait.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_batch.h"
+#include "kmesh_prbs.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_BATCH_PERMILLE  1000U
+
+typedef struct kmesh_batch_slot {
+  kmesh_batch_entry_t entry;
+  uint16_t offset;
+  RAIL_TxPowerLevel_t level;
+} kmesh_batch_slot_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static RAIL_Status_t start_slot(RAIL_Handle_t rail_handle, const kmesh_batch_slot_t *slot);
+static void start_next(void);
+static void finish(void);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_batch_counters_t kmesh_batch_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static kmesh_batch_slot_t slots[KMESH_BATCH_ENTRIES];
+static uint8_t pool[KMESH_BATCH_POOL_SIZE];
+static uint8_t count;
+static uint16_t pool_used;
+
+static volatile bool running;
+static volatile bool stopping;
+static volatile bool done;
+static bool tx_pending;
+// Waiting for someone else's transmission to complete.
+static bool deferred;
+static uint8_t next_slot;
+static uint8_t failures_in_row;
+static uint32_t pass_limit;
+static RAIL_Time_t run_start;
+static RAIL_Time_t pass_start;
+static RAIL_TxPowerLevel_t saved_level;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+RAIL_Status_t kmesh_batch_add(const uint8_t *data, uint16_t data_length, uint16_t length,
+                              uint16_t channel, int16_t power_ddbm, uint32_t offset_us)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  RAIL_TxPowerConfig_t config;
+  kmesh_batch_slot_t *slot;
+
+  if (running) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  if (length == 0U || data_length > length || count >= KMESH_BATCH_ENTRIES
+      || length > KMESH_BATCH_POOL_SIZE - pool_used) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  slot = &slots[count];
+  slot->entry.length = length;
+  slot->entry.channel = channel;
+  slot->entry.power_ddbm = power_ddbm;
+  slot->entry.offset_us = offset_us;
+  slot->offset = pool_used;
+  if (power_ddbm != KMESH_BATCH_POWER_KEEP) {
+    if (RAIL_GetTxPowerConfig(rail_handle, &config) != RAIL_STATUS_NO_ERROR) {
+      return RAIL_STATUS_INVALID_STATE;
+    }
+    slot->level = RAIL_ConvertDbmToRaw(rail_handle, config.mode, (RAIL_TxPower_t)power_ddbm);
+  }
+  memcpy(&pool[pool_used], data, data_length);
+  for (uint16_t i = data_length; i < length; i++) {
+    pool[pool_used + i] = (uint8_t)i;
+  }
+  pool_used += length;
+  count++;
+  return RAIL_STATUS_NO_ERROR;
+}
+
+RAIL_Status_t kmesh_batch_clear(void)
+{
+  if (running) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  count = 0U;
+  pool_used = 0U;
+  return RAIL_STATUS_NO_ERROR;
+}
+
+uint8_t kmesh_batch_get_count(void)
+{
+  return count;
+}
+
+uint16_t kmesh_batch_get_free(void)
+{
+  return KMESH_BATCH_POOL_SIZE - pool_used;
+}
+
+bool kmesh_batch_get_entry(uint8_t index, kmesh_batch_entry_t *entry)
+{
+  if (index >= count) {
+    return false;
+  }
+  *entry = slots[index].entry;
+  return true;
+}
+
+RAIL_Status_t kmesh_batch_start(uint32_t passes)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  CORE_DECLARE_IRQ_STATE;
+
+  if (count == 0U) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  if (running || kmesh_prbs_tx_is_running()) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  CORE_ENTER_ATOMIC();
+  memset(&kmesh_batch_counters, 0, sizeof(kmesh_batch_counters));
+  saved_level = RAIL_GetTxPower(rail_handle);
+  pass_limit = passes;
+  next_slot = 0U;
+  failures_in_row = 0U;
+  deferred = false;
+  stopping = false;
+  done = false;
+  running = true;
+  run_start = RAIL_GetTime();
+  start_next();
+  CORE_EXIT_ATOMIC();
+  return running ? RAIL_STATUS_NO_ERROR : RAIL_STATUS_INVALID_STATE;
+}
+
+// A packet already started or scheduled still goes out.
+void kmesh_batch_stop(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (running) {
+    stopping = true;
+    if (!tx_pending) {
+      finish();
+    }
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_batch_is_running(void)
+{
+  return running;
+}
+
+void kmesh_batch_on_tx_events(RAIL_Events_t events)
+{
+  const kmesh_batch_entry_t *entry;
+
+  if (running && deferred) {
+    deferred = false;
+    if (stopping) {
+      finish();
+    } else {
+      start_next();
+    }
+    return;
+  }
+  if (!running || !tx_pending) {
+    return;
+  }
+  tx_pending = false;
+  // next_slot moved past the packet that just completed.
+  entry = &slots[next_slot - 1U].entry;
+  if ((events & RAIL_EVENT_TX_PACKET_SENT) != 0U) {
+    kmesh_batch_counters.sent++;
+    kmesh_batch_counters.airtime_us += kmesh_airtime_us(entry->length);
+  } else {
+    kmesh_batch_counters.errors++;
+  }
+  kmesh_batch_counters.elapsed_us = RAIL_GetTime() - run_start;
+  if (stopping) {
+    finish();
+    return;
+  }
+  start_next();
+}
+
+void kmesh_batch_process_action(void)
+{
+  kmesh_batch_counters_t snapshot;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!done) {
+    return;
+  }
+  CORE_ENTER_ATOMIC();
+  done = false;
+  snapshot = kmesh_batch_counters;
+  CORE_EXIT_ATOMIC();
+  responsePrint("batchTxDone",
+                "Sent:%lu,Errors:%lu,Late:%lu,Deferred:%lu,Passes:%lu,ElapsedUs:%lu,"
+                "AirtimeUs:%lu,OccupancyPermille:%lu",
+                snapshot.sent, snapshot.errors, snapshot.late, snapshot.deferred,
+                snapshot.passes,
+                snapshot.elapsed_us, snapshot.airtime_us,
+                (snapshot.elapsed_us != 0U)
+                ? (uint32_t)((uint64_t)snapshot.airtime_us * KMESH_BATCH_PERMILLE
+                             / snapshot.elapsed_us) : 0U);
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static RAIL_Status_t start_slot(RAIL_Handle_t rail_handle, const kmesh_batch_slot_t *slot)
+{
+  const kmesh_batch_entry_t *entry = &slot->entry;
+  RAIL_ScheduleTxConfig_t schedule = {
+    .when = pass_start + entry->offset_us,
+    .mode = RAIL_TIME_ABSOLUTE,
+    .txDuringRx = RAIL_SCHEDULED_TX_DURING_RX_POSTPONE_TX,
+  };
+
+  if (RAIL_WriteTxFifo(rail_handle, &pool[slot->offset], entry->length, true)
+      != entry->length) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  (void) RAIL_SetTxPower(rail_handle, (entry->power_ddbm == KMESH_BATCH_POWER_KEEP)
+                         ? saved_level : slot->level);
+  if (entry->offset_us != 0U) {
+    if ((int32_t)(schedule.when - RAIL_GetTime()) > 0) {
+      return RAIL_StartScheduledTx(rail_handle, entry->channel, RAIL_TX_OPTIONS_DEFAULT,
+                                   &schedule, NULL);
+    }
+    kmesh_batch_counters.late++;
+  }
+  return RAIL_StartTx(rail_handle, entry->channel, RAIL_TX_OPTIONS_DEFAULT, NULL);
+}
+
+// Start packets until one is on its way, the passes are done, or a whole
+// pass worth of them failed to start in a row.
+static void start_next(void)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+
+  while (running) {
+    if (next_slot == count) {
+      next_slot = 0U;
+      kmesh_batch_counters.passes++;
+      if (pass_limit != 0U && kmesh_batch_counters.passes >= pass_limit) {
+        break;
+      }
+    }
+    if ((RAIL_GetRadioState(rail_handle) & RAIL_RF_STATE_TX) == RAIL_RF_STATE_TX) {
+      // Resumed from that transmission's completion.
+      kmesh_batch_counters.deferred++;
+      deferred = true;
+      return;
+    }
+    if (next_slot == 0U) {
+      pass_start = RAIL_GetTime();
+    }
+    if (start_slot(rail_handle, &slots[next_slot++]) == RAIL_STATUS_NO_ERROR) {
+      failures_in_row = 0U;
+      tx_pending = true;
+      return;
+    }
+    kmesh_batch_counters.errors++;
+    if (++failures_in_row >= count) {
+      break;
+    }
+  }
+  finish();
+}
+
+static void finish(void)
+{
+  running = false;
+  stopping = false;
+  tx_pending = false;
+  deferred = false;
+  (void) RAIL_SetTxPower(kmesh_get_rail_handle(), saved_level);
+  done = true;
+}
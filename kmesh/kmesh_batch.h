@@ -0,0 +1,65 @@
+/***************************************************************************//**
+ * @file kmesh_batch.h
+ * @brief Batch TX: a queue of distinct packets sent back to back.
+ ******************************************************************************/
+
+#ifndef KMESH_BATCH_H
+#define KMESH_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+// Power of an entry that is sent at the power RAIL had when the run started.
+#define KMESH_BATCH_POWER_KEEP  INT16_MAX
+
+typedef struct kmesh_batch_entry {
+  uint16_t length;
+  uint16_t channel;
+  int16_t power_ddbm;
+  // Start time after the start of the pass through the queue; 0 sends it
+  // as soon as the previous packet is done.
+  uint32_t offset_us;
+} kmesh_batch_entry_t;
+
+typedef struct kmesh_batch_counters {
+  uint32_t sent;
+  // Transmissions that failed to start or ended in anything but TX_PACKET_SENT.
+  uint32_t errors;
+  // Timed entries whose start time had already passed.
+  uint32_t late;
+  // Packets held back until another transmission had completed.
+  uint32_t deferred;
+  uint32_t passes;
+  // First start to last completion, and the airtime of the packets sent.
+  uint32_t elapsed_us;
+  uint32_t airtime_us;
+} kmesh_batch_counters_t;
+
+extern kmesh_batch_counters_t kmesh_batch_counters;
+
+// Queue a packet of length bytes: the given bytes, then an incrementing
+// pattern for the rest. Written to the TX FIFO as is, so it includes any
+// length header the PHY expects.
+RAIL_Status_t kmesh_batch_add(const uint8_t *data, uint16_t data_length, uint16_t length,
+                              uint16_t channel, int16_t power_ddbm, uint32_t offset_us);
+// RAIL_STATUS_INVALID_STATE while running.
+RAIL_Status_t kmesh_batch_clear(void);
+uint8_t kmesh_batch_get_count(void);
+uint16_t kmesh_batch_get_free(void);
+bool kmesh_batch_get_entry(uint8_t index, kmesh_batch_entry_t *entry);
+
+// Send the queue passes times over, 0 meaning until stopped. The power RAIL
+// had is restored at the end. Prints batchTxDone when done.
+RAIL_Status_t kmesh_batch_start(uint32_t passes);
+void kmesh_batch_stop(void);
+bool kmesh_batch_is_running(void);
+
+// Starts the next packet from the TX completion of the previous one, or of
+// the transmission a packet was held back for. Interrupt context.
+void kmesh_batch_on_tx_events(RAIL_Events_t events);
+
+// Reports the end of a run. Called from kmesh_process_action().
+void kmesh_batch_process_action(void);
+
+#endif // KMESH_BATCH_H
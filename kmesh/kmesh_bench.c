@@ -0,0 +1,604 @@
+/***************************************************************************//**
+ * @file kmesh_bench.c
+ * @brief Goodput and round-trip latency benchmark between two kmesh nodes.
+ *
+ * RAILtest's throughput command times one-way transmissions on the local
+ * node only. This benchmark runs between two nodes over the regular kmesh
+ * TX path (rate, power and LBT included), so its numbers compare firmware
+ * builds and PHY configurations end to end.
+ *
+ * With echo, the peer sends every request back at the same length, so both
+ * directions carry payload. Up to window requests are in flight; one not
+ * echoed within a timeout scaled to the window is retransmitted, up to
+ * KMESH_BENCH_MAX_RETRIES times. The round trip is taken from RAIL
+ * timestamps, the end of the request as sent to the end of the echo as
+ * received, and only for frames echoed on their first attempt, since the
+ * echo of a retransmitted frame may answer any of its copies. Round trips
+ * are kept in a reservoir of KMESH_BENCH_RTT_SAMPLES for the percentiles.
+ *
+ * Without echo, frames go out back to back and the peer answers a report
+ * request at the end with the frames and bytes it received.
+ *
+ * Any node echoes and counts benchmark frames addressed to it; only the
+ * node running the benchmark needs a command.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_bench.h"
+#include "kmesh_idle.h"
+#include "kmesh_route.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_BENCH_PERMILLE  1000U
+#define KMESH_BENCH_US_PER_S  1000000ULL
+#define KMESH_BENCH_PAYLOAD   (KMESH_FRAME_MAX_LENGTH - KMESH_FRAME_HEADER_LENGTH)
+
+typedef enum kmesh_bench_phase {
+  KMESH_BENCH_IDLE,
+  KMESH_BENCH_SENDING,
+  KMESH_BENCH_REPORTING,
+} kmesh_bench_phase_t;
+
+// What the frame in the TX FIFO is, if it is ours.
+typedef enum kmesh_bench_tx {
+  KMESH_BENCH_TX_NONE,
+  KMESH_BENCH_TX_FRAME,
+  KMESH_BENCH_TX_ANSWER,
+  KMESH_BENCH_TX_REPORT_REQUEST,
+} kmesh_bench_tx_t;
+
+typedef struct kmesh_bench_slot {
+  bool used;
+  // Sent and waiting for the echo; otherwise due for (re)transmission.
+  bool waiting;
+  uint8_t attempts;
+  uint16_t sequence;
+  RAIL_Time_t sent_at;
+  RAIL_Time_t deadline;
+} kmesh_bench_slot_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void run_sending(RAIL_Time_t now);
+static void run_reporting(RAIL_Time_t now);
+static RAIL_Status_t send_frame(uint16_t to, uint8_t kind, uint8_t run_id,
+                                uint16_t sequence, uint16_t length);
+static void on_echo(RAIL_Handle_t rail_handle, RAIL_RxPacketHandle_t packet,
+                    const kmesh_frame_header_t *header, uint8_t run_id, uint16_t sequence);
+static void count_peer(uint16_t source, uint8_t run_id, uint32_t bytes, bool frame);
+static void add_rtt(uint32_t rtt_us);
+static void finish(void);
+static void print_result(void);
+static uint32_t percentile_us(uint16_t permille);
+static void put_u32(uint8_t *data, uint16_t offset, uint32_t value);
+static uint32_t get_u32(const uint8_t *data, uint16_t offset);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static uint8_t filler[KMESH_BENCH_PAYLOAD];
+static uint8_t tx_frame[KMESH_FRAME_MAX_LENGTH];
+static uint8_t answer_frame[KMESH_FRAME_MAX_LENGTH];
+
+static volatile kmesh_bench_phase_t phase;
+static volatile bool done;
+static kmesh_bench_tx_t tx_kind;
+static uint8_t tx_slot;
+static uint16_t destination;
+static uint16_t frame_length;
+static uint32_t frame_count;
+static uint32_t issued;
+static bool echo;
+static uint8_t window;
+static uint8_t run;
+static uint32_t timeout_us;
+static RAIL_Time_t run_start;
+static uint8_t report_attempts;
+static RAIL_Time_t report_deadline;
+static kmesh_bench_slot_t slots[KMESH_BENCH_WINDOW];
+static kmesh_bench_result_t result;
+static uint32_t rtt_samples[KMESH_BENCH_RTT_SAMPLES];
+
+// What this node received in the latest run of a peer.
+static bool peer_valid;
+static uint16_t peer_source;
+static uint8_t peer_run;
+static uint32_t peer_frames;
+static uint32_t peer_bytes;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_bench_init(void)
+{
+  for (uint16_t i = 0U; i < sizeof(filler); i++) {
+    filler[i] = (uint8_t)i;
+  }
+  run = (uint8_t)kmesh_random();
+}
+
+void kmesh_bench_process_action(void)
+{
+  RAIL_Time_t now = RAIL_GetTime();
+  CORE_DECLARE_IRQ_STATE;
+
+  if (done) {
+    done = false;
+    print_result();
+    return;
+  }
+  if (phase == KMESH_BENCH_IDLE) {
+    return;
+  }
+  // Transmissions are started with interrupts off so the echo of a peer
+  // cannot be loaded into the TX FIFO at the same time.
+  CORE_ENTER_ATOMIC();
+  if (phase == KMESH_BENCH_SENDING) {
+    run_sending(now);
+  } else {
+    run_reporting(now);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+// The TX completion interrupt wakes the main loop for the next frame.
+uint32_t kmesh_bench_idle_us(RAIL_Time_t now)
+{
+  uint32_t idle_us = KMESH_IDLE_FOREVER;
+  uint8_t in_flight = 0U;
+  int32_t left;
+
+  if (phase == KMESH_BENCH_IDLE || tx_kind != KMESH_BENCH_TX_NONE) {
+    return idle_us;
+  }
+  if (phase == KMESH_BENCH_REPORTING) {
+    left = (int32_t)(report_deadline - now);
+    return (left > 0) ? (uint32_t)left : 0U;
+  }
+  for (uint8_t i = 0U; i < window; i++) {
+    if (!slots[i].used) {
+      continue;
+    }
+    if (!slots[i].waiting) {
+      return 0U;
+    }
+    in_flight++;
+    left = (int32_t)(slots[i].deadline - now);
+    if (left <= 0) {
+      return 0U;
+    }
+    if ((uint32_t)left < idle_us) {
+      idle_us = (uint32_t)left;
+    }
+  }
+  // Room for a new frame, or the last echo is in and the run is over.
+  if ((issued < frame_count && in_flight < window) || in_flight == 0U) {
+    return 0U;
+  }
+  return idle_us;
+}
+
+RAIL_Status_t kmesh_bench_start(uint16_t peer, uint16_t length, uint32_t count,
+                                bool with_echo, uint8_t frames_in_flight)
+{
+  RAIL_StateTiming_t timings = { 0 };
+  uint32_t round_trip_us;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (peer == KMESH_ADDRESS_BROADCAST || peer == kmesh_get_address() || count == 0U
+      || length < KMESH_FRAME_HEADER_LENGTH + KMESH_BENCH_HEADER_LENGTH
+      || length > KMESH_FRAME_MAX_LENGTH
+      || frames_in_flight == 0U || frames_in_flight > KMESH_BENCH_WINDOW) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  if (phase != KMESH_BENCH_IDLE) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  // Our request and the echo on air, both turnarounds, and the echoes of
+  // the other frames in flight that may go first.
+  (void) RAIL_GetStateTiming(kmesh_get_rail_handle(), &timings);
+  round_trip_us = 2U * kmesh_airtime_us(length) + timings.txToRx + timings.rxToTx;
+
+  CORE_ENTER_ATOMIC();
+  memset(slots, 0, sizeof(slots));
+  memset(&result, 0, sizeof(result));
+  result.rtt_min_us = UINT32_MAX;
+  destination = peer;
+  frame_length = length;
+  frame_count = count;
+  issued = 0U;
+  echo = with_echo;
+  window = with_echo ? frames_in_flight : 1U;
+  timeout_us = round_trip_us * window + KMESH_BENCH_TIMEOUT_MARGIN_US;
+  run++;
+  report_attempts = 0U;
+  done = false;
+  run_start = RAIL_GetTime();
+  phase = KMESH_BENCH_SENDING;
+  CORE_EXIT_ATOMIC();
+  return RAIL_STATUS_NO_ERROR;
+}
+
+// A frame already on its way is not waited for.
+void kmesh_bench_stop(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (phase != KMESH_BENCH_IDLE) {
+    finish();
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_bench_is_running(void)
+{
+  return phase != KMESH_BENCH_IDLE;
+}
+
+void kmesh_bench_on_rx(RAIL_Handle_t rail_handle,
+                       RAIL_RxPacketHandle_t packet,
+                       const RAIL_RxPacketInfo_t *info,
+                       const kmesh_frame_header_t *header)
+{
+  uint8_t payload[KMESH_BENCH_REPORT_LENGTH];
+  uint16_t payload_length = header->length - KMESH_FRAME_HEADER_LENGTH;
+  uint8_t kind;
+  uint8_t run_id;
+  uint16_t sequence;
+
+  (void) info;
+  if (payload_length < KMESH_BENCH_HEADER_LENGTH) {
+    return;
+  }
+  (void) RAIL_PeekRxPacket(rail_handle, packet, payload,
+                           (payload_length < sizeof(payload)) ? payload_length : sizeof(payload),
+                           KMESH_FRAME_HEADER_LENGTH);
+  kind = payload[KMESH_BENCH_OFFSET_KIND];
+  run_id = payload[KMESH_BENCH_OFFSET_RUN];
+  sequence = kmesh_frame_get_u16(payload, KMESH_BENCH_OFFSET_SEQUENCE);
+
+  switch (kind) {
+    case KMESH_BENCH_KIND_DATA:
+    case KMESH_BENCH_KIND_REQUEST:
+      count_peer(header->source, run_id, payload_length - KMESH_BENCH_HEADER_LENGTH, true);
+      // A peer busy transmitting skips the echo; the request times out.
+      if (kind == KMESH_BENCH_KIND_REQUEST && tx_kind == KMESH_BENCH_TX_NONE) {
+        (void) send_frame(header->source, KMESH_BENCH_KIND_ECHO, run_id, sequence,
+                          header->length);
+      }
+      break;
+    case KMESH_BENCH_KIND_REPORT_REQUEST:
+      count_peer(header->source, run_id, 0U, false);
+      if (tx_kind == KMESH_BENCH_TX_NONE) {
+        (void) send_frame(header->source, KMESH_BENCH_KIND_REPORT, run_id, sequence,
+                          KMESH_FRAME_HEADER_LENGTH + KMESH_BENCH_REPORT_LENGTH);
+      }
+      break;
+    case KMESH_BENCH_KIND_ECHO:
+      on_echo(rail_handle, packet, header, run_id, sequence);
+      break;
+    case KMESH_BENCH_KIND_REPORT:
+      if (phase == KMESH_BENCH_REPORTING && header->source == destination && run_id == run
+          && payload_length >= KMESH_BENCH_REPORT_LENGTH) {
+        result.delivered = get_u32(payload, KMESH_BENCH_OFFSET_FRAMES);
+        result.bytes = get_u32(payload, KMESH_BENCH_OFFSET_BYTES);
+        result.reported = true;
+        finish();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void kmesh_bench_on_tx_events(RAIL_Handle_t rail_handle, RAIL_Events_t events)
+{
+  kmesh_bench_tx_t kind = tx_kind;
+  kmesh_bench_slot_t *slot;
+  RAIL_Time_t now = RAIL_GetTime();
+  bool sent = (events & RAIL_EVENT_TX_PACKET_SENT) != 0U;
+
+  tx_kind = KMESH_BENCH_TX_NONE;
+  if (kind != KMESH_BENCH_TX_FRAME || phase != KMESH_BENCH_SENDING) {
+    return;
+  }
+  if (!echo) {
+    if (!sent) {
+      result.failed++;
+    }
+    result.elapsed_us = now - run_start;
+    return;
+  }
+  slot = &slots[tx_slot];
+  // The echo may already have come in for an earlier copy.
+  if (!slot->used) {
+    return;
+  }
+  if (sent) {
+    if (RAIL_GetTxPacketDetailsAlt(rail_handle, false, &slot->sent_at)
+        != RAIL_STATUS_NO_ERROR) {
+      slot->sent_at = now;
+    }
+    slot->deadline = now + timeout_us;
+    slot->waiting = true;
+  } else if (slot->attempts > KMESH_BENCH_MAX_RETRIES) {
+    result.failed++;
+    slot->used = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Expire frames whose echo is overdue, then send one frame: a
+// retransmission first, otherwise the next new one the window allows.
+static void run_sending(RAIL_Time_t now)
+{
+  kmesh_bench_slot_t *slot = NULL;
+  bool busy = false;
+  uint8_t kind = echo ? KMESH_BENCH_KIND_REQUEST : KMESH_BENCH_KIND_DATA;
+
+  for (uint8_t i = 0U; i < window; i++) {
+    if (slots[i].used && slots[i].waiting && (int32_t)(now - slots[i].deadline) >= 0) {
+      slots[i].waiting = false;
+      if (slots[i].attempts > KMESH_BENCH_MAX_RETRIES) {
+        result.failed++;
+        slots[i].used = false;
+      }
+    }
+    busy = busy || slots[i].used;
+  }
+  if (tx_kind != KMESH_BENCH_TX_NONE) {
+    return;
+  }
+  for (uint8_t i = 0U; i < window && slot == NULL; i++) {
+    if (slots[i].used && !slots[i].waiting) {
+      slot = &slots[i];
+    }
+  }
+  if (slot == NULL && issued < frame_count) {
+    for (uint8_t i = 0U; i < window && slot == NULL; i++) {
+      if (!slots[i].used) {
+        slot = &slots[i];
+        slot->used = true;
+        slot->waiting = false;
+        slot->attempts = 0U;
+        slot->sequence = (uint16_t)issued++;
+        result.frames++;
+      }
+    }
+  }
+  if (slot == NULL) {
+    if (!busy && issued == frame_count) {
+      if (echo) {
+        finish();
+      } else {
+        report_deadline = now;
+        phase = KMESH_BENCH_REPORTING;
+      }
+    }
+    return;
+  }
+
+  if (slot->attempts != 0U) {
+    result.retries++;
+  }
+  slot->attempts++;
+  tx_slot = (uint8_t)(slot - slots);
+  if (send_frame(destination, kind, run, slot->sequence, frame_length)
+      != RAIL_STATUS_NO_ERROR) {
+    // Counts as a lost attempt; a frame without echo is not retried.
+    if (!echo || slot->attempts > KMESH_BENCH_MAX_RETRIES) {
+      result.failed++;
+      slot->used = false;
+    }
+    return;
+  }
+  tx_kind = KMESH_BENCH_TX_FRAME;
+  // Without echo, the slot only carries the frame until it is on its way.
+  if (!echo) {
+    slot->used = false;
+  }
+}
+
+static void run_reporting(RAIL_Time_t now)
+{
+  if (tx_kind != KMESH_BENCH_TX_NONE || (int32_t)(now - report_deadline) < 0) {
+    return;
+  }
+  if (report_attempts > KMESH_BENCH_MAX_RETRIES) {
+    finish();
+    return;
+  }
+  report_attempts++;
+  report_deadline = now + timeout_us;
+  if (send_frame(destination, KMESH_BENCH_KIND_REPORT_REQUEST, run, 0U,
+                 KMESH_FRAME_HEADER_LENGTH + KMESH_BENCH_HEADER_LENGTH)
+      == RAIL_STATUS_NO_ERROR) {
+    tx_kind = KMESH_BENCH_TX_REPORT_REQUEST;
+  }
+}
+
+// Send a frame of length bytes, filler after the benchmark header. Echoes
+// and reports use their own buffer since they go out from the RX interrupt.
+static RAIL_Status_t send_frame(uint16_t to, uint8_t kind, uint8_t run_id,
+                                uint16_t sequence, uint16_t length)
+{
+  bool answer = (kind == KMESH_BENCH_KIND_ECHO || kind == KMESH_BENCH_KIND_REPORT);
+  uint8_t *frame = answer ? answer_frame : tx_frame;
+  uint8_t *payload = &frame[KMESH_FRAME_HEADER_LENGTH];
+  uint16_t next_hop = KMESH_ADDRESS_BROADCAST;
+  RAIL_Status_t status;
+
+  (void) kmesh_route_lookup(to, &next_hop);
+  length = kmesh_build_frame(frame, KMESH_FRAME_TYPE_BENCH, to, next_hop, filler,
+                             length - KMESH_FRAME_HEADER_LENGTH);
+  if (length == 0U) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  payload[KMESH_BENCH_OFFSET_KIND] = kind;
+  payload[KMESH_BENCH_OFFSET_RUN] = run_id;
+  kmesh_frame_put_u16(payload, KMESH_BENCH_OFFSET_SEQUENCE, sequence);
+  if (kind == KMESH_BENCH_KIND_REPORT) {
+    put_u32(payload, KMESH_BENCH_OFFSET_FRAMES, peer_frames);
+    put_u32(payload, KMESH_BENCH_OFFSET_BYTES, peer_bytes);
+  }
+  status = kmesh_transmit(frame, length);
+  if (answer && status == RAIL_STATUS_NO_ERROR) {
+    tx_kind = KMESH_BENCH_TX_ANSWER;
+  }
+  return status;
+}
+
+static void on_echo(RAIL_Handle_t rail_handle, RAIL_RxPacketHandle_t packet,
+                    const kmesh_frame_header_t *header, uint8_t run_id, uint16_t sequence)
+{
+  RAIL_RxPacketDetails_t details;
+  RAIL_Time_t received = RAIL_GetTime();
+  kmesh_bench_slot_t *slot = NULL;
+
+  if (phase != KMESH_BENCH_SENDING || !echo || header->source != destination
+      || run_id != run) {
+    return;
+  }
+  for (uint8_t i = 0U; i < window && slot == NULL; i++) {
+    if (slots[i].used && slots[i].sequence == sequence) {
+      slot = &slots[i];
+    }
+  }
+  // Echoes of copies already answered are ignored.
+  if (slot == NULL) {
+    return;
+  }
+  if (RAIL_GetRxPacketDetailsAlt(rail_handle, packet, &details) == RAIL_STATUS_NO_ERROR) {
+    received = details.timeReceived.packetTime;
+  }
+  if (slot->attempts == 1U && slot->waiting) {
+    add_rtt(received - slot->sent_at);
+  }
+  slot->used = false;
+  result.delivered++;
+  result.bytes += 2U * (uint32_t)(header->length - KMESH_FRAME_HEADER_LENGTH
+                                  - KMESH_BENCH_HEADER_LENGTH);
+  result.elapsed_us = RAIL_GetTime() - run_start;
+}
+
+// Counts restart with every new run of a peer.
+static void count_peer(uint16_t source, uint8_t run_id, uint32_t bytes, bool frame)
+{
+  if (!peer_valid || source != peer_source || run_id != peer_run) {
+    peer_valid = true;
+    peer_source = source;
+    peer_run = run_id;
+    peer_frames = 0U;
+    peer_bytes = 0U;
+  }
+  if (frame) {
+    peer_frames++;
+    peer_bytes += bytes;
+  }
+}
+
+// Reservoir sampling, so a run longer than the reservoir still gives
+// every round trip the same chance to be kept.
+static void add_rtt(uint32_t rtt_us)
+{
+  uint32_t index = result.rtt_count;
+
+  result.rtt_count++;
+  result.rtt_sum_us += rtt_us;
+  if (rtt_us < result.rtt_min_us) {
+    result.rtt_min_us = rtt_us;
+  }
+  if (rtt_us > result.rtt_max_us) {
+    result.rtt_max_us = rtt_us;
+  }
+  if (index >= KMESH_BENCH_RTT_SAMPLES) {
+    index = kmesh_random() % result.rtt_count;
+  }
+  if (index < KMESH_BENCH_RTT_SAMPLES) {
+    rtt_samples[index] = rtt_us;
+  }
+}
+
+static void finish(void)
+{
+  phase = KMESH_BENCH_IDLE;
+  done = true;
+}
+
+// Main loop, once the run is over and the interrupt side leaves the
+// samples alone.
+static void print_result(void)
+{
+  uint32_t kept = (result.rtt_count < KMESH_BENCH_RTT_SAMPLES)
+                  ? result.rtt_count : KMESH_BENCH_RTT_SAMPLES;
+  uint32_t bit_rate = RAIL_GetBitRate(kmesh_get_rail_handle());
+  uint32_t goodput_bps = 0U;
+  uint32_t value;
+  uint32_t j;
+
+  for (uint32_t i = 1U; i < kept; i++) {
+    value = rtt_samples[i];
+    for (j = i; j > 0U && rtt_samples[j - 1U] > value; j--) {
+      rtt_samples[j] = rtt_samples[j - 1U];
+    }
+    rtt_samples[j] = value;
+  }
+  if (result.elapsed_us != 0U) {
+    goodput_bps = (uint32_t)((uint64_t)result.bytes * 8U * KMESH_BENCH_US_PER_S
+                             / result.elapsed_us);
+  }
+  responsePrint("meshThroughput",
+                "Status:%s,Frames:%lu,Retries:%lu,Delivered:%lu,Failed:%lu,Bytes:%lu,"
+                "ElapsedUs:%lu,GoodputBps:%lu,EfficiencyPermille:%lu,RttSamples:%lu,"
+                "RttMinUs:%lu,RttMeanUs:%lu,RttP50Us:%lu,RttP95Us:%lu,RttP99Us:%lu,"
+                "RttMaxUs:%lu",
+                (echo || result.reported) ? "Done" : "NoReport",
+                result.frames, result.retries, result.delivered, result.failed,
+                result.bytes, result.elapsed_us, goodput_bps,
+                (bit_rate != 0U)
+                ? (uint32_t)((uint64_t)goodput_bps * KMESH_BENCH_PERMILLE / bit_rate) : 0U,
+                result.rtt_count,
+                (result.rtt_count != 0U) ? result.rtt_min_us : 0U,
+                (result.rtt_count != 0U)
+                ? (uint32_t)(result.rtt_sum_us / result.rtt_count) : 0U,
+                percentile_us(500U), percentile_us(950U), percentile_us(990U),
+                result.rtt_max_us);
+}
+
+// Nearest rank over the sorted reservoir; 0 without any round trip.
+static uint32_t percentile_us(uint16_t permille)
+{
+  uint32_t kept = (result.rtt_count < KMESH_BENCH_RTT_SAMPLES)
+                  ? result.rtt_count : KMESH_BENCH_RTT_SAMPLES;
+  uint32_t rank;
+
+  if (kept == 0U) {
+    return 0U;
+  }
+  rank = (kept * permille + KMESH_BENCH_PERMILLE - 1U) / KMESH_BENCH_PERMILLE;
+  return rtt_samples[(rank != 0U) ? rank - 1U : 0U];
+}
+
+static void put_u32(uint8_t *data, uint16_t offset, uint32_t value)
+{
+  kmesh_frame_put_u16(data, offset, (uint16_t)(value >> 16));
+  kmesh_frame_put_u16(data, offset + 2U, (uint16_t)value);
+}
+
+static uint32_t get_u32(const uint8_t *data, uint16_t offset)
+{
+  return ((uint32_t)kmesh_frame_get_u16(data, offset) << 16)
+         | kmesh_frame_get_u16(data, offset + 2U);
+}
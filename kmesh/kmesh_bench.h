@@ -0,0 +1,57 @@
+/***************************************************************************//**
+ * @file kmesh_bench.h
+ * @brief Goodput and round-trip latency benchmark between two kmesh nodes.
+ ******************************************************************************/
+
+#ifndef KMESH_BENCH_H
+#define KMESH_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+#include "kmesh_frame.h"
+
+typedef struct kmesh_bench_result {
+  // Frames sent for the first time, their retransmissions, the frames
+  // delivered and those given up on after KMESH_BENCH_MAX_RETRIES.
+  uint32_t frames;
+  uint32_t retries;
+  uint32_t delivered;
+  uint32_t failed;
+  // Payload bytes delivered, both directions counted with echoes.
+  uint32_t bytes;
+  // First frame to last echo, or to the last frame without echoes.
+  uint32_t elapsed_us;
+  // Round trips of frames delivered on their first attempt.
+  uint32_t rtt_count;
+  uint32_t rtt_min_us;
+  uint32_t rtt_max_us;
+  uint64_t rtt_sum_us;
+  // Whether the peer answered the report request of a run without echoes.
+  bool reported;
+} kmesh_bench_result_t;
+
+// Called from kmesh_init() / kmesh_process_action().
+void kmesh_bench_init(void);
+void kmesh_bench_process_action(void);
+uint32_t kmesh_bench_idle_us(RAIL_Time_t now);
+
+// Send count frames of length bytes, kmesh header included, to destination.
+// With echo, the peer sends each frame back and up to window of them are in
+// flight; frames not echoed in time are retransmitted. Without, frames go
+// out back to back and the peer reports what arrived at the end. Prints
+// meshThroughput when done.
+RAIL_Status_t kmesh_bench_start(uint16_t destination, uint16_t length, uint32_t count,
+                                bool echo, uint8_t window);
+void kmesh_bench_stop(void);
+bool kmesh_bench_is_running(void);
+
+// Echoes and counts benchmark frames for this node, and collects the echoes
+// and reports of a run. Interrupt context.
+void kmesh_bench_on_rx(RAIL_Handle_t rail_handle,
+                       RAIL_RxPacketHandle_t packet,
+                       const RAIL_RxPacketInfo_t *info,
+                       const kmesh_frame_header_t *header);
+void kmesh_bench_on_tx_events(RAIL_Handle_t rail_handle, RAIL_Events_t events);
+
+#endif // KMESH_BENCH_H
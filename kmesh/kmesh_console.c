@@ -0,0 +1,283 @@
+/***************************************************************************//**
+ * @file kmesh_console.c
+ * @brief Non-blocking console output through a DMA-fed TX ring.
+ *
+ * The VCOM iostream writes a character at a time, polling the EUSART, so a
+ * burst of responses holds up the main loop, radio processing included, for
+ * as long as the UART takes to shift them out (about 87 us per byte at
+ * 115200 baud). This stream instead copies each write into a RAM ring and
+ * returns; LDMA moves the ring into EUSART TXDATA in contiguous chunks. A
+ * write that does not fit is dropped whole and counted, never waited for.
+ *
+ * The DMA is done once the last byte is in the EUSART FIFO, a few byte times
+ * before it is on the wire. The EM1 requirement that keeps the EUSART clocked
+ * is only dropped by the main loop once EUSART_STATUS_TXC shows it is idle;
+ * the EUSART TX interrupt belongs to the VCOM iostream driver.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "em_device.h"
+#include "em_eusart.h"
+#include "sl_core.h"
+#include "dmadrv.h"
+#include "sl_power_manager.h"
+#include "sl_iostream_handles.h"
+#include "sl_iostream_eusart_vcom_config.h"
+#include "kmesh.h"
+#include "kmesh_console.h"
+#include "kmesh_console_wake.h"
+#include "kmesh_idle.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+// DMADRV limits a single transfer to the LDMA XFERCNT range.
+#define KMESH_CONSOLE_MAX_CHUNK  DMADRV_MAX_XFER_COUNT
+
+#if SL_IOSTREAM_EUSART_VCOM_PERIPHERAL_NO != 0
+#error "kmesh_console requests EUSART0 TX DMA; update the peripheral signal"
+#endif
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static sl_status_t stream_write(void *context, const void *buffer, size_t length);
+static sl_status_t stream_read(void *context, void *buffer, size_t length,
+                               size_t *bytes_read);
+static void stream_set_auto_cr_lf(void *context, bool on);
+static bool stream_get_auto_cr_lf(void *context);
+static bool enqueue(const uint8_t *data, size_t length, bool convert_lf);
+static void start_transfer(void);
+static bool on_transfer_done(unsigned int channel, unsigned int sequence, void *user);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_console_counters_t kmesh_console_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static uint8_t tx_ring[KMESH_CONSOLE_TX_BUFFER_SIZE];
+// head is written by the main loop, tail and in_flight by the DMA callback;
+// both sides update under CORE_ATOMIC.
+static volatile uint16_t head;
+static volatile uint16_t tail;
+static volatile uint16_t used;
+static volatile uint16_t in_flight;
+static unsigned int dma_channel;
+static bool dma_ready;
+static bool em1_requested;
+// Ring empty but the EUSART may still be shifting out, with EM1 held.
+static volatile bool draining;
+static bool auto_cr_lf = SL_IOSTREAM_EUSART_VCOM_CONVERT_BY_DEFAULT_LF_TO_CRLF;
+
+static sl_iostream_t console_stream = {
+  .context = NULL,
+  .write = stream_write,
+  .read = stream_read,
+  .set_auto_cr_lf = stream_set_auto_cr_lf,
+  .get_auto_cr_lf = stream_get_auto_cr_lf,
+};
+
+sl_iostream_t *const kmesh_console_handle = &console_stream;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_console_init(void)
+{
+  Ecode_t ecode = DMADRV_Init();
+  CORE_DECLARE_IRQ_STATE;
+
+  if (ecode != ECODE_EMDRV_DMADRV_OK
+      && ecode != ECODE_EMDRV_DMADRV_ALREADY_INITIALIZED) {
+    return;
+  }
+  if (DMADRV_AllocateChannel(&dma_channel, NULL) != ECODE_EMDRV_DMADRV_OK) {
+    return;
+  }
+  // Raw writes made before now were only queued.
+  CORE_ENTER_ATOMIC();
+  dma_ready = true;
+  start_transfer();
+  CORE_EXIT_ATOMIC();
+  sl_iostream_set_default(kmesh_console_handle);
+}
+
+bool kmesh_console_write(const void *data, size_t length)
+{
+  return enqueue(data, length, false);
+}
+
+size_t kmesh_console_get_free(void)
+{
+  return KMESH_CONSOLE_TX_BUFFER_SIZE - used;
+}
+
+void kmesh_console_process_action(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!draining) {
+    return;
+  }
+  CORE_ENTER_ATOMIC();
+  if (draining
+      && (SL_IOSTREAM_EUSART_VCOM_PERIPHERAL->STATUS & EUSART_STATUS_TXC) != 0U) {
+    draining = false;
+    em1_requested = false;
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+uint32_t kmesh_console_idle_us(RAIL_Time_t now)
+{
+  (void) now;
+  // Only the EUSART FIFO is left, so poll instead of sleeping on it.
+  return draining ? 0U : KMESH_IDLE_FOREVER;
+}
+
+void kmesh_console_flush(void)
+{
+  while (used != 0U) {
+  }
+  while ((SL_IOSTREAM_EUSART_VCOM_PERIPHERAL->STATUS & EUSART_STATUS_TXC) == 0U) {
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static sl_status_t stream_write(void *context, const void *buffer, size_t length)
+{
+  (void) context;
+  if (!dma_ready) {
+    return sl_iostream_write(sl_iostream_vcom_handle, buffer, length);
+  }
+  return enqueue(buffer, length, auto_cr_lf) ? SL_STATUS_OK : SL_STATUS_FULL;
+}
+
+static sl_status_t stream_read(void *context, void *buffer, size_t length,
+                               size_t *bytes_read)
+{
+  sl_status_t status;
+
+  (void) context;
+  status = sl_iostream_read(sl_iostream_vcom_handle, buffer, length, bytes_read);
+  if (status == SL_STATUS_OK) {
+    *bytes_read = kmesh_console_wake_filter(buffer, *bytes_read);
+    if (*bytes_read == 0U) {
+      status = SL_STATUS_EMPTY;
+    }
+  }
+  return status;
+}
+
+static void stream_set_auto_cr_lf(void *context, bool on)
+{
+  (void) context;
+  auto_cr_lf = on;
+}
+
+static bool stream_get_auto_cr_lf(void *context)
+{
+  (void) context;
+  return auto_cr_lf;
+}
+
+static bool enqueue(const uint8_t *data, size_t length, bool convert_lf)
+{
+  CORE_DECLARE_IRQ_STATE;
+  size_t needed = length;
+  uint16_t at;
+
+  if (convert_lf) {
+    for (size_t i = 0U; i < length; i++) {
+      needed += (data[i] == '\n') ? 1U : 0U;
+    }
+  }
+
+  // Reserve the space first so the copy runs with interrupts enabled. Writes
+  // come from the main loop only, so nobody else moves head meanwhile.
+  CORE_ENTER_ATOMIC();
+  if (needed > (size_t)(KMESH_CONSOLE_TX_BUFFER_SIZE - used)) {
+    kmesh_console_counters.writes_dropped++;
+    kmesh_console_counters.bytes_dropped += needed;
+    CORE_EXIT_ATOMIC();
+    return false;
+  }
+  at = head;
+  CORE_EXIT_ATOMIC();
+
+  for (size_t i = 0U; i < length; i++) {
+    if (convert_lf && data[i] == '\n') {
+      tx_ring[at] = '\r';
+      at = (at + 1U) % KMESH_CONSOLE_TX_BUFFER_SIZE;
+    }
+    tx_ring[at] = data[i];
+    at = (at + 1U) % KMESH_CONSOLE_TX_BUFFER_SIZE;
+  }
+
+  CORE_ENTER_ATOMIC();
+  head = at;
+  used += (uint16_t)needed;
+  if (used > kmesh_console_counters.high_water) {
+    kmesh_console_counters.high_water = used;
+  }
+  kmesh_console_counters.bytes_queued += needed;
+  if (dma_ready && in_flight == 0U) {
+    start_transfer();
+  }
+  CORE_EXIT_ATOMIC();
+  return true;
+}
+
+// Called with interrupts disabled, or from the DMA interrupt.
+static void start_transfer(void)
+{
+  uint16_t chunk = used;
+
+  if (chunk == 0U) {
+    draining = em1_requested;
+    return;
+  }
+  draining = false;
+  if (!em1_requested) {
+    // The EUSART runs from the HF clock, so stay out of EM2 while sending.
+    sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+    em1_requested = true;
+  }
+  if (chunk > KMESH_CONSOLE_TX_BUFFER_SIZE - tail) {
+    chunk = KMESH_CONSOLE_TX_BUFFER_SIZE - tail;
+  }
+  if (chunk > KMESH_CONSOLE_MAX_CHUNK) {
+    chunk = KMESH_CONSOLE_MAX_CHUNK;
+  }
+  in_flight = chunk;
+  (void) DMADRV_MemoryPeripheral(dma_channel,
+                                 dmadrvPeripheralSignal_EUSART0_TXBL,
+                                 (void *)&SL_IOSTREAM_EUSART_VCOM_PERIPHERAL->TXDATA,
+                                 &tx_ring[tail],
+                                 true,
+                                 chunk,
+                                 dmadrvDataSize1,
+                                 on_transfer_done,
+                                 NULL);
+}
+
+static bool on_transfer_done(unsigned int channel, unsigned int sequence, void *user)
+{
+  (void) channel;
+  (void) sequence;
+  (void) user;
+  tail = (tail + in_flight) % KMESH_CONSOLE_TX_BUFFER_SIZE;
+  used -= in_flight;
+  kmesh_console_counters.bytes_sent += in_flight;
+  in_flight = 0U;
+  start_transfer();
+  return true;
+}
@@ -0,0 +1,51 @@
+/***************************************************************************//**
+ * @file kmesh_console.h
+ * @brief Non-blocking console output through a DMA-fed TX ring.
+ ******************************************************************************/
+
+#ifndef KMESH_CONSOLE_H
+#define KMESH_CONSOLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sl_iostream.h"
+#include "rail.h"
+
+typedef struct kmesh_console_counters {
+  uint32_t bytes_queued;
+  uint32_t bytes_sent;
+  uint32_t writes_dropped;
+  uint32_t bytes_dropped;
+  uint16_t high_water;
+} kmesh_console_counters_t;
+
+// iostream the CLI instance and stdout write through. Reads are passed on to
+// sl_iostream_vcom_handle. Usable before kmesh_console_init(), writing
+// synchronously until then.
+extern sl_iostream_t *const kmesh_console_handle;
+
+extern kmesh_console_counters_t kmesh_console_counters;
+
+// Takes a DMA channel for the VCOM EUSART and makes the console the default
+// stream. Called from kmesh_init().
+void kmesh_console_init(void);
+
+// Drops the EM1 requirement once the EUSART has sent the last queued byte.
+// Called from kmesh_process_action().
+void kmesh_console_process_action(void);
+uint32_t kmesh_console_idle_us(RAIL_Time_t now);
+
+// Queue length bytes exactly as given, without LF to CRLF conversion. All or
+// nothing: returns false, counting a drop, if the ring cannot take them all.
+// Before kmesh_console_init() the bytes wait in the ring until it starts the
+// DMA.
+bool kmesh_console_write(const void *data, size_t length);
+
+// Bytes that can currently be queued without a drop.
+size_t kmesh_console_get_free(void);
+
+// Spin until everything queued has left the UART, e.g. before a reset.
+void kmesh_console_flush(void);
+
+#endif // KMESH_CONSOLE_H
@@ -0,0 +1,201 @@
+/***************************************************************************//**
+ * @file kmesh_console_wake.c
+ * @brief Console that lets the node sleep and wakes on incoming characters.
+ *
+ * The VCOM EUSART runs from the HFXO and receives nothing in EM2, and the
+ * iostream is not configured to hold EM1 for reception. By default this
+ * module holds EM1 itself so the console never loses input. In sleep mode
+ * it releases EM1 once the console has been idle for idle_ms, and arms a
+ * falling-edge interrupt on the RX pin (port A, so it works in EM2). The
+ * start bit of the next character wakes the node and EM1 is held again.
+ *
+ * The characters that arrive while the HFXO starts are lost or garbled, so
+ * the rest of that line is dropped, up to its end of line or for at most
+ * KMESH_CONSOLE_WAKE_SETTLE_MS when the end of line itself was lost. A
+ * consoleAwake line then announces that the console is listening. A host
+ * sends an empty line to wake the node and waits for consoleAwake.
+ * Lines sent after it are held by the UART driver's receive buffer and run
+ * once the main loop is back.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "em_gpio.h"
+#include "gpiointerrupt.h"
+#include "sl_core.h"
+#include "sl_power_manager.h"
+#include "sl_sleeptimer.h"
+#include "sl_iostream_eusart_vcom_config.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_console_wake.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+// Longest a wake line is dropped for when its end of line never arrives.
+#define KMESH_CONSOLE_WAKE_SETTLE_MS 20U
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void go_to_sleep(void);
+static void on_rx_edge(uint8_t interrupt, void *context);
+static void on_idle_timeout(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_console_wake_counters_t kmesh_console_wake_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static bool enabled;
+static uint32_t idle_ms = KMESH_CONSOLE_WAKE_IDLE_MS;
+static unsigned int rx_interrupt = INTERRUPT_UNAVAILABLE;
+static sl_sleeptimer_timer_handle_t idle_timer;
+
+// EM1 is held whenever the console is awake.
+static volatile bool awake;
+// Set by the wake edge, cleared when the main loop has seen it.
+static volatile bool woken;
+static uint32_t woken_at;
+static bool dropping_line;
+static bool announce;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_console_wake_init(void)
+{
+  rx_interrupt = GPIOINT_CallbackRegisterExt(SL_IOSTREAM_EUSART_VCOM_RX_PIN,
+                                             on_rx_edge, NULL);
+  awake = true;
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+}
+
+void kmesh_console_wake_process_action(void)
+{
+  if (woken) {
+    woken = false;
+    dropping_line = true;
+  }
+  if (dropping_line
+      && sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - woken_at)
+      >= KMESH_CONSOLE_WAKE_SETTLE_MS) {
+    dropping_line = false;
+    announce = true;
+  }
+  if (announce) {
+    announce = false;
+    responsePrint("consoleAwake", "Wakes:%lu,DroppedBytes:%lu",
+                  kmesh_console_wake_counters.wakes,
+                  kmesh_console_wake_counters.dropped_bytes);
+  }
+}
+
+void kmesh_console_wake_configure(bool enable, uint32_t timeout_ms)
+{
+  if (rx_interrupt == INTERRUPT_UNAVAILABLE) {
+    enable = false;
+  }
+  enabled = enable;
+  idle_ms = timeout_ms;
+  if (enable) {
+    (void) sl_sleeptimer_restart_timer_ms(&idle_timer, idle_ms, on_idle_timeout,
+                                          NULL, 0U, 0U);
+  } else {
+    CORE_DECLARE_IRQ_STATE;
+
+    (void) sl_sleeptimer_stop_timer(&idle_timer);
+    CORE_ENTER_ATOMIC();
+    GPIO_IntDisable(1UL << rx_interrupt);
+    if (!awake) {
+      awake = true;
+      sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+    }
+    CORE_EXIT_ATOMIC();
+  }
+}
+
+bool kmesh_console_wake_is_enabled(void)
+{
+  return enabled;
+}
+
+uint32_t kmesh_console_wake_get_idle_ms(void)
+{
+  return idle_ms;
+}
+
+size_t kmesh_console_wake_filter(uint8_t *data, size_t length)
+{
+  size_t kept = 0U;
+
+  if (length == 0U) {
+    return 0U;
+  }
+  if (enabled) {
+    (void) sl_sleeptimer_restart_timer_ms(&idle_timer, idle_ms, on_idle_timeout,
+                                          NULL, 0U, 0U);
+  }
+  kmesh_console_wake_process_action();
+  for (size_t i = 0U; i < length; i++) {
+    if (!dropping_line) {
+      data[kept++] = data[i];
+      continue;
+    }
+    kmesh_console_wake_counters.dropped_bytes++;
+    if (data[i] == '\r' || data[i] == '\n') {
+      dropping_line = false;
+      announce = true;
+    }
+  }
+  return kept;
+}
+
+// Power manager hook: return to the main loop after the wake edge rather than
+// going straight back to sleep, so the idle timer starts and input is read.
+sl_power_manager_on_isr_exit_t app_sleep_on_isr_exit(void)
+{
+  return woken ? SL_POWER_MANAGER_WAKEUP : SL_POWER_MANAGER_IGNORE;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Interrupt context.
+static void go_to_sleep(void)
+{
+  if (!enabled || !awake) {
+    return;
+  }
+  GPIO_ExtIntConfig(SL_IOSTREAM_EUSART_VCOM_RX_PORT, SL_IOSTREAM_EUSART_VCOM_RX_PIN,
+                    rx_interrupt, false, true, true);
+  awake = false;
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+}
+
+static void on_rx_edge(uint8_t interrupt, void *context)
+{
+  (void) context;
+  GPIO_IntDisable(1UL << interrupt);
+  if (!awake) {
+    awake = true;
+    woken = true;
+    woken_at = sl_sleeptimer_get_tick_count();
+    sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+    kmesh_console_wake_counters.wakes++;
+    (void) sl_sleeptimer_restart_timer_ms(&idle_timer, idle_ms, on_idle_timeout,
+                                          NULL, 0U, 0U);
+  }
+}
+
+static void on_idle_timeout(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void) handle;
+  (void) data;
+  go_to_sleep();
+}
@@ -0,0 +1,38 @@
+/***************************************************************************//**
+ * @file kmesh_console_wake.h
+ * @brief Console that lets the node sleep and wakes on incoming characters.
+ ******************************************************************************/
+
+#ifndef KMESH_CONSOLE_WAKE_H
+#define KMESH_CONSOLE_WAKE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct kmesh_console_wake_counters {
+  uint32_t wakes;
+  uint32_t dropped_bytes;
+} kmesh_console_wake_counters_t;
+
+extern kmesh_console_wake_counters_t kmesh_console_wake_counters;
+
+// Keeps the console awake until kmesh_console_wake_configure() enables
+// sleeping. Called from kmesh_init().
+void kmesh_console_wake_init(void);
+
+// Prints consoleAwake once a wake line has been consumed. Called from
+// kmesh_process_action().
+void kmesh_console_wake_process_action(void);
+
+// With enable, release EM1 after idle_ms without console input and wake on
+// the next falling edge on VCOM RX. Without, stay in EM1 for the console.
+void kmesh_console_wake_configure(bool enable, uint32_t idle_ms);
+bool kmesh_console_wake_is_enabled(void);
+uint32_t kmesh_console_wake_get_idle_ms(void);
+
+// Filters console input in place, dropping the line that woke the node.
+// Returns the number of bytes left. Called from the console read path.
+size_t kmesh_console_wake_filter(uint8_t *data, size_t length);
+
+#endif // KMESH_CONSOLE_WAKE_H
@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file kmesh_crc.c
+ * @brief Software CRC and whitening matching radio_settings.radioconf.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "kmesh_crc.h"
+#include "kmesh_frame.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_CRC_MSB  0x80000000UL
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+// crc_table[i] is the CRC of the single byte i, i.e. i << 24 shifted through
+// KMESH_CRC_POLY eight times.
+static const uint32_t crc_table[256] = {
+  0x00000000UL, 0x814141ABUL, 0x83C3C2FDUL, 0x02828356UL,
+  0x86C6C451UL, 0x078785FAUL, 0x050506ACUL, 0x84444707UL,
+  0x8CCCC909UL, 0x0D8D88A2UL, 0x0F0F0BF4UL, 0x8E4E4A5FUL,
+  0x0A0A0D58UL, 0x8B4B4CF3UL, 0x89C9CFA5UL, 0x08888E0EUL,
+  0x98D8D3B9UL, 0x19999212UL, 0x1B1B1144UL, 0x9A5A50EFUL,
+  0x1E1E17E8UL, 0x9F5F5643UL, 0x9DDDD515UL, 0x1C9C94BEUL,
+  0x14141AB0UL, 0x95555B1BUL, 0x97D7D84DUL, 0x169699E6UL,
+  0x92D2DEE1UL, 0x13939F4AUL, 0x11111C1CUL, 0x90505DB7UL,
+  0xB0F0E6D9UL, 0x31B1A772UL, 0x33332424UL, 0xB272658FUL,
+  0x36362288UL, 0xB7776323UL, 0xB5F5E075UL, 0x34B4A1DEUL,
+  0x3C3C2FD0UL, 0xBD7D6E7BUL, 0xBFFFED2DUL, 0x3EBEAC86UL,
+  0xBAFAEB81UL, 0x3BBBAA2AUL, 0x3939297CUL, 0xB87868D7UL,
+  0x28283560UL, 0xA96974CBUL, 0xABEBF79DUL, 0x2AAAB636UL,
+  0xAEEEF131UL, 0x2FAFB09AUL, 0x2D2D33CCUL, 0xAC6C7267UL,
+  0xA4E4FC69UL, 0x25A5BDC2UL, 0x27273E94UL, 0xA6667F3FUL,
+  0x22223838UL, 0xA3637993UL, 0xA1E1FAC5UL, 0x20A0BB6EUL,
+  0xE0A08C19UL, 0x61E1CDB2UL, 0x63634EE4UL, 0xE2220F4FUL,
+  0x66664848UL, 0xE72709E3UL, 0xE5A58AB5UL, 0x64E4CB1EUL,
+  0x6C6C4510UL, 0xED2D04BBUL, 0xEFAF87EDUL, 0x6EEEC646UL,
+  0xEAAA8141UL, 0x6BEBC0EAUL, 0x696943BCUL, 0xE8280217UL,
+  0x78785FA0UL, 0xF9391E0BUL, 0xFBBB9D5DUL, 0x7AFADCF6UL,
+  0xFEBE9BF1UL, 0x7FFFDA5AUL, 0x7D7D590CUL, 0xFC3C18A7UL,
+  0xF4B496A9UL, 0x75F5D702UL, 0x77775454UL, 0xF63615FFUL,
+  0x727252F8UL, 0xF3331353UL, 0xF1B19005UL, 0x70F0D1AEUL,
+  0x50506AC0UL, 0xD1112B6BUL, 0xD393A83DUL, 0x52D2E996UL,
+  0xD696AE91UL, 0x57D7EF3AUL, 0x55556C6CUL, 0xD4142DC7UL,
+  0xDC9CA3C9UL, 0x5DDDE262UL, 0x5F5F6134UL, 0xDE1E209FUL,
+  0x5A5A6798UL, 0xDB1B2633UL, 0xD999A565UL, 0x58D8E4CEUL,
+  0xC888B979UL, 0x49C9F8D2UL, 0x4B4B7B84UL, 0xCA0A3A2FUL,
+  0x4E4E7D28UL, 0xCF0F3C83UL, 0xCD8DBFD5UL, 0x4CCCFE7EUL,
+  0x44447070UL, 0xC50531DBUL, 0xC787B28DUL, 0x46C6F326UL,
+  0xC282B421UL, 0x43C3F58AUL, 0x414176DCUL, 0xC0003777UL,
+  0x40005999UL, 0xC1411832UL, 0xC3C39B64UL, 0x4282DACFUL,
+  0xC6C69DC8UL, 0x4787DC63UL, 0x45055F35UL, 0xC4441E9EUL,
+  0xCCCC9090UL, 0x4D8DD13BUL, 0x4F0F526DUL, 0xCE4E13C6UL,
+  0x4A0A54C1UL, 0xCB4B156AUL, 0xC9C9963CUL, 0x4888D797UL,
+  0xD8D88A20UL, 0x5999CB8BUL, 0x5B1B48DDUL, 0xDA5A0976UL,
+  0x5E1E4E71UL, 0xDF5F0FDAUL, 0xDDDD8C8CUL, 0x5C9CCD27UL,
+  0x54144329UL, 0xD5550282UL, 0xD7D781D4UL, 0x5696C07FUL,
+  0xD2D28778UL, 0x5393C6D3UL, 0x51114585UL, 0xD050042EUL,
+  0xF0F0BF40UL, 0x71B1FEEBUL, 0x73337DBDUL, 0xF2723C16UL,
+  0x76367B11UL, 0xF7773ABAUL, 0xF5F5B9ECUL, 0x74B4F847UL,
+  0x7C3C7649UL, 0xFD7D37E2UL, 0xFFFFB4B4UL, 0x7EBEF51FUL,
+  0xFAFAB218UL, 0x7BBBF3B3UL, 0x793970E5UL, 0xF878314EUL,
+  0x68286CF9UL, 0xE9692D52UL, 0xEBEBAE04UL, 0x6AAAEFAFUL,
+  0xEEEEA8A8UL, 0x6FAFE903UL, 0x6D2D6A55UL, 0xEC6C2BFEUL,
+  0xE4E4A5F0UL, 0x65A5E45BUL, 0x6727670DUL, 0xE66626A6UL,
+  0x622261A1UL, 0xE363200AUL, 0xE1E1A35CUL, 0x60A0E2F7UL,
+  0xA0A0D580UL, 0x21E1942BUL, 0x2363177DUL, 0xA22256D6UL,
+  0x266611D1UL, 0xA727507AUL, 0xA5A5D32CUL, 0x24E49287UL,
+  0x2C6C1C89UL, 0xAD2D5D22UL, 0xAFAFDE74UL, 0x2EEE9FDFUL,
+  0xAAAAD8D8UL, 0x2BEB9973UL, 0x29691A25UL, 0xA8285B8EUL,
+  0x38780639UL, 0xB9394792UL, 0xBBBBC4C4UL, 0x3AFA856FUL,
+  0xBEBEC268UL, 0x3FFF83C3UL, 0x3D7D0095UL, 0xBC3C413EUL,
+  0xB4B4CF30UL, 0x35F58E9BUL, 0x37770DCDUL, 0xB6364C66UL,
+  0x32720B61UL, 0xB3334ACAUL, 0xB1B1C99CUL, 0x30F08837UL,
+  0x10503359UL, 0x911172F2UL, 0x9393F1A4UL, 0x12D2B00FUL,
+  0x9696F708UL, 0x17D7B6A3UL, 0x155535F5UL, 0x9414745EUL,
+  0x9C9CFA50UL, 0x1DDDBBFBUL, 0x1F5F38ADUL, 0x9E1E7906UL,
+  0x1A5A3E01UL, 0x9B1B7FAAUL, 0x9999FCFCUL, 0x18D8BD57UL,
+  0x8888E0E0UL, 0x09C9A14BUL, 0x0B4B221DUL, 0x8A0A63B6UL,
+  0x0E4E24B1UL, 0x8F0F651AUL, 0x8D8DE64CUL, 0x0CCCA7E7UL,
+  0x044429E9UL, 0x85056842UL, 0x8787EB14UL, 0x06C6AABFUL,
+  0x8282EDB8UL, 0x03C3AC13UL, 0x01412F45UL, 0x80006EEEUL
+};
+
+#if KMESH_CRC_SLICE_BY_8
+// slice_table[k][i] is crc_table[i] followed by k zero bytes.
+static uint32_t slice_table[8][256];
+static bool slice_table_ready;
+#endif
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+#if KMESH_CRC_SLICE_BY_8
+static void build_slice_table(void);
+#endif
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+uint32_t kmesh_crc_bitwise(uint32_t crc, const uint8_t *data, size_t length)
+{
+  while (length-- > 0U) {
+    crc ^= (uint32_t)*data++ << 24;
+    for (uint8_t bit = 0U; bit < 8U; bit++) {
+      crc = ((crc & KMESH_CRC_MSB) != 0U) ? ((crc << 1) ^ KMESH_CRC_POLY) : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+uint32_t kmesh_crc_table(uint32_t crc, const uint8_t *data, size_t length)
+{
+  while (length-- > 0U) {
+    crc = (crc << 8) ^ crc_table[((crc >> 24) ^ *data++) & 0xFFU];
+  }
+  return crc;
+}
+
+#if KMESH_CRC_SLICE_BY_8
+uint32_t kmesh_crc_slice8(uint32_t crc, const uint8_t *data, size_t length)
+{
+  if (!slice_table_ready) {
+    build_slice_table();
+  }
+  while (length >= 8U) {
+    uint32_t word = crc ^ (((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16)
+                           | ((uint32_t)data[2] << 8) | data[3]);
+    crc = slice_table[7][word >> 24]
+          ^ slice_table[6][(word >> 16) & 0xFFU]
+          ^ slice_table[5][(word >> 8) & 0xFFU]
+          ^ slice_table[4][word & 0xFFU]
+          ^ slice_table[3][data[4]]
+          ^ slice_table[2][data[5]]
+          ^ slice_table[1][data[6]]
+          ^ slice_table[0][data[7]];
+    data += 8;
+    length -= 8U;
+  }
+  return kmesh_crc_table(crc, data, length);
+}
+#endif
+
+// PN9 as a 9-bit Fibonacci LFSR whose low bit is the next output bit. Eight
+// steps at once: the eight new feedback bits are state[k] ^ state[k + 5],
+// where the upper four of them depend on the lower four just produced.
+void kmesh_whiten(uint16_t *state, uint8_t *data, size_t length)
+{
+  uint16_t lfsr = *state;
+
+  while (length-- > 0U) {
+    uint16_t low = (lfsr ^ (lfsr >> 5)) & 0x0FU;
+    uint16_t feedback = low | ((((lfsr >> 4) ^ low) & 0x0FU) << 4);
+
+    *data++ ^= (uint8_t)lfsr;
+    lfsr = (uint16_t)((lfsr >> 8) | (feedback << 1)) & 0x01FFU;
+  }
+  *state = lfsr;
+}
+
+bool kmesh_crc_check_frame(uint8_t *frame, size_t length, bool whitened)
+{
+  uint8_t *payload = &frame[KMESH_FRAME_LENGTH_HEADER];
+  size_t payload_length;
+  uint32_t received;
+
+  if (length < (KMESH_FRAME_LENGTH_HEADER + KMESH_CRC_LENGTH)) {
+    return false;
+  }
+  payload_length = length - KMESH_FRAME_LENGTH_HEADER - KMESH_CRC_LENGTH;
+  if (whitened) {
+    uint16_t state = KMESH_WHITEN_SEED;
+    kmesh_whiten(&state, payload, payload_length + KMESH_CRC_LENGTH);
+  }
+  received = ((uint32_t)payload[payload_length] << 24)
+             | ((uint32_t)payload[payload_length + 1U] << 16)
+             | ((uint32_t)payload[payload_length + 2U] << 8)
+             | payload[payload_length + 3U];
+  return kmesh_crc(payload, payload_length) == received;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+#if KMESH_CRC_SLICE_BY_8
+// Racing callers compute identical values, so no locking is needed.
+static void build_slice_table(void)
+{
+  for (uint16_t i = 0U; i < 256U; i++) {
+    uint32_t crc = crc_table[i];
+    slice_table[0][i] = crc;
+    for (uint8_t k = 1U; k < 8U; k++) {
+      crc = (crc << 8) ^ crc_table[crc >> 24];
+      slice_table[k][i] = crc;
+    }
+  }
+  slice_table_ready = true;
+}
+#endif
@@ -0,0 +1,60 @@
+/***************************************************************************//**
+ * @file kmesh_crc.h
+ * @brief Software CRC and whitening matching radio_settings.radioconf.
+ *
+ * The PHY appends CRC-32Q (poly 0x814141AB, seed 0, not reflected, not
+ * inverted, crc_poly 6) over the payload, sent most significant byte first,
+ * and whitens payload and CRC with PN9 (x^9 + x^5 + 1, seed 0x1FF). The
+ * 2-byte length header is neither covered by the CRC nor whitened.
+ *
+ * Plain C with no SDK dependencies so the host tools under tools/ build the
+ * very same file.
+ ******************************************************************************/
+
+#ifndef KMESH_CRC_H
+#define KMESH_CRC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "kmesh_config.h"
+
+#define KMESH_CRC_SEED         0x00000000UL
+#define KMESH_CRC_POLY         0x814141ABUL
+#define KMESH_CRC_LENGTH       4U
+// CRC-32Q of the ASCII string "123456789".
+#define KMESH_CRC_CHECK_VALUE  0x3010BF7FUL
+
+#define KMESH_WHITEN_SEED      0x01FFU
+
+// Reference implementation, one bit at a time.
+uint32_t kmesh_crc_bitwise(uint32_t crc, const uint8_t *data, size_t length);
+
+// One lookup per byte in a 1 kB table held in flash.
+uint32_t kmesh_crc_table(uint32_t crc, const uint8_t *data, size_t length);
+
+#if KMESH_CRC_SLICE_BY_8
+// Eight bytes per step using 8 kB of tables built in RAM on first use.
+uint32_t kmesh_crc_slice8(uint32_t crc, const uint8_t *data, size_t length);
+#endif
+
+// Fastest implementation enabled in this build.
+static inline uint32_t kmesh_crc(const uint8_t *data, size_t length)
+{
+#if KMESH_CRC_SLICE_BY_8
+  return kmesh_crc_slice8(KMESH_CRC_SEED, data, length);
+#else
+  return kmesh_crc_table(KMESH_CRC_SEED, data, length);
+#endif
+}
+
+// XOR data in place with the PN9 sequence continuing from *state, a byte at a
+// time. Start each frame from KMESH_WHITEN_SEED; whitening and de-whitening
+// are the same operation.
+void kmesh_whiten(uint16_t *state, uint8_t *data, size_t length);
+
+// Check an over-the-air frame: 2-byte length header, payload, then the CRC.
+// If whitened is set, payload and CRC are de-whitened in place first.
+bool kmesh_crc_check_frame(uint8_t *frame, size_t length, bool whitened);
+
+#endif // KMESH_CRC_H
@@ -0,0 +1,281 @@
+/***************************************************************************//**
+ * @file kmesh_energy.c
+ * @brief Energy estimate from radio on-time, TX power and EM residency.
+ *
+ * The radio's state is followed from RAIL events, RAIL_EVENT_TX_STARTED
+ * included, and sampled from the main loop. Each transmission is charged at
+ * the current of its PA mode and power, interpolated linearly in output
+ * power between the mode's current at no output and at its maximum; the
+ * time received is charged at the RX current. What remains of the EM0 and
+ * EM1 residency from kmesh_power is charged at the MCU's current, and EM2
+ * at the sleep current. The currents are datasheet typicals in
+ * kmesh_config.h, to be replaced with values measured on the board.
+ *
+ * Listen windows open from RAIL's timer without an event, so a window that
+ * ends without the main loop having seen it is charged as on_us of RX.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "kmesh.h"
+#include "kmesh_energy.h"
+#include "kmesh_power.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_ENERGY_TX_END_EVENTS (RAIL_EVENT_TX_PACKET_SENT      \
+                                    | RAIL_EVENT_TX_ABORTED        \
+                                    | RAIL_EVENT_TX_UNDERFLOW      \
+                                    | RAIL_EVENT_TXACK_PACKET_SENT)
+
+typedef enum kmesh_energy_radio {
+  KMESH_ENERGY_RADIO_OFF,
+  KMESH_ENERGY_RADIO_RX,
+  KMESH_ENERGY_RADIO_TX,
+} kmesh_energy_radio_t;
+
+typedef struct kmesh_energy_pa_table {
+  const char *name;
+  int16_t max_ddbm;
+  uint32_t base_ua;
+  uint32_t max_ua;
+} kmesh_energy_pa_table_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static kmesh_energy_radio_t sample_radio(RAIL_Handle_t rail_handle);
+static void switch_radio(kmesh_energy_radio_t to, RAIL_Time_t now, bool sent);
+static kmesh_energy_pa_t pa_of(RAIL_TxPowerMode_t mode);
+static uint32_t ddbm_to_uw(int16_t ddbm);
+static uint64_t nj_of(uint32_t current_ua, uint64_t us);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static const kmesh_energy_pa_table_t pa_tables[KMESH_ENERGY_PAS] = {
+  [KMESH_ENERGY_PA_HP] = { "HP", 200, KMESH_ENERGY_TX_HP_BASE_UA, KMESH_ENERGY_TX_HP_UA },
+  [KMESH_ENERGY_PA_MP] = { "MP", 100, KMESH_ENERGY_TX_MP_BASE_UA, KMESH_ENERGY_TX_MP_UA },
+  [KMESH_ENERGY_PA_LP] = { "LP", 0, KMESH_ENERGY_TX_LP_BASE_UA, KMESH_ENERGY_TX_LP_UA },
+  [KMESH_ENERGY_PA_LLP] = { "LLP", -100, KMESH_ENERGY_TX_LLP_BASE_UA, KMESH_ENERGY_TX_LLP_UA },
+};
+
+// 10^(n/10) for n = 0..9 dB, scaled by 1000.
+static const uint16_t db_steps[10] = {
+  1000U, 1259U, 1585U, 1995U, 2512U, 3162U, 3981U, 5012U, 6310U, 7943U
+};
+
+static kmesh_energy_radio_t radio = KMESH_ENERGY_RADIO_OFF;
+static RAIL_Time_t radio_since;
+static kmesh_energy_pa_t tx_pa;
+static int16_t tx_power_ddbm;
+
+static kmesh_energy_tx_t tx[KMESH_ENERGY_PAS];
+static uint64_t rx_us;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_energy_init(void)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+
+  (void) RAIL_ConfigEvents(rail_handle, RAIL_EVENT_TX_STARTED, RAIL_EVENT_TX_STARTED);
+  radio = sample_radio(rail_handle);
+  radio_since = RAIL_GetTime();
+}
+
+void kmesh_energy_process_action(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  // The end of a transmission is left to its event, which counts the packet.
+  if (radio != KMESH_ENERGY_RADIO_TX) {
+    switch_radio(sample_radio(kmesh_get_rail_handle()), RAIL_GetTime(), false);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+void kmesh_energy_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events)
+{
+  RAIL_Time_t now = RAIL_GetTime();
+
+  if ((events & RAIL_EVENT_RX_DUTY_CYCLE_RX_END) != 0U
+      && radio != KMESH_ENERGY_RADIO_RX) {
+    rx_us += kmesh_power_get_listen_on_us();
+  }
+  if ((events & RAIL_EVENT_TX_STARTED) != 0U) {
+    switch_radio(KMESH_ENERGY_RADIO_TX, now, false);
+  }
+  if (radio == KMESH_ENERGY_RADIO_TX && (events & KMESH_ENERGY_TX_END_EVENTS) == 0U) {
+    return;
+  }
+  switch_radio(sample_radio(rail_handle), now,
+               (events & (RAIL_EVENT_TX_PACKET_SENT | RAIL_EVENT_TXACK_PACKET_SENT)) != 0U);
+}
+
+void kmesh_energy_get_report(kmesh_energy_report_t *report)
+{
+  kmesh_power_residency_t residency;
+  uint64_t em_us[KMESH_POWER_MODES];
+  uint64_t radio_us;
+  uint64_t tx_nj = 0U;
+  uint64_t mcu_nj;
+  CORE_DECLARE_IRQ_STATE;
+
+  memset(report, 0, sizeof(*report));
+  CORE_ENTER_ATOMIC();
+  if (radio == KMESH_ENERGY_RADIO_RX) {
+    switch_radio(KMESH_ENERGY_RADIO_RX, RAIL_GetTime(), false);
+  }
+  memcpy(report->tx, tx, sizeof(report->tx));
+  report->rx_us = rx_us;
+  CORE_EXIT_ATOMIC();
+
+  kmesh_power_get_residency(&residency);
+  radio_us = report->rx_us;
+  for (uint8_t i = 0U; i < KMESH_ENERGY_PAS; i++) {
+    radio_us += report->tx[i].us;
+    tx_nj += report->tx[i].nj;
+  }
+  for (uint8_t i = 0U; i < KMESH_POWER_MODES; i++) {
+    em_us[i] = (uint64_t)kmesh_power_ticks_to_ms(residency.ticks[i]) * 1000U;
+    report->elapsed_ms += kmesh_power_ticks_to_ms(residency.ticks[i]);
+  }
+  // The radio currents include the MCU, so take radio time off EM1 first.
+  if (em_us[KMESH_POWER_EM1] >= radio_us) {
+    em_us[KMESH_POWER_EM1] -= radio_us;
+  } else {
+    radio_us -= em_us[KMESH_POWER_EM1];
+    em_us[KMESH_POWER_EM1] = 0U;
+    em_us[KMESH_POWER_EM0] -= (em_us[KMESH_POWER_EM0] >= radio_us)
+                              ? radio_us : em_us[KMESH_POWER_EM0];
+  }
+  mcu_nj = nj_of(KMESH_ENERGY_EM0_UA, em_us[KMESH_POWER_EM0])
+           + nj_of(KMESH_ENERGY_EM1_UA, em_us[KMESH_POWER_EM1]);
+
+  report->tx_uj = (uint32_t)(tx_nj / 1000U);
+  report->rx_uj = (uint32_t)(nj_of(KMESH_ENERGY_RX_UA, report->rx_us) / 1000U);
+  report->mcu_uj = (uint32_t)(mcu_nj / 1000U);
+  // The EM2 current is in nanoamps.
+  report->sleep_uj = (uint32_t)(nj_of(KMESH_ENERGY_EM2_NA, em_us[KMESH_POWER_EM2])
+                                / 1000000U);
+  report->total_uj = report->tx_uj + report->rx_uj + report->mcu_uj + report->sleep_uj;
+}
+
+void kmesh_energy_reset(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  memset(tx, 0, sizeof(tx));
+  rx_us = 0U;
+  radio_since = RAIL_GetTime();
+  CORE_EXIT_ATOMIC();
+  kmesh_power_reset_residency();
+}
+
+uint32_t kmesh_energy_tx_current_ua(kmesh_energy_pa_t pa, int16_t power_ddbm)
+{
+  const kmesh_energy_pa_table_t *table = &pa_tables[pa];
+  uint32_t max_uw = ddbm_to_uw(table->max_ddbm);
+  uint32_t uw = ddbm_to_uw(power_ddbm);
+
+  if (uw >= max_uw) {
+    return table->max_ua;
+  }
+  return table->base_ua
+         + (uint32_t)(((uint64_t)(table->max_ua - table->base_ua) * uw) / max_uw);
+}
+
+const char *kmesh_energy_pa_name(kmesh_energy_pa_t pa)
+{
+  return pa_tables[pa].name;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static kmesh_energy_radio_t sample_radio(RAIL_Handle_t rail_handle)
+{
+  RAIL_RadioState_t state = RAIL_GetRadioState(rail_handle);
+
+  if ((state & RAIL_RF_STATE_TX) != 0U) {
+    return KMESH_ENERGY_RADIO_TX;
+  }
+  if ((state & RAIL_RF_STATE_RX) != 0U) {
+    return KMESH_ENERGY_RADIO_RX;
+  }
+  return KMESH_ENERGY_RADIO_OFF;
+}
+
+// Charges the time since the last switch to the state the radio was in.
+// Interrupts off or interrupt context.
+static void switch_radio(kmesh_energy_radio_t to, RAIL_Time_t now, bool sent)
+{
+  RAIL_Time_t us = now - radio_since;
+
+  if (radio == KMESH_ENERGY_RADIO_RX) {
+    rx_us += us;
+  } else if (radio == KMESH_ENERGY_RADIO_TX) {
+    tx[tx_pa].us += us;
+    tx[tx_pa].nj += nj_of(kmesh_energy_tx_current_ua(tx_pa, tx_power_ddbm), us);
+    if (sent) {
+      tx[tx_pa].packets++;
+    }
+  }
+  if (to == KMESH_ENERGY_RADIO_TX && radio != KMESH_ENERGY_RADIO_TX) {
+    RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+    RAIL_TxPowerConfig_t config;
+
+    tx_pa = (RAIL_GetTxPowerConfig(rail_handle, &config) == RAIL_STATUS_NO_ERROR)
+            ? pa_of(config.mode) : KMESH_ENERGY_PA_HP;
+    tx_power_ddbm = RAIL_GetTxPowerDbm(rail_handle);
+  }
+  radio = to;
+  radio_since = now;
+}
+
+static kmesh_energy_pa_t pa_of(RAIL_TxPowerMode_t mode)
+{
+  switch (mode) {
+    case RAIL_TX_POWER_MODE_SUBGIG_MP:
+      return KMESH_ENERGY_PA_MP;
+    case RAIL_TX_POWER_MODE_SUBGIG_LP:
+      return KMESH_ENERGY_PA_LP;
+    case RAIL_TX_POWER_MODE_SUBGIG_LLP:
+      return KMESH_ENERGY_PA_LLP;
+    default:
+      return KMESH_ENERGY_PA_HP;
+  }
+}
+
+// Output power in microwatts, to the nearest whole dB below.
+static uint32_t ddbm_to_uw(int16_t ddbm)
+{
+  int32_t db = (ddbm >= 0) ? ddbm / 10 : -((9 - ddbm) / 10);
+  int32_t decades = (db >= 0) ? db / 10 : -((9 - db) / 10);
+  uint32_t uw = db_steps[db - decades * 10];
+
+  if (decades < -3) {
+    return 0U;
+  }
+  for (; decades > 0; decades--) {
+    uw *= 10U;
+  }
+  for (; decades < 0; decades++) {
+    uw /= 10U;
+  }
+  return uw;
+}
+
+// Microamps at the supply voltage for us microseconds, in nanojoules.
+static uint64_t nj_of(uint32_t current_ua, uint64_t us)
+{
+  return ((uint64_t)current_ua * KMESH_ENERGY_SUPPLY_MV * us) / 1000000U;
+}
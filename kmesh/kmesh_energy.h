@@ -0,0 +1,60 @@
+/***************************************************************************//**
+ * @file kmesh_energy.h
+ * @brief Energy estimate from radio on-time, TX power and EM residency.
+ ******************************************************************************/
+
+#ifndef KMESH_ENERGY_H
+#define KMESH_ENERGY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+// Sub-GHz PA modes with their own current table.
+typedef enum kmesh_energy_pa {
+  KMESH_ENERGY_PA_HP,
+  KMESH_ENERGY_PA_MP,
+  KMESH_ENERGY_PA_LP,
+  KMESH_ENERGY_PA_LLP,
+  KMESH_ENERGY_PAS
+} kmesh_energy_pa_t;
+
+typedef struct kmesh_energy_tx {
+  uint32_t packets;
+  uint64_t us;
+  uint64_t nj;
+} kmesh_energy_tx_t;
+
+typedef struct kmesh_energy_report {
+  kmesh_energy_tx_t tx[KMESH_ENERGY_PAS];
+  uint64_t rx_us;
+  // Microjoules by where they went. mcu covers EM0 and EM1 time with the
+  // radio off; sleep covers EM2.
+  uint32_t tx_uj;
+  uint32_t rx_uj;
+  uint32_t mcu_uj;
+  uint32_t sleep_uj;
+  uint32_t total_uj;
+  uint32_t elapsed_ms;
+} kmesh_energy_report_t;
+
+// Enables RAIL_EVENT_TX_STARTED to time transmissions. Called from
+// kmesh_init() after kmesh_power_init().
+void kmesh_energy_init(void);
+
+// Samples the radio state. Called from kmesh_process_action().
+void kmesh_energy_process_action(void);
+
+// Times TX and RX. Interrupt context.
+void kmesh_energy_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events);
+
+// Estimate since the last reset, which also resets the power residency.
+void kmesh_energy_get_report(kmesh_energy_report_t *report);
+void kmesh_energy_reset(void);
+
+// Current in microamps drawn while transmitting at power_ddbm in a PA mode.
+uint32_t kmesh_energy_tx_current_ua(kmesh_energy_pa_t pa, int16_t power_ddbm);
+
+const char *kmesh_energy_pa_name(kmesh_energy_pa_t pa);
+
+#endif // KMESH_ENERGY_H
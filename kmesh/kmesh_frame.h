@@ -0,0 +1,226 @@
+/***************************************************************************//**
+ * @file kmesh_frame.h
+ * @brief Over-the-air layout of kmesh frames.
+ *
+ * Every frame starts with the 2-byte PHY header carrying the 11-bit length
+ * (MSB first, see radio_settings.radioconf), followed by the kmesh header:
+ *
+ *   0..1  length header: number of bytes following the header
+ *   2     type (low nibble) and flags (high nibble)
+ *   3     sequence number
+ *   4..5  destination address
+ *   6..7  source address
+ *   8..9  next hop address
+ *   10    hop limit
+ *   11..  payload
+ *
+ * Aggregate frames carry a sequence of messages as payload, each prefixed
+ * with destination (2), source (2), hop limit (1) and length (1).
+ *
+ * PRBS test frames carry the pattern (1) and the generator state at the
+ * start of the payload (4), then generated bytes up to the end of the frame.
+ *
+ * Throughput benchmark frames start the payload with the kind (1), the run
+ * (1) and the sequence number (2). Reports follow that with the frames (4)
+ * and payload bytes (4) the peer received in the run.
+ *
+ * Multi-byte fields are big endian to match the PHY bit endianness.
+ ******************************************************************************/
+
+#ifndef KMESH_FRAME_H
+#define KMESH_FRAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define KMESH_FRAME_LENGTH_MASK        0x07FFU
+#define KMESH_FRAME_LENGTH_HEADER      2U
+// Largest frame the 11-bit length header can describe, header included.
+#define KMESH_FRAME_LENGTH_LIMIT       (KMESH_FRAME_LENGTH_MASK + KMESH_FRAME_LENGTH_HEADER)
+
+#define KMESH_FRAME_OFFSET_LENGTH      0U
+#define KMESH_FRAME_OFFSET_TYPE        2U
+#define KMESH_FRAME_OFFSET_SEQUENCE    3U
+#define KMESH_FRAME_OFFSET_DESTINATION 4U
+#define KMESH_FRAME_OFFSET_SOURCE      6U
+#define KMESH_FRAME_OFFSET_NEXT_HOP    8U
+#define KMESH_FRAME_OFFSET_HOP_LIMIT   10U
+#define KMESH_FRAME_HEADER_LENGTH      11U
+
+#define KMESH_FRAME_TYPE_MASK          0x0FU
+#define KMESH_FRAME_TYPE_DATA          0x00U
+#define KMESH_FRAME_TYPE_ROUTE_ADVERT  0x01U
+#define KMESH_FRAME_TYPE_ACK           0x02U
+#define KMESH_FRAME_TYPE_AGGREGATE     0x03U
+#define KMESH_FRAME_TYPE_PRBS          0x04U
+#define KMESH_FRAME_TYPE_BENCH         0x05U
+
+#define KMESH_FRAME_FLAGS_MASK         0xF0U
+#define KMESH_FRAME_FLAG_ACK_REQUEST   0x10U
+
+#define KMESH_AGGR_OFFSET_DESTINATION  0U
+#define KMESH_AGGR_OFFSET_SOURCE       2U
+#define KMESH_AGGR_OFFSET_HOP_LIMIT    4U
+#define KMESH_AGGR_OFFSET_LENGTH       5U
+#define KMESH_AGGR_HEADER_LENGTH       6U
+
+#define KMESH_PRBS_OFFSET_PATTERN      0U
+#define KMESH_PRBS_OFFSET_STATE        1U
+#define KMESH_PRBS_HEADER_LENGTH       5U
+
+#define KMESH_BENCH_OFFSET_KIND        0U
+#define KMESH_BENCH_OFFSET_RUN         1U
+#define KMESH_BENCH_OFFSET_SEQUENCE    2U
+#define KMESH_BENCH_HEADER_LENGTH      4U
+#define KMESH_BENCH_OFFSET_FRAMES      4U
+#define KMESH_BENCH_OFFSET_BYTES       8U
+#define KMESH_BENCH_REPORT_LENGTH      12U
+
+// Data that is only counted, data the peer echoes back, the echo, and the
+// request for and answer with the peer's counts.
+#define KMESH_BENCH_KIND_DATA           0x00U
+#define KMESH_BENCH_KIND_REQUEST        0x01U
+#define KMESH_BENCH_KIND_ECHO           0x02U
+#define KMESH_BENCH_KIND_REPORT_REQUEST 0x03U
+#define KMESH_BENCH_KIND_REPORT         0x04U
+
+#define KMESH_ADDRESS_BROADCAST        0xFFFFU
+
+// On-air overhead around each frame, from radio_settings.radioconf.
+#define KMESH_PHY_PREAMBLE_BITS        40U
+#define KMESH_PHY_SYNC_WORD_BITS       16U
+#define KMESH_PHY_CRC_LENGTH           4U
+
+// The layout is fixed on air; catch edits that make fields overlap.
+_Static_assert(KMESH_FRAME_OFFSET_TYPE == KMESH_FRAME_LENGTH_HEADER,
+               "kmesh header must follow the length header");
+_Static_assert(KMESH_FRAME_OFFSET_HOP_LIMIT + 1U == KMESH_FRAME_HEADER_LENGTH,
+               "KMESH_FRAME_HEADER_LENGTH does not match the field layout");
+_Static_assert(KMESH_AGGR_OFFSET_LENGTH + 1U == KMESH_AGGR_HEADER_LENGTH,
+               "KMESH_AGGR_HEADER_LENGTH does not match the field layout");
+_Static_assert(KMESH_PRBS_OFFSET_STATE + 4U == KMESH_PRBS_HEADER_LENGTH,
+               "KMESH_PRBS_HEADER_LENGTH does not match the field layout");
+_Static_assert(KMESH_BENCH_OFFSET_SEQUENCE + 2U == KMESH_BENCH_HEADER_LENGTH,
+               "KMESH_BENCH_HEADER_LENGTH does not match the field layout");
+_Static_assert((KMESH_FRAME_TYPE_MASK & KMESH_FRAME_FLAGS_MASK) == 0U,
+               "type and flags share the same byte and must not overlap");
+
+// Decoded kmesh header. length is the total frame length, including the
+// 2-byte length header, rather than the raw field value.
+typedef struct kmesh_frame_header {
+  uint16_t length;
+  uint8_t type;
+  uint8_t flags;
+  uint8_t sequence;
+  uint16_t destination;
+  uint16_t source;
+  uint16_t next_hop;
+  uint8_t hop_limit;
+} kmesh_frame_header_t;
+
+// Decoded header of one message inside an aggregate frame.
+typedef struct kmesh_aggr_message {
+  uint16_t destination;
+  uint16_t source;
+  uint8_t hop_limit;
+  uint8_t length;
+} kmesh_aggr_message_t;
+
+static inline uint16_t kmesh_frame_get_u16(const uint8_t *frame, uint16_t offset)
+{
+  return (uint16_t)(((uint16_t)frame[offset] << 8) | frame[offset + 1U]);
+}
+
+static inline void kmesh_frame_put_u16(uint8_t *frame, uint16_t offset, uint16_t value)
+{
+  frame[offset] = (uint8_t)(value >> 8);
+  frame[offset + 1U] = (uint8_t)value;
+}
+
+// Write the length header for a frame of length bytes in total. Returns false,
+// leaving the frame untouched, if the length cannot be represented.
+static inline bool kmesh_frame_encode_length(uint8_t *frame, uint16_t length)
+{
+  if (length < KMESH_FRAME_LENGTH_HEADER || length > KMESH_FRAME_LENGTH_LIMIT) {
+    return false;
+  }
+  kmesh_frame_put_u16(frame, KMESH_FRAME_OFFSET_LENGTH,
+                      length - KMESH_FRAME_LENGTH_HEADER);
+  return true;
+}
+
+// Total frame length announced by the length header.
+static inline uint16_t kmesh_frame_decode_length(const uint8_t *frame)
+{
+  return (kmesh_frame_get_u16(frame, KMESH_FRAME_OFFSET_LENGTH)
+          & KMESH_FRAME_LENGTH_MASK) + KMESH_FRAME_LENGTH_HEADER;
+}
+
+static inline uint8_t kmesh_frame_get_type(const uint8_t *frame)
+{
+  return frame[KMESH_FRAME_OFFSET_TYPE] & KMESH_FRAME_TYPE_MASK;
+}
+
+static inline uint8_t kmesh_frame_get_flags(const uint8_t *frame)
+{
+  return frame[KMESH_FRAME_OFFSET_TYPE] & KMESH_FRAME_FLAGS_MASK;
+}
+
+static inline bool kmesh_frame_encode_header(uint8_t *frame,
+                                             const kmesh_frame_header_t *header)
+{
+  if (header->length < KMESH_FRAME_HEADER_LENGTH
+      || !kmesh_frame_encode_length(frame, header->length)) {
+    return false;
+  }
+  frame[KMESH_FRAME_OFFSET_TYPE] = (header->type & KMESH_FRAME_TYPE_MASK)
+                                   | (header->flags & KMESH_FRAME_FLAGS_MASK);
+  frame[KMESH_FRAME_OFFSET_SEQUENCE] = header->sequence;
+  kmesh_frame_put_u16(frame, KMESH_FRAME_OFFSET_DESTINATION, header->destination);
+  kmesh_frame_put_u16(frame, KMESH_FRAME_OFFSET_SOURCE, header->source);
+  kmesh_frame_put_u16(frame, KMESH_FRAME_OFFSET_NEXT_HOP, header->next_hop);
+  frame[KMESH_FRAME_OFFSET_HOP_LIMIT] = header->hop_limit;
+  return true;
+}
+
+// Decode the first KMESH_FRAME_HEADER_LENGTH bytes of a frame. Returns false
+// if the length header does not agree with the received_length bytes
+// actually received, meaning this is not a kmesh frame.
+static inline bool kmesh_frame_decode_header(const uint8_t *frame,
+                                             uint16_t received_length,
+                                             kmesh_frame_header_t *header)
+{
+  header->length = kmesh_frame_decode_length(frame);
+  if (received_length < KMESH_FRAME_HEADER_LENGTH
+      || header->length != received_length) {
+    return false;
+  }
+  header->type = kmesh_frame_get_type(frame);
+  header->flags = kmesh_frame_get_flags(frame);
+  header->sequence = frame[KMESH_FRAME_OFFSET_SEQUENCE];
+  header->destination = kmesh_frame_get_u16(frame, KMESH_FRAME_OFFSET_DESTINATION);
+  header->source = kmesh_frame_get_u16(frame, KMESH_FRAME_OFFSET_SOURCE);
+  header->next_hop = kmesh_frame_get_u16(frame, KMESH_FRAME_OFFSET_NEXT_HOP);
+  header->hop_limit = frame[KMESH_FRAME_OFFSET_HOP_LIMIT];
+  return true;
+}
+
+static inline void kmesh_aggr_encode_message(uint8_t *data,
+                                             const kmesh_aggr_message_t *message)
+{
+  kmesh_frame_put_u16(data, KMESH_AGGR_OFFSET_DESTINATION, message->destination);
+  kmesh_frame_put_u16(data, KMESH_AGGR_OFFSET_SOURCE, message->source);
+  data[KMESH_AGGR_OFFSET_HOP_LIMIT] = message->hop_limit;
+  data[KMESH_AGGR_OFFSET_LENGTH] = message->length;
+}
+
+static inline void kmesh_aggr_decode_message(const uint8_t *data,
+                                             kmesh_aggr_message_t *message)
+{
+  message->destination = kmesh_frame_get_u16(data, KMESH_AGGR_OFFSET_DESTINATION);
+  message->source = kmesh_frame_get_u16(data, KMESH_AGGR_OFFSET_SOURCE);
+  message->hop_limit = data[KMESH_AGGR_OFFSET_HOP_LIMIT];
+  message->length = data[KMESH_AGGR_OFFSET_LENGTH];
+}
+
+#endif // KMESH_FRAME_H
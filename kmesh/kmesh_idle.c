@@ -0,0 +1,186 @@
+/***************************************************************************//**
+ * @file kmesh_idle.c
+ * @brief Deadline-aware choice between EM1 and EM2 for the main loop's sleep.
+ *
+ * kmesh's flush, summary and script deadlines are polled from the main loop,
+ * which sl_power_manager_sleep() suspends until some interrupt comes along.
+ * In EM2 that can be long after the deadline, and coming out of EM2 costs
+ * the HFXO startup before the radio can transmit. So after every pass the
+ * earliest deadline is collected from the modules, the ARQ timers and the
+ * RAIL timer, and a sleeptimer wakeup is armed for it:
+ *
+ * - due within KMESH_IDLE_NO_SLEEP_US: do not sleep at all;
+ * - due within KMESH_IDLE_EM2_MIN_US: hold EM1, so the HFXO keeps running;
+ * - later: allow EM2. The wakeup is armed without
+ *   SL_SLEEPTIMER_NO_HIGH_PRECISION_HF_CLOCKS_REQUIRED_FLAG, so the power
+ *   manager wakes early by the startup time the HFXO manager measured and
+ *   the HFXO is ready at the deadline.
+ *
+ * An interrupt between that pass and the sleep can arm an earlier deadline,
+ * e.g. an ARQ timer from a received frame. The power manager asks
+ * app_is_ok_to_sleep() with interrupts off right before sleeping, so the
+ * deadlines are collected again there and the sleep is refused if one is
+ * now earlier than the wakeup armed for; the main loop then runs another
+ * pass and arms for it.
+ *
+ * RAIL's scheduled TX and RX are left to RAIL's power manager integration,
+ * which wakes the radio for them itself.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_power_manager.h"
+#include "sl_sleeptimer.h"
+#include "kmesh.h"
+#include "kmesh_aggr.h"
+#include "kmesh_arq.h"
+#include "kmesh_bench.h"
+#include "kmesh_console.h"
+#include "kmesh_idle.h"
+#include "kmesh_lbt.h"
+#include "kmesh_notify.h"
+#include "kmesh_script.h"
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static uint32_t time_to_deadline(RAIL_Time_t now);
+static uint32_t earliest(uint32_t a, uint32_t b);
+static void hold_em1(bool hold);
+static void on_wakeup(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_idle_counters_t kmesh_idle_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static sl_sleeptimer_timer_handle_t wakeup_timer;
+static RAIL_Time_t wakeup_deadline;
+static bool wakeup_armed;
+static bool em1_held;
+static bool no_sleep;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_idle_process_action(void)
+{
+  RAIL_Time_t now = RAIL_GetTime();
+  uint32_t idle_us = time_to_deadline(now);
+  uint32_t ticks;
+  uint16_t flags;
+
+  no_sleep = idle_us <= KMESH_IDLE_NO_SLEEP_US;
+  if (no_sleep) {
+    kmesh_idle_counters.no_sleeps++;
+    return;
+  }
+  if (idle_us == KMESH_IDLE_FOREVER) {
+    (void) sl_sleeptimer_stop_timer(&wakeup_timer);
+    wakeup_armed = false;
+    hold_em1(false);
+    kmesh_idle_counters.em2_sleeps++;
+    return;
+  }
+  if (idle_us < KMESH_IDLE_EM2_MIN_US) {
+    hold_em1(true);
+    flags = SL_SLEEPTIMER_NO_HIGH_PRECISION_HF_CLOCKS_REQUIRED_FLAG;
+    kmesh_idle_counters.em1_sleeps++;
+  } else {
+    hold_em1(false);
+    flags = 0U;
+    kmesh_idle_counters.em2_sleeps++;
+  }
+  // Rounded down: waking a tick early only costs another short pass.
+  ticks = (uint32_t)(((uint64_t)idle_us * sl_sleeptimer_get_timer_frequency())
+                     / 1000000U);
+  wakeup_deadline = now + idle_us;
+  wakeup_armed = true;
+  (void) sl_sleeptimer_restart_timer(&wakeup_timer, (ticks == 0U) ? 1U : ticks,
+                                     on_wakeup, NULL, 0U, flags);
+}
+
+void kmesh_idle_reset_counters(void)
+{
+  memset(&kmesh_idle_counters, 0, sizeof(kmesh_idle_counters));
+}
+
+// Power manager hook, called with interrupts off right before sleeping, so
+// no timer can be armed between this check and the sleep.
+bool app_is_ok_to_sleep(void)
+{
+  RAIL_Time_t now;
+  uint32_t idle_us;
+
+  if (no_sleep) {
+    return false;
+  }
+  now = RAIL_GetTime();
+  idle_us = time_to_deadline(now);
+  if (idle_us == KMESH_IDLE_FOREVER) {
+    return true;
+  }
+  if (idle_us <= KMESH_IDLE_NO_SLEEP_US) {
+    return false;
+  }
+  return wakeup_armed && (int32_t)(now + idle_us - wakeup_deadline) >= 0;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Microseconds until the earliest deadline, 0 if one is already due.
+static uint32_t time_to_deadline(RAIL_Time_t now)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  uint32_t idle_us = KMESH_IDLE_FOREVER;
+
+  idle_us = earliest(idle_us, kmesh_aggr_idle_us(now));
+  idle_us = earliest(idle_us, kmesh_notify_idle_us(now));
+  idle_us = earliest(idle_us, kmesh_script_idle_us(now));
+  idle_us = earliest(idle_us, kmesh_arq_idle_us());
+  idle_us = earliest(idle_us, kmesh_lbt_idle_us(now));
+  idle_us = earliest(idle_us, kmesh_bench_idle_us(now));
+  idle_us = earliest(idle_us, kmesh_console_idle_us(now));
+  // RAILtest's setTimer and friends.
+  if (RAIL_IsTimerRunning(rail_handle)) {
+    int32_t left = (int32_t)(RAIL_GetTimer(rail_handle) - now);
+    idle_us = earliest(idle_us, (left > 0) ? (uint32_t)left : 0U);
+  }
+  return idle_us;
+}
+
+static uint32_t earliest(uint32_t a, uint32_t b)
+{
+  return (a < b) ? a : b;
+}
+
+static void hold_em1(bool hold)
+{
+  if (hold == em1_held) {
+    return;
+  }
+  em1_held = hold;
+  if (hold) {
+    sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+  } else {
+    sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  }
+}
+
+static void on_wakeup(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  int32_t late_us = (int32_t)(RAIL_GetTime() - wakeup_deadline);
+
+  (void) handle;
+  (void) data;
+  kmesh_idle_counters.wakeups++;
+  if (late_us > 0 && (uint32_t)late_us > kmesh_idle_counters.max_late_us) {
+    kmesh_idle_counters.max_late_us = (uint32_t)late_us;
+  }
+}
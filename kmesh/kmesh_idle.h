@@ -0,0 +1,33 @@
+/***************************************************************************//**
+ * @file kmesh_idle.h
+ * @brief Deadline-aware choice between EM1 and EM2 for the main loop's sleep.
+ ******************************************************************************/
+
+#ifndef KMESH_IDLE_H
+#define KMESH_IDLE_H
+
+#include <stdint.h>
+#include "rail.h"
+
+// Returned by the *_idle_us() functions of modules with nothing scheduled.
+#define KMESH_IDLE_FOREVER UINT32_MAX
+
+typedef struct kmesh_idle_counters {
+  // Main loop passes that did not sleep, slept in EM1, or allowed EM2.
+  uint32_t no_sleeps;
+  uint32_t em1_sleeps;
+  uint32_t em2_sleeps;
+  // Wakeups for a deadline, and the latest one in microseconds.
+  uint32_t wakeups;
+  uint32_t max_late_us;
+} kmesh_idle_counters_t;
+
+extern kmesh_idle_counters_t kmesh_idle_counters;
+
+// Looks up the next deadline and prepares the sleep that follows this main
+// loop pass. Called last from kmesh_process_action().
+void kmesh_idle_process_action(void);
+
+void kmesh_idle_reset_counters(void);
+
+#endif // KMESH_IDLE_H
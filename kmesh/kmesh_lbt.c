@@ -0,0 +1,469 @@
+/***************************************************************************//**
+ * @file kmesh_lbt.c
+ * @brief Listen-before-talk for kmesh frames with a noise-tracking threshold.
+ *
+ * RAILtest's setLbtMode, setLbtParams and ccaThreshold only apply to its own
+ * tx commands; kmesh frames went out without CCA. Here every kmesh
+ * transmission goes through RAIL_StartCcaCsmaTx() unless LBT is off.
+ *
+ * In adaptive mode the main loop takes an RSSI sample every
+ * KMESH_LBT_SAMPLE_MS while the radio searches for a preamble, and folds it
+ * into the noise floor of the channel: quickly downwards and slowly upwards,
+ * so frames caught in a sample barely lift it. The CCA threshold is the floor
+ * plus the margin. Every CCA also updates a 1/8 weighted busy ratio of the
+ * channel; above KMESH_LBT_BUSY_HIGH_PERMILLE the initial backoff exponent
+ * grows by one per access, below KMESH_LBT_BUSY_LOW_PERMILLE it shrinks
+ * back towards KMESH_LBT_MIN_BO_EXP.
+ *
+ * The time from the TX request to the start of the transmission is kept
+ * as a histogram, and the benchmark paces broadcasts to measure it under
+ * the present mode.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_idle.h"
+#include "kmesh_lbt.h"
+#include "kmesh_neighbor.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_LBT_US_PER_MS         1000UL
+#define KMESH_LBT_QDBM_PER_DB       4
+#define KMESH_LBT_PERMILLE          1000U
+#define KMESH_LBT_BUSY_SHIFT        3U
+// Noise floor weights of a sample below and above it.
+#define KMESH_LBT_FLOOR_DOWN_WEIGHT 2
+#define KMESH_LBT_FLOOR_UP_WEIGHT   16
+
+#define KMESH_LBT_EVENTS (RAIL_EVENT_TX_STARTED | RAIL_EVENT_TX_CCA_RETRY \
+                          | RAIL_EVENT_TX_CHANNEL_CLEAR | RAIL_EVENT_TX_CHANNEL_BUSY)
+
+typedef struct kmesh_lbt_entry {
+  kmesh_neighbor_entry_t header;
+  kmesh_lbt_channel_t channel;
+} kmesh_lbt_entry_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static kmesh_lbt_entry_t *claim_entry(uint16_t channel);
+static void update_threshold(kmesh_lbt_entry_t *entry);
+static void sample_noise(RAIL_Handle_t rail_handle);
+static void count_cca(bool busy);
+static void adapt_backoff(void);
+static void record_delay(uint32_t delay_us);
+static void run_benchmark(RAIL_Time_t now);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static kmesh_lbt_entry_t entries[KMESH_LBT_CHANNELS];
+static const kmesh_neighbor_table_t table = KMESH_NEIGHBOR_TABLE(entries);
+
+static kmesh_lbt_mode_t mode = KMESH_LBT_OFF;
+static uint8_t margin_db = KMESH_LBT_MARGIN_DB;
+static int8_t threshold_dbm = KMESH_LBT_THRESHOLD_DBM;
+static RAIL_Time_t next_sample;
+
+static kmesh_lbt_stats_t stats;
+static bool tx_pending;
+static bool tx_cca;
+static RAIL_Time_t tx_requested;
+static kmesh_lbt_entry_t *tx_entry;
+
+static bool benchmarking;
+static uint32_t bench_count;
+static uint32_t bench_sent;
+static uint32_t bench_errors;
+static uint16_t bench_length;
+static uint32_t bench_period_us;
+static RAIL_Time_t bench_next;
+static uint8_t bench_payload[KMESH_FRAME_MAX_LENGTH];
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_lbt_init(void)
+{
+  (void) RAIL_ConfigEvents(kmesh_get_rail_handle(), KMESH_LBT_EVENTS, KMESH_LBT_EVENTS);
+  kmesh_lbt_reset_stats();
+}
+
+void kmesh_lbt_process_action(void)
+{
+  RAIL_Time_t now = RAIL_GetTime();
+
+  if (mode == KMESH_LBT_ADAPTIVE && (int32_t)(now - next_sample) >= 0) {
+    next_sample = now + KMESH_LBT_SAMPLE_MS * KMESH_LBT_US_PER_MS;
+    sample_noise(kmesh_get_rail_handle());
+  }
+  if (benchmarking) {
+    run_benchmark(now);
+  }
+}
+
+uint32_t kmesh_lbt_idle_us(RAIL_Time_t now)
+{
+  uint32_t idle_us = KMESH_IDLE_FOREVER;
+  int32_t left;
+
+  if (mode == KMESH_LBT_ADAPTIVE) {
+    left = (int32_t)(next_sample - now);
+    idle_us = (left > 0) ? (uint32_t)left : 0U;
+  }
+  // The TX completion interrupt wakes the main loop for the next frame.
+  if (benchmarking && !tx_pending) {
+    left = (int32_t)(bench_next - now);
+    if (left <= 0) {
+      return 0U;
+    }
+    if ((uint32_t)left < idle_us) {
+      idle_us = (uint32_t)left;
+    }
+  }
+  return idle_us;
+}
+
+void kmesh_lbt_on_rail_event(RAIL_Events_t events)
+{
+  if (!tx_pending) {
+    return;
+  }
+  if ((events & RAIL_EVENT_TX_CCA_RETRY) != 0U) {
+    stats.busy_ccas++;
+    count_cca(true);
+  }
+  if ((events & RAIL_EVENT_TX_STARTED) != 0U) {
+    if (tx_cca) {
+      count_cca(false);
+      adapt_backoff();
+    }
+    record_delay(RAIL_GetTime() - tx_requested);
+  }
+  if ((events & RAIL_EVENT_TX_CHANNEL_BUSY) != 0U) {
+    stats.busy_ccas++;
+    stats.failures++;
+    count_cca(true);
+    adapt_backoff();
+  }
+  if ((events & RAIL_EVENTS_TX_COMPLETION) != 0U) {
+    tx_pending = false;
+  }
+}
+
+void kmesh_lbt_configure(kmesh_lbt_mode_t new_mode, uint8_t margin, int8_t threshold)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  mode = new_mode;
+  margin_db = margin;
+  threshold_dbm = threshold;
+  for (uint8_t i = 0U; i < KMESH_LBT_CHANNELS; i++) {
+    if (entries[i].header.valid) {
+      entries[i].channel.min_bo_exp = KMESH_LBT_MIN_BO_EXP;
+      update_threshold(&entries[i]);
+    }
+  }
+  next_sample = RAIL_GetTime();
+  CORE_EXIT_ATOMIC();
+}
+
+kmesh_lbt_mode_t kmesh_lbt_get_mode(void)
+{
+  return mode;
+}
+
+uint32_t kmesh_lbt_max_delay_us(void)
+{
+  // Adaptive mode may have raised a channel's initial exponent to the top.
+  uint8_t exponent = (mode == KMESH_LBT_ADAPTIVE) ? KMESH_LBT_MAX_BO_EXP : KMESH_LBT_MIN_BO_EXP;
+  uint32_t delay_us = 0U;
+
+  if (mode == KMESH_LBT_OFF) {
+    return 0U;
+  }
+  for (uint8_t i = 0U; i < KMESH_LBT_TRIES; i++) {
+    delay_us += ((1UL << exponent) - 1U) * KMESH_LBT_BACKOFF_US + KMESH_LBT_CCA_US;
+    if (exponent < KMESH_LBT_MAX_BO_EXP) {
+      exponent++;
+    }
+  }
+  return delay_us;
+}
+
+uint8_t kmesh_lbt_get_margin_db(void)
+{
+  return margin_db;
+}
+
+int8_t kmesh_lbt_get_threshold(void)
+{
+  return threshold_dbm;
+}
+
+RAIL_Status_t kmesh_lbt_start_tx(RAIL_Handle_t rail_handle, uint16_t channel, bool cca)
+{
+  RAIL_CsmaConfig_t csma = {
+    .csmaMinBoExp = KMESH_LBT_MIN_BO_EXP,
+    .csmaMaxBoExp = KMESH_LBT_MAX_BO_EXP,
+    .csmaTries = KMESH_LBT_TRIES,
+    .ccaThreshold = threshold_dbm,
+    .ccaBackoff = KMESH_LBT_BACKOFF_US,
+    .ccaDuration = KMESH_LBT_CCA_US,
+    .csmaTimeout = 0U,
+  };
+  RAIL_Status_t status;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  tx_entry = claim_entry(channel);
+  if (mode == KMESH_LBT_ADAPTIVE) {
+    csma.ccaThreshold = tx_entry->channel.threshold_dbm;
+    csma.csmaMinBoExp = tx_entry->channel.min_bo_exp;
+  }
+  tx_cca = cca && (mode != KMESH_LBT_OFF);
+  tx_requested = RAIL_GetTime();
+  tx_pending = true;
+  status = tx_cca ? RAIL_StartCcaCsmaTx(rail_handle, channel, RAIL_TX_OPTIONS_DEFAULT,
+                                        &csma, NULL)
+           : RAIL_StartTx(rail_handle, channel, RAIL_TX_OPTIONS_DEFAULT, NULL);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    tx_pending = false;
+  }
+  CORE_EXIT_ATOMIC();
+  return status;
+}
+
+bool kmesh_lbt_get_channel(uint8_t index, kmesh_lbt_channel_t *channel)
+{
+  const kmesh_lbt_entry_t *entry = kmesh_neighbor_get(&table, index);
+
+  if (entry == NULL) {
+    return false;
+  }
+  *channel = entry->channel;
+  return true;
+}
+
+void kmesh_lbt_get_stats(kmesh_lbt_stats_t *copy)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  *copy = stats;
+  CORE_EXIT_ATOMIC();
+}
+
+void kmesh_lbt_reset_stats(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  memset(&stats, 0, sizeof(stats));
+  stats.min_us = UINT32_MAX;
+  CORE_EXIT_ATOMIC();
+}
+
+uint32_t kmesh_lbt_percentile_us(const kmesh_lbt_stats_t *snapshot, uint16_t permille)
+{
+  uint64_t wanted = (uint64_t)snapshot->accesses * permille;
+  uint64_t seen = 0U;
+
+  if (snapshot->accesses == 0U) {
+    return 0U;
+  }
+  for (uint8_t b = 0U; b + 1U < KMESH_LBT_DELAY_BUCKETS; b++) {
+    seen += (uint64_t)snapshot->buckets[b] * KMESH_LBT_PERMILLE;
+    if (seen >= wanted) {
+      return ((KMESH_LBT_BUCKET_US << b) < snapshot->max_us)
+             ? (KMESH_LBT_BUCKET_US << b) : snapshot->max_us;
+    }
+  }
+  return snapshot->max_us;
+}
+
+RAIL_Status_t kmesh_lbt_start_benchmark(uint32_t count, uint16_t length, uint16_t period_ms)
+{
+  if (count == 0U || length > KMESH_FRAME_MAX_LENGTH - KMESH_FRAME_HEADER_LENGTH) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  for (uint16_t i = 0U; i < length; i++) {
+    bench_payload[i] = (uint8_t)i;
+  }
+  kmesh_lbt_reset_stats();
+  bench_count = count;
+  bench_sent = 0U;
+  bench_errors = 0U;
+  bench_length = length;
+  bench_period_us = (uint32_t)period_ms * KMESH_LBT_US_PER_MS;
+  bench_next = RAIL_GetTime();
+  benchmarking = true;
+  return RAIL_STATUS_NO_ERROR;
+}
+
+void kmesh_lbt_stop_benchmark(void)
+{
+  benchmarking = false;
+}
+
+bool kmesh_lbt_is_benchmarking(void)
+{
+  return benchmarking;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// The channel's entry, a new one at the fixed threshold if it had none.
+static kmesh_lbt_entry_t *claim_entry(uint16_t channel)
+{
+  bool claimed;
+  kmesh_lbt_entry_t *entry = kmesh_neighbor_claim(&table, channel, &claimed);
+
+  if (claimed) {
+    entry->channel.channel = channel;
+    entry->channel.noise_qdbm = RAIL_RSSI_INVALID;
+    entry->channel.min_bo_exp = KMESH_LBT_MIN_BO_EXP;
+    update_threshold(entry);
+  }
+  return entry;
+}
+
+// Noise floor plus margin once it rests on enough samples, else the fixed one.
+static void update_threshold(kmesh_lbt_entry_t *entry)
+{
+  int32_t threshold = threshold_dbm;
+
+  if (entry->channel.samples >= KMESH_LBT_MIN_SAMPLES) {
+    threshold = entry->channel.noise_qdbm / KMESH_LBT_QDBM_PER_DB + margin_db;
+  }
+  if (threshold < KMESH_LBT_MIN_THRESHOLD_DBM) {
+    threshold = KMESH_LBT_MIN_THRESHOLD_DBM;
+  }
+  if (threshold > KMESH_LBT_MAX_THRESHOLD_DBM) {
+    threshold = KMESH_LBT_MAX_THRESHOLD_DBM;
+  }
+  entry->channel.threshold_dbm = (int8_t)threshold;
+}
+
+// Only while searching: a frame being received is not noise.
+static void sample_noise(RAIL_Handle_t rail_handle)
+{
+  kmesh_lbt_entry_t *entry;
+  uint16_t channel;
+  int16_t rssi;
+  int16_t floor;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (RAIL_GetRadioStateDetailed(rail_handle) != RAIL_RF_STATE_DETAIL_RX
+      || RAIL_GetChannel(rail_handle, &channel) != RAIL_STATUS_NO_ERROR) {
+    return;
+  }
+  rssi = RAIL_GetRssi(rail_handle, false);
+  if (rssi == RAIL_RSSI_INVALID) {
+    return;
+  }
+  CORE_ENTER_ATOMIC();
+  entry = claim_entry(channel);
+  floor = entry->channel.noise_qdbm;
+  if (entry->channel.samples == 0U) {
+    floor = rssi;
+  } else if (rssi < floor) {
+    floor += (rssi - floor) / KMESH_LBT_FLOOR_DOWN_WEIGHT;
+  } else {
+    floor += (rssi - floor) / KMESH_LBT_FLOOR_UP_WEIGHT;
+  }
+  entry->channel.noise_qdbm = floor;
+  entry->channel.samples++;
+  update_threshold(entry);
+  CORE_EXIT_ATOMIC();
+}
+
+static void count_cca(bool busy)
+{
+  uint16_t *ratio = &tx_entry->channel.busy_permille;
+
+  if (busy) {
+    *ratio += (KMESH_LBT_PERMILLE - *ratio) >> KMESH_LBT_BUSY_SHIFT;
+  } else {
+    *ratio -= *ratio >> KMESH_LBT_BUSY_SHIFT;
+  }
+}
+
+static void adapt_backoff(void)
+{
+  kmesh_lbt_channel_t *channel = &tx_entry->channel;
+
+  if (mode != KMESH_LBT_ADAPTIVE) {
+    return;
+  }
+  if (channel->busy_permille > KMESH_LBT_BUSY_HIGH_PERMILLE
+      && channel->min_bo_exp < KMESH_LBT_MAX_BO_EXP) {
+    channel->min_bo_exp++;
+  } else if (channel->busy_permille < KMESH_LBT_BUSY_LOW_PERMILLE
+             && channel->min_bo_exp > KMESH_LBT_MIN_BO_EXP) {
+    channel->min_bo_exp--;
+  }
+}
+
+static void record_delay(uint32_t delay_us)
+{
+  uint8_t b = 0U;
+
+  while (b + 1U < KMESH_LBT_DELAY_BUCKETS && delay_us > (KMESH_LBT_BUCKET_US << b)) {
+    b++;
+  }
+  stats.buckets[b]++;
+  stats.accesses++;
+  stats.sum_us += delay_us;
+  if (delay_us < stats.min_us) {
+    stats.min_us = delay_us;
+  }
+  if (delay_us > stats.max_us) {
+    stats.max_us = delay_us;
+  }
+}
+
+static void run_benchmark(RAIL_Time_t now)
+{
+  kmesh_lbt_stats_t snapshot;
+
+  if (tx_pending) {
+    return;
+  }
+  if (bench_sent == bench_count) {
+    benchmarking = false;
+    kmesh_lbt_get_stats(&snapshot);
+    responsePrint("lbtBenchmark",
+                  "Status:Done,Sent:%lu,SendErrors:%lu,Accesses:%lu,Failures:%lu,"
+                  "BusyCcas:%lu,MinUs:%lu,MeanUs:%lu,P50Us:%lu,P90Us:%lu,P99Us:%lu,"
+                  "MaxUs:%lu",
+                  bench_sent, bench_errors, snapshot.accesses, snapshot.failures,
+                  snapshot.busy_ccas,
+                  (snapshot.accesses != 0U) ? snapshot.min_us : 0U,
+                  (snapshot.accesses != 0U)
+                  ? (uint32_t)(snapshot.sum_us / snapshot.accesses) : 0U,
+                  kmesh_lbt_percentile_us(&snapshot, 500U),
+                  kmesh_lbt_percentile_us(&snapshot, 900U),
+                  kmesh_lbt_percentile_us(&snapshot, 990U),
+                  snapshot.max_us);
+    return;
+  }
+  if ((int32_t)(now - bench_next) < 0) {
+    return;
+  }
+  bench_next = now + bench_period_us;
+  bench_sent++;
+  if (kmesh_send(KMESH_ADDRESS_BROADCAST, KMESH_FRAME_TYPE_DATA,
+                 bench_payload, bench_length) != RAIL_STATUS_NO_ERROR) {
+    bench_errors++;
+  }
+}
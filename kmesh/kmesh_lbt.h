@@ -0,0 +1,89 @@
+/***************************************************************************//**
+ * @file kmesh_lbt.h
+ * @brief Listen-before-talk for kmesh frames with a noise-tracking threshold.
+ ******************************************************************************/
+
+#ifndef KMESH_LBT_H
+#define KMESH_LBT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+// Access delay histogram: bucket b counts delays up to
+// KMESH_LBT_BUCKET_US << b, the last one everything longer.
+#define KMESH_LBT_BUCKET_US      250UL
+#define KMESH_LBT_DELAY_BUCKETS  10U
+
+typedef enum kmesh_lbt_mode {
+  // Transmit at once, as kmesh always did.
+  KMESH_LBT_OFF,
+  // CSMA with the configured threshold and backoff.
+  KMESH_LBT_FIXED,
+  // CSMA with the threshold a margin above the noise floor of the channel
+  // and the backoff following its busy ratio.
+  KMESH_LBT_ADAPTIVE,
+} kmesh_lbt_mode_t;
+
+typedef struct kmesh_lbt_channel {
+  uint16_t channel;
+  // Noise floor in quarter dBm and the idle RSSI samples behind it.
+  int16_t noise_qdbm;
+  uint32_t samples;
+  int8_t threshold_dbm;
+  // Weighted share of CCAs that found the channel busy, in per mille.
+  uint16_t busy_permille;
+  uint8_t min_bo_exp;
+} kmesh_lbt_channel_t;
+
+typedef struct kmesh_lbt_stats {
+  // Transmissions that got the channel, and those that gave up on CCA.
+  uint32_t accesses;
+  uint32_t failures;
+  uint32_t busy_ccas;
+  // Delay from the TX request to the start of transmission.
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  uint32_t buckets[KMESH_LBT_DELAY_BUCKETS];
+} kmesh_lbt_stats_t;
+
+// Called from kmesh_init() / kmesh_process_action().
+void kmesh_lbt_init(void);
+void kmesh_lbt_process_action(void);
+uint32_t kmesh_lbt_idle_us(RAIL_Time_t now);
+
+// Noise floor and busy ratio bookkeeping. Interrupt context.
+void kmesh_lbt_on_rail_event(RAIL_Events_t events);
+
+void kmesh_lbt_configure(kmesh_lbt_mode_t mode, uint8_t margin_db, int8_t threshold_dbm);
+kmesh_lbt_mode_t kmesh_lbt_get_mode(void);
+
+// Longest a transmission that gets the channel can wait in CSMA under the
+// present mode: every try backs off the whole window and CCAs. 0 when off.
+uint32_t kmesh_lbt_max_delay_us(void);
+uint8_t kmesh_lbt_get_margin_db(void);
+int8_t kmesh_lbt_get_threshold(void);
+
+// Start transmitting the TX FIFO on channel, through CSMA if cca is set and
+// the mode is not KMESH_LBT_OFF. Used for every kmesh transmission; ACKs
+// pass cca false, since the sender only waits a turnaround for them.
+RAIL_Status_t kmesh_lbt_start_tx(RAIL_Handle_t rail_handle, uint16_t channel, bool cca);
+
+// Copy out channel entry index; returns false past the last valid entry.
+bool kmesh_lbt_get_channel(uint8_t index, kmesh_lbt_channel_t *channel);
+
+void kmesh_lbt_get_stats(kmesh_lbt_stats_t *stats);
+void kmesh_lbt_reset_stats(void);
+// Upper bound of the bucket holding the given share of the delays, capped
+// at the longest delay seen; 0 without any.
+uint32_t kmesh_lbt_percentile_us(const kmesh_lbt_stats_t *stats, uint16_t permille);
+
+// Reset the statistics, then broadcast count data frames with a payload of
+// length bytes, each once the previous one is done and at least period_ms
+// after it started. Prints lbtBenchmark when the last one is done.
+RAIL_Status_t kmesh_lbt_start_benchmark(uint32_t count, uint16_t length, uint16_t period_ms);
+void kmesh_lbt_stop_benchmark(void);
+bool kmesh_lbt_is_benchmarking(void);
+
+#endif // KMESH_LBT_H
@@ -0,0 +1,91 @@
+/***************************************************************************//**
+ * @file kmesh_neighbor.c
+ * @brief Small keyed tables of per-neighbor or per-channel state.
+ *
+ * Transmit power control and rate adaptation keep state per neighbor, LBT per
+ * channel, each in a fixed table of a few entries. They share the lookup and
+ * the eviction here: a key that is not in the table takes a free entry, or
+ * else the one whose owner last claimed it longest ago, so a neighbor that
+ * still gives feedback is not pushed out by one heard once.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "kmesh_neighbor.h"
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static kmesh_neighbor_entry_t *entry_at(const kmesh_neighbor_table_t *table, uint8_t index);
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_neighbor_clear(const kmesh_neighbor_table_t *table)
+{
+  memset(table->entries, 0, table->entry_size * table->capacity);
+}
+
+void *kmesh_neighbor_find(const kmesh_neighbor_table_t *table, uint16_t key)
+{
+  for (uint8_t i = 0U; i < table->capacity; i++) {
+    kmesh_neighbor_entry_t *entry = entry_at(table, i);
+    if (entry->valid && entry->key == key) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+void *kmesh_neighbor_claim(const kmesh_neighbor_table_t *table, uint16_t key,
+                           bool *claimed)
+{
+  RAIL_Time_t now = RAIL_GetTime();
+  kmesh_neighbor_entry_t *entry = kmesh_neighbor_find(table, key);
+
+  *claimed = (entry == NULL);
+  if (*claimed) {
+    uint32_t oldest_age = 0U;
+    for (uint8_t i = 0U; i < table->capacity; i++) {
+      kmesh_neighbor_entry_t *candidate = entry_at(table, i);
+      uint32_t age = now - candidate->last_used;
+      if (!candidate->valid) {
+        entry = candidate;
+        break;
+      }
+      if (entry == NULL || age > oldest_age) {
+        entry = candidate;
+        oldest_age = age;
+      }
+    }
+    memset(entry, 0, table->entry_size);
+    entry->valid = true;
+    entry->key = key;
+  }
+  entry->last_used = now;
+  return entry;
+}
+
+void *kmesh_neighbor_get(const kmesh_neighbor_table_t *table, uint8_t index)
+{
+  uint8_t found = 0U;
+
+  for (uint8_t i = 0U; i < table->capacity; i++) {
+    kmesh_neighbor_entry_t *entry = entry_at(table, i);
+    if (entry->valid && found++ == index) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static kmesh_neighbor_entry_t *entry_at(const kmesh_neighbor_table_t *table, uint8_t index)
+{
+  return (kmesh_neighbor_entry_t *)((uint8_t *)table->entries
+                                    + (size_t)index * table->entry_size);
+}
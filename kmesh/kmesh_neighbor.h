@@ -0,0 +1,49 @@
+/***************************************************************************//**
+ * @file kmesh_neighbor.h
+ * @brief Small keyed tables of per-neighbor or per-channel state.
+ ******************************************************************************/
+
+#ifndef KMESH_NEIGHBOR_H
+#define KMESH_NEIGHBOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rail.h"
+
+// First member of every table entry.
+typedef struct kmesh_neighbor_entry {
+  bool valid;
+  // Neighbor address or channel the entry belongs to.
+  uint16_t key;
+  // Last time the entry was claimed, for eviction.
+  RAIL_Time_t last_used;
+} kmesh_neighbor_entry_t;
+
+// A module's static array of entries, each starting with a
+// kmesh_neighbor_entry_t.
+typedef struct kmesh_neighbor_table {
+  void *entries;
+  size_t entry_size;
+  uint8_t capacity;
+} kmesh_neighbor_table_t;
+
+#define KMESH_NEIGHBOR_TABLE(array) \
+  { (array), sizeof((array)[0]), (uint8_t)(sizeof(array) / sizeof((array)[0])) }
+
+// None of these lock; callers that share a table with interrupt context call
+// them inside their own atomic section.
+void kmesh_neighbor_clear(const kmesh_neighbor_table_t *table);
+
+// The valid entry for key, or NULL.
+void *kmesh_neighbor_find(const kmesh_neighbor_table_t *table, uint16_t key);
+
+// The entry for key, else a free one or the one claimed longest ago, zeroed
+// and keyed; *claimed tells the caller to initialise it. Marks it used now.
+void *kmesh_neighbor_claim(const kmesh_neighbor_table_t *table, uint16_t key,
+                           bool *claimed);
+
+// The index-th valid entry in table order, or NULL past the last one.
+void *kmesh_neighbor_get(const kmesh_neighbor_table_t *table, uint8_t index);
+
+#endif // KMESH_NEIGHBOR_H
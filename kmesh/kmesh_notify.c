@@ -0,0 +1,254 @@
+/***************************************************************************//**
+ * @file kmesh_notify.c
+ * @brief Periodic RX/TX summaries and a rate limit for per-packet prints.
+ *
+ * RAILtest can only print every packet or none (setPrintingEnable,
+ * setNotifications). For long runs turn those off and let this module print
+ * one notifySummary line per interval: packet counts, an error breakdown and
+ * RSSI min/avg/max, accumulated in the RAIL event handler at the cost of a
+ * few increments per event.
+ *
+ * Per-packet prints of our own go through a token bucket: on average
+ * per_second of them, with bursts of up to burst, the rest counted as
+ * suppressed and reported in the summary.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "sl_core.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_idle.h"
+#include "kmesh_notify.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_NOTIFY_US_PER_MS       1000UL
+// Tokens are kept in millitokens so slow rates still refill smoothly.
+#define KMESH_NOTIFY_TOKEN           1000UL
+
+typedef struct kmesh_notify_summary {
+  uint32_t rx_ok;
+  uint32_t rx_frame_error;
+  uint32_t rx_aborted;
+  uint32_t rx_overflow;
+  uint32_t rx_filtered;
+  uint32_t tx_ok;
+  uint32_t tx_aborted;
+  uint32_t tx_blocked;
+  uint32_t tx_underflow;
+  uint32_t tx_channel_busy;
+  int32_t rssi_sum;
+  uint32_t rssi_count;
+  int8_t rssi_min;
+  int8_t rssi_max;
+} kmesh_notify_summary_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void print_summary(const kmesh_notify_summary_t *summary, uint32_t elapsed_ms);
+static void refill(void);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static kmesh_notify_summary_t summary;
+static uint32_t summary_interval_ms;
+static RAIL_Time_t summary_start;
+
+static uint16_t rate = KMESH_NOTIFY_RATE_PER_SECOND;
+static uint16_t burst = KMESH_NOTIFY_BURST;
+static uint32_t tokens;
+static RAIL_Time_t last_refill;
+static uint32_t suppressed;
+static uint32_t suppressed_reported;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_notify_init(void)
+{
+  kmesh_notify_configure_rate(rate, burst);
+  kmesh_notify_configure_summary(0U);
+}
+
+void kmesh_notify_process_action(void)
+{
+  kmesh_notify_summary_t snapshot;
+  RAIL_Time_t now;
+  uint32_t elapsed_us;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (summary_interval_ms == 0U) {
+    return;
+  }
+  now = RAIL_GetTime();
+  elapsed_us = now - summary_start;
+  if (elapsed_us < summary_interval_ms * KMESH_NOTIFY_US_PER_MS) {
+    return;
+  }
+  CORE_ENTER_ATOMIC();
+  snapshot = summary;
+  memset(&summary, 0, sizeof(summary));
+  CORE_EXIT_ATOMIC();
+  summary_start = now;
+  print_summary(&snapshot, elapsed_us / KMESH_NOTIFY_US_PER_MS);
+}
+
+uint32_t kmesh_notify_idle_us(RAIL_Time_t now)
+{
+  uint32_t elapsed_us = now - summary_start;
+  uint32_t interval_us = summary_interval_ms * KMESH_NOTIFY_US_PER_MS;
+
+  if (summary_interval_ms == 0U) {
+    return KMESH_IDLE_FOREVER;
+  }
+  return (elapsed_us < interval_us) ? interval_us - elapsed_us : 0U;
+}
+
+void kmesh_notify_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events)
+{
+  if (summary_interval_ms == 0U) {
+    return;
+  }
+  if ((events & RAIL_EVENT_RX_PACKET_RECEIVED) != 0U) {
+    RAIL_RxPacketInfo_t info;
+    RAIL_RxPacketDetails_t details;
+    RAIL_RxPacketHandle_t packet
+      = RAIL_GetRxPacketInfo(rail_handle, RAIL_RX_PACKET_HANDLE_NEWEST, &info);
+
+    summary.rx_ok++;
+    // The Alt variant skips the timestamp conversion we have no use for.
+    if (packet != RAIL_RX_PACKET_HANDLE_INVALID
+        && RAIL_GetRxPacketDetailsAlt(rail_handle, packet, &details)
+        == RAIL_STATUS_NO_ERROR) {
+      if (summary.rssi_count == 0U || details.rssi < summary.rssi_min) {
+        summary.rssi_min = details.rssi;
+      }
+      if (summary.rssi_count == 0U || details.rssi > summary.rssi_max) {
+        summary.rssi_max = details.rssi;
+      }
+      summary.rssi_sum += details.rssi;
+      summary.rssi_count++;
+    }
+  }
+  summary.rx_frame_error += ((events & RAIL_EVENT_RX_FRAME_ERROR) != 0U) ? 1U : 0U;
+  summary.rx_aborted += ((events & RAIL_EVENT_RX_PACKET_ABORTED) != 0U) ? 1U : 0U;
+  summary.rx_overflow += ((events & RAIL_EVENT_RX_FIFO_OVERFLOW) != 0U) ? 1U : 0U;
+  summary.rx_filtered += ((events & RAIL_EVENT_RX_ADDRESS_FILTERED) != 0U) ? 1U : 0U;
+  summary.tx_ok += ((events & RAIL_EVENT_TX_PACKET_SENT) != 0U) ? 1U : 0U;
+  summary.tx_aborted += ((events & RAIL_EVENT_TX_ABORTED) != 0U) ? 1U : 0U;
+  summary.tx_blocked += ((events & RAIL_EVENT_TX_BLOCKED) != 0U) ? 1U : 0U;
+  summary.tx_underflow += ((events & RAIL_EVENT_TX_UNDERFLOW) != 0U) ? 1U : 0U;
+  summary.tx_channel_busy += ((events & RAIL_EVENT_TX_CHANNEL_BUSY) != 0U) ? 1U : 0U;
+}
+
+void kmesh_notify_configure_summary(uint32_t interval_ms)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  if (interval_ms > KMESH_NOTIFY_SUMMARY_INTERVAL_MAX_MS) {
+    interval_ms = KMESH_NOTIFY_SUMMARY_INTERVAL_MAX_MS;
+  }
+  CORE_ENTER_ATOMIC();
+  memset(&summary, 0, sizeof(summary));
+  summary_interval_ms = interval_ms;
+  summary_start = RAIL_GetTime();
+  CORE_EXIT_ATOMIC();
+}
+
+uint32_t kmesh_notify_get_summary_interval(void)
+{
+  return summary_interval_ms;
+}
+
+void kmesh_notify_configure_rate(uint16_t per_second, uint16_t max_burst)
+{
+  rate = per_second;
+  burst = (max_burst == 0U) ? 1U : max_burst;
+  tokens = (uint32_t)burst * KMESH_NOTIFY_TOKEN;
+  last_refill = RAIL_GetTime();
+}
+
+uint16_t kmesh_notify_get_rate(void)
+{
+  return rate;
+}
+
+uint16_t kmesh_notify_get_burst(void)
+{
+  return burst;
+}
+
+bool kmesh_notify_take(void)
+{
+  if (rate == 0U) {
+    return true;
+  }
+  refill();
+  if (tokens < KMESH_NOTIFY_TOKEN) {
+    suppressed++;
+    return false;
+  }
+  tokens -= KMESH_NOTIFY_TOKEN;
+  return true;
+}
+
+uint32_t kmesh_notify_get_suppressed(void)
+{
+  return suppressed;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static void print_summary(const kmesh_notify_summary_t *snapshot, uint32_t elapsed_ms)
+{
+  char rssi[32] = "RssiMin:-,RssiAvg:-,RssiMax:-";
+
+  if (snapshot->rssi_count != 0U) {
+    (void) snprintf(rssi, sizeof(rssi), "RssiMin:%d,RssiAvg:%ld,RssiMax:%d",
+                    snapshot->rssi_min,
+                    (long)(snapshot->rssi_sum / (int32_t)snapshot->rssi_count),
+                    snapshot->rssi_max);
+  }
+  responsePrint("notifySummary",
+                "IntervalMs:%lu,RxOk:%lu,RxFrameError:%lu,RxAborted:%lu,"
+                "RxOverflow:%lu,RxFiltered:%lu,%s,TxOk:%lu,TxAborted:%lu,"
+                "TxBlocked:%lu,TxUnderflow:%lu,TxChannelBusy:%lu,Suppressed:%lu",
+                elapsed_ms,
+                snapshot->rx_ok,
+                snapshot->rx_frame_error,
+                snapshot->rx_aborted,
+                snapshot->rx_overflow,
+                snapshot->rx_filtered,
+                rssi,
+                snapshot->tx_ok,
+                snapshot->tx_aborted,
+                snapshot->tx_blocked,
+                snapshot->tx_underflow,
+                snapshot->tx_channel_busy,
+                suppressed - suppressed_reported);
+  suppressed_reported = suppressed;
+}
+
+static void refill(void)
+{
+  RAIL_Time_t now = RAIL_GetTime();
+  uint32_t elapsed_us = now - last_refill;
+  uint32_t limit = (uint32_t)burst * KMESH_NOTIFY_TOKEN;
+  // rate * 1000 millitokens per second is rate millitokens per millisecond.
+  uint32_t earned = (elapsed_us / KMESH_NOTIFY_US_PER_MS) * rate;
+
+  if (earned == 0U) {
+    return;
+  }
+  // Only advance by the whole milliseconds that earned tokens.
+  last_refill += (elapsed_us / KMESH_NOTIFY_US_PER_MS) * KMESH_NOTIFY_US_PER_MS;
+  tokens = (earned >= limit || tokens >= limit - earned) ? limit : tokens + earned;
+}
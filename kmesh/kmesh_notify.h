@@ -0,0 +1,45 @@
+/***************************************************************************//**
+ * @file kmesh_notify.h
+ * @brief Periodic RX/TX summaries and a rate limit for per-packet prints.
+ ******************************************************************************/
+
+#ifndef KMESH_NOTIFY_H
+#define KMESH_NOTIFY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+// Longest summary interval; the elapsed time is measured in 32-bit
+// microseconds of RAIL time, which wraps after about 71 minutes.
+#define KMESH_NOTIFY_SUMMARY_INTERVAL_MAX_MS  (UINT32_MAX / 1000UL)
+
+void kmesh_notify_init(void);
+
+// Prints the summary when its interval has passed. Called from
+// kmesh_process_action().
+void kmesh_notify_process_action(void);
+
+// Microseconds until the next summary is due, or KMESH_IDLE_FOREVER.
+uint32_t kmesh_notify_idle_us(RAIL_Time_t now);
+
+// Counts events for the summary. Interrupt context.
+void kmesh_notify_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events);
+
+// Print a notifySummary line every interval_ms, 0 to stop. Longer intervals
+// are clamped to KMESH_NOTIFY_SUMMARY_INTERVAL_MAX_MS.
+void kmesh_notify_configure_summary(uint32_t interval_ms);
+uint32_t kmesh_notify_get_summary_interval(void);
+
+// Allow per_second per-packet prints on average with bursts of up to burst,
+// per_second 0 meaning unlimited.
+void kmesh_notify_configure_rate(uint16_t per_second, uint16_t burst);
+uint16_t kmesh_notify_get_rate(void);
+uint16_t kmesh_notify_get_burst(void);
+
+// Take a token for one per-packet print. Returns false, counting the print
+// as suppressed, if the caller should skip it. Main loop only.
+bool kmesh_notify_take(void);
+uint32_t kmesh_notify_get_suppressed(void);
+
+#endif // KMESH_NOTIFY_H
@@ -0,0 +1,193 @@
+/***************************************************************************//**
+ * @file kmesh_power.c
+ * @brief Duty-cycled listening and energy mode residency.
+ *
+ * A relay on a battery cannot keep its receiver on. In listen mode RAIL's RX
+ * duty cycling opens a receive window, closes it again after on_us unless a
+ * packet is being received (RAIL_EVENT_RX_DUTY_CYCLE_RX_END), and reopens it
+ * off_us later from its own timer. With the RAIL power manager integration
+ * RAIL holds EM1 only while the radio is busy, so between windows
+ * sl_power_manager_sleep() in the main loop can reach EM2, and the RAIL
+ * timer, synchronised to the sleeptimer, wakes the chip for the next window.
+ *
+ * Residency is measured from the power manager's transition events on the
+ * sleeptimer, which keeps counting in EM2. Average current is then the
+ * per-mode currents weighted by the residency.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "sl_power_manager.h"
+#include "sl_sleeptimer.h"
+#include "kmesh.h"
+#include "kmesh_power.h"
+#include "kmesh_rate.h"
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void on_em_transition(sl_power_manager_em_t from, sl_power_manager_em_t to);
+static kmesh_power_mode_t mode_of(sl_power_manager_em_t em);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static sl_power_manager_em_transition_event_handle_t em_transition_handle;
+static const sl_power_manager_em_transition_event_info_t em_transition_info = {
+  .event_mask = SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM0
+                | SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM1
+                | SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM2
+                | SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM3,
+  .on_event = on_em_transition,
+};
+
+static kmesh_power_residency_t residency;
+static kmesh_power_mode_t current_mode = KMESH_POWER_EM0;
+static uint64_t mode_since;
+
+static bool listening;
+static uint32_t listen_on_us = KMESH_POWER_LISTEN_ON_US;
+static uint32_t listen_off_us = KMESH_POWER_LISTEN_OFF_US;
+static bool listen_preamble_sense;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_power_init(void)
+{
+  mode_since = sl_sleeptimer_get_tick_count64();
+  sl_power_manager_subscribe_em_transition_event(&em_transition_handle,
+                                                 &em_transition_info);
+  // Without it the RAIL timer stops in EM2 and the next window never opens.
+  (void) RAIL_ConfigSleep(kmesh_get_rail_handle(), RAIL_SLEEP_CONFIG_TIMERSYNC_ENABLED);
+}
+
+void kmesh_power_on_rail_event(RAIL_Events_t events)
+{
+  if (!listening) {
+    return;
+  }
+  if ((events & RAIL_EVENT_RX_DUTY_CYCLE_RX_END) != 0U) {
+    residency.listen_windows++;
+  }
+  if ((events & RAIL_EVENT_RX_PACKET_RECEIVED) != 0U) {
+    residency.listen_packets++;
+  }
+}
+
+RAIL_Status_t kmesh_power_configure_listen(bool enable, uint32_t on_us,
+                                           uint32_t off_us, bool preamble_sense)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  RAIL_RxDutyCycleConfig_t config = {
+    .mode = preamble_sense ? RAIL_RX_CHANNEL_HOPPING_MODE_PREAMBLE_SENSE
+            : RAIL_RX_CHANNEL_HOPPING_MODE_TIMEOUT,
+    .parameter = on_us,
+    .delay = off_us,
+    .delayMode = RAIL_RX_CHANNEL_HOPPING_DELAY_MODE_STATIC,
+    .options = RAIL_RX_CHANNEL_HOPPING_OPTIONS_DEFAULT,
+  };
+  RAIL_Status_t status;
+  uint16_t channel;
+
+  // Both run on the RX channel hopping engine.
+  if (enable && kmesh_rate_is_scanning()) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  status = RAIL_GetChannel(rail_handle, &channel);
+  if (status != RAIL_STATUS_NO_ERROR) {
+    return status;
+  }
+  RAIL_Idle(rail_handle, RAIL_IDLE, true);
+  if (enable) {
+    status = RAIL_ConfigRxDutyCycle(rail_handle, &config);
+    if (status != RAIL_STATUS_NO_ERROR) {
+      (void) RAIL_StartRx(rail_handle, channel, NULL);
+      return status;
+    }
+    listen_on_us = on_us;
+    listen_off_us = off_us;
+    listen_preamble_sense = preamble_sense;
+  }
+  (void) RAIL_ConfigEvents(rail_handle, RAIL_EVENT_RX_DUTY_CYCLE_RX_END,
+                           enable ? RAIL_EVENT_RX_DUTY_CYCLE_RX_END : 0U);
+  (void) RAIL_EnableRxDutyCycle(rail_handle, enable);
+  listening = enable;
+  return RAIL_StartRx(rail_handle, channel, NULL);
+}
+
+bool kmesh_power_is_listening(void)
+{
+  return listening;
+}
+
+uint32_t kmesh_power_get_listen_on_us(void)
+{
+  return listen_on_us;
+}
+
+uint32_t kmesh_power_get_listen_off_us(void)
+{
+  return listen_off_us;
+}
+
+bool kmesh_power_get_listen_preamble_sense(void)
+{
+  return listen_preamble_sense;
+}
+
+void kmesh_power_get_residency(kmesh_power_residency_t *result)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  *result = residency;
+  result->ticks[current_mode] += sl_sleeptimer_get_tick_count64() - mode_since;
+  CORE_EXIT_ATOMIC();
+}
+
+void kmesh_power_reset_residency(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  memset(&residency, 0, sizeof(residency));
+  mode_since = sl_sleeptimer_get_tick_count64();
+  CORE_EXIT_ATOMIC();
+}
+
+uint32_t kmesh_power_ticks_to_ms(uint64_t ticks)
+{
+  return (uint32_t)((ticks * 1000U) / sl_sleeptimer_get_timer_frequency());
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Called by the power manager with interrupts off.
+static void on_em_transition(sl_power_manager_em_t from, sl_power_manager_em_t to)
+{
+  uint64_t now = sl_sleeptimer_get_tick_count64();
+
+  residency.ticks[mode_of(from)] += now - mode_since;
+  mode_since = now;
+  current_mode = mode_of(to);
+  if (current_mode == KMESH_POWER_EM2) {
+    residency.em2_entries++;
+  }
+}
+
+static kmesh_power_mode_t mode_of(sl_power_manager_em_t em)
+{
+  switch (em) {
+    case SL_POWER_MANAGER_EM0:
+      return KMESH_POWER_EM0;
+    case SL_POWER_MANAGER_EM1:
+      return KMESH_POWER_EM1;
+    default:
+      return KMESH_POWER_EM2;
+  }
+}
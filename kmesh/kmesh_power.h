@@ -0,0 +1,55 @@
+/***************************************************************************//**
+ * @file kmesh_power.h
+ * @brief Duty-cycled listening and energy mode residency.
+ ******************************************************************************/
+
+#ifndef KMESH_POWER_H
+#define KMESH_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+typedef enum kmesh_power_mode {
+  KMESH_POWER_EM0,
+  KMESH_POWER_EM1,
+  KMESH_POWER_EM2,
+  KMESH_POWER_MODES
+} kmesh_power_mode_t;
+
+typedef struct kmesh_power_residency {
+  // Sleeptimer ticks spent in each mode since the last reset. EM3 counts as
+  // EM2.
+  uint64_t ticks[KMESH_POWER_MODES];
+  uint32_t em2_entries;
+  // RX windows that closed without a packet, and packets received, while
+  // listening.
+  uint32_t listen_windows;
+  uint32_t listen_packets;
+} kmesh_power_residency_t;
+
+// Subscribes to energy mode transitions and keeps the RAIL timer running
+// across EM2. Called from kmesh_init().
+void kmesh_power_init(void);
+
+// Counts listen windows and packets. Interrupt context.
+void kmesh_power_on_rail_event(RAIL_Events_t events);
+
+// Listen for on_us, then sleep for off_us, repeatedly on the current
+// channel; with preamble_sense a window stays open while a preamble is
+// heard. Disabling goes back to continuous receive. RAIL_STATUS_INVALID_STATE
+// while rate adaptation scans.
+RAIL_Status_t kmesh_power_configure_listen(bool enable, uint32_t on_us,
+                                           uint32_t off_us, bool preamble_sense);
+bool kmesh_power_is_listening(void);
+uint32_t kmesh_power_get_listen_on_us(void);
+uint32_t kmesh_power_get_listen_off_us(void);
+bool kmesh_power_get_listen_preamble_sense(void);
+
+// Residency up to now, the current mode included.
+void kmesh_power_get_residency(kmesh_power_residency_t *residency);
+void kmesh_power_reset_residency(void);
+
+uint32_t kmesh_power_ticks_to_ms(uint64_t ticks);
+
+#endif // KMESH_POWER_H
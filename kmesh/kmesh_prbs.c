@@ -0,0 +1,470 @@
+/***************************************************************************//**
+ * @file kmesh_prbs.c
+ * @brief Pseudo-random test traffic: generator on TX, checker on RX.
+ *
+ * setTxRandom and setTxPayload fix the payload before a test. Here the
+ * payload is generated on the device, as one of the PRBS9/15/23 sequences,
+ * a word counter or a byte counter, and the generator runs on from frame to
+ * frame so no two frames carry the same bytes.
+ *
+ * A frame is a kmesh header of type PRBS, the pattern and the generator
+ * state at the start of the payload, then generated bytes. Only what fits
+ * goes into the TX FIFO when the frame starts; the rest is generated into
+ * it in chunks each time the FIFO drops below KMESH_PRBS_TX_THRESHOLD, so
+ * frames can be longer than the FIFO, up to the 11-bit length limit. The
+ * next frame starts from the TX completion interrupt of the one before. A
+ * frame is not started while another transmission is on the air, since
+ * loading it resets the TX FIFO; the run resumes from that transmission's
+ * completion.
+ *
+ * The checker seeds its own generator from the state in each frame and
+ * compares the frame in the RX FIFO byte by byte from the RX interrupt,
+ * before RAILtest sees it. Counting bit errors needs frames that failed
+ * CRC, which RAIL only hands over with RAIL_RX_OPTION_IGNORE_CRC_ERRORS.
+ * The frame has to fit in the RX FIFO as a whole.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_batch.h"
+#include "kmesh_prbs.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_PRBS_FRAME_HEADER  (KMESH_FRAME_HEADER_LENGTH + KMESH_PRBS_HEADER_LENGTH)
+// Bytes generated on the stack per TX FIFO write.
+#define KMESH_PRBS_CHUNK         64U
+// Frames in a row that may fail to start before the run gives up.
+#define KMESH_PRBS_MAX_FAILURES  4U
+#define KMESH_PRBS_US_PER_S      1000000ULL
+
+typedef struct kmesh_prbs_gen {
+  kmesh_prbs_pattern_t pattern;
+  uint32_t state;
+  // Byte of the current counter word.
+  uint8_t phase;
+} kmesh_prbs_gen_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void gen_seed(kmesh_prbs_gen_t *gen, kmesh_prbs_pattern_t pattern);
+static uint8_t gen_byte(kmesh_prbs_gen_t *gen);
+static RAIL_Status_t start_frame(RAIL_Handle_t rail_handle);
+static void fill_fifo(RAIL_Handle_t rail_handle);
+static void start_next(void);
+static void on_tx_done(RAIL_Events_t events);
+static void finish(void);
+static void check_frame(RAIL_Handle_t rail_handle);
+static void log_error(uint16_t offset, uint8_t expected, uint8_t received);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_prbs_tx_counters_t kmesh_prbs_tx_counters;
+kmesh_prbs_rx_counters_t kmesh_prbs_rx_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+// Register length and second tap of the LFSR patterns, in pattern order.
+static const uint8_t lfsr_length[] = { 9U, 15U, 23U };
+static const uint8_t lfsr_tap[] = { 5U, 14U, 18U };
+
+static kmesh_prbs_gen_t tx_gen;
+static uint16_t tx_length;
+static uint16_t tx_channel;
+static uint32_t tx_limit;
+static uint32_t tx_started;
+// Bytes of the current frame not yet in the TX FIFO.
+static uint16_t tx_remaining;
+static uint8_t tx_sequence;
+static uint8_t failures_in_row;
+static uint16_t saved_threshold;
+static RAIL_Time_t run_start;
+static volatile bool running;
+static volatile bool stopping;
+static volatile bool done;
+static bool tx_pending;
+// Waiting for someone else's transmission to complete.
+static bool deferred;
+
+static bool rx_enabled;
+static bool rx_have_sequence;
+static uint8_t rx_next_sequence;
+static kmesh_prbs_error_t errors[KMESH_PRBS_ERROR_LOG];
+static uint8_t error_count;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+RAIL_Status_t kmesh_prbs_tx_start(kmesh_prbs_pattern_t pattern, uint16_t length,
+                                  uint16_t channel, uint32_t count)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  CORE_DECLARE_IRQ_STATE;
+
+  if (pattern >= KMESH_PRBS_PATTERN_COUNT
+      || length <= KMESH_PRBS_FRAME_HEADER || length > KMESH_FRAME_LENGTH_LIMIT) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  if (running || kmesh_batch_is_running()) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  CORE_ENTER_ATOMIC();
+  memset(&kmesh_prbs_tx_counters, 0, sizeof(kmesh_prbs_tx_counters));
+  gen_seed(&tx_gen, pattern);
+  tx_length = length;
+  tx_channel = channel;
+  tx_limit = count;
+  tx_started = 0U;
+  failures_in_row = 0U;
+  deferred = false;
+  saved_threshold = RAIL_GetTxFifoThreshold(rail_handle);
+  (void) RAIL_SetTxFifoThreshold(rail_handle, KMESH_PRBS_TX_THRESHOLD);
+  stopping = false;
+  done = false;
+  running = true;
+  run_start = RAIL_GetTime();
+  start_next();
+  CORE_EXIT_ATOMIC();
+  return running ? RAIL_STATUS_NO_ERROR : RAIL_STATUS_INVALID_STATE;
+}
+
+// A frame already on its way is still completed.
+void kmesh_prbs_tx_stop(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (running) {
+    stopping = true;
+    if (!tx_pending) {
+      finish();
+    }
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_prbs_tx_is_running(void)
+{
+  return running;
+}
+
+void kmesh_prbs_rx_enable(bool enable)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  memset(&kmesh_prbs_rx_counters, 0, sizeof(kmesh_prbs_rx_counters));
+  error_count = 0U;
+  rx_have_sequence = false;
+  rx_enabled = enable;
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_prbs_rx_is_enabled(void)
+{
+  return rx_enabled;
+}
+
+void kmesh_prbs_rx_get_counters(kmesh_prbs_rx_counters_t *counters)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  *counters = kmesh_prbs_rx_counters;
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_prbs_rx_get_error(uint8_t index, kmesh_prbs_error_t *error)
+{
+  if (index >= error_count) {
+    return false;
+  }
+  *error = errors[index];
+  return true;
+}
+
+void kmesh_prbs_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events)
+{
+  if (running && deferred && (events & RAIL_EVENTS_TX_COMPLETION) != 0U) {
+    deferred = false;
+    if (stopping) {
+      finish();
+    } else {
+      start_next();
+    }
+  } else if (running && tx_pending) {
+    if ((events & RAIL_EVENT_TX_FIFO_ALMOST_EMPTY) != 0U && tx_remaining != 0U) {
+      kmesh_prbs_tx_counters.refills++;
+      fill_fifo(rail_handle);
+    }
+    if ((events & RAIL_EVENTS_TX_COMPLETION) != 0U) {
+      on_tx_done(events);
+    }
+  }
+  if (rx_enabled && (events & RAIL_EVENT_RX_PACKET_RECEIVED) != 0U) {
+    check_frame(rail_handle);
+  }
+}
+
+void kmesh_prbs_process_action(void)
+{
+  kmesh_prbs_tx_counters_t snapshot;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!done) {
+    return;
+  }
+  CORE_ENTER_ATOMIC();
+  done = false;
+  snapshot = kmesh_prbs_tx_counters;
+  CORE_EXIT_ATOMIC();
+  responsePrint("prbsTxDone",
+                "Sent:%lu,Errors:%lu,Underflows:%lu,Refills:%lu,Deferred:%lu,Bytes:%lu,"
+                "ElapsedUs:%lu,Bps:%lu",
+                snapshot.sent, snapshot.errors, snapshot.underflows, snapshot.refills,
+                snapshot.deferred,
+                snapshot.bytes, snapshot.elapsed_us,
+                (snapshot.elapsed_us != 0U)
+                ? (uint32_t)((uint64_t)snapshot.bytes * 8U * KMESH_PRBS_US_PER_S
+                             / snapshot.elapsed_us) : 0U);
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// LFSR registers start all ones, the counters at zero.
+static void gen_seed(kmesh_prbs_gen_t *gen, kmesh_prbs_pattern_t pattern)
+{
+  gen->pattern = pattern;
+  gen->phase = 0U;
+  gen->state = (pattern < KMESH_PRBS_PATTERN_COUNTER)
+               ? ((1UL << lfsr_length[pattern]) - 1U) : 0U;
+}
+
+// LFSR bits go out first bit first, as the PHY sends them.
+static uint8_t gen_byte(kmesh_prbs_gen_t *gen)
+{
+  uint8_t byte = 0U;
+  uint32_t bit;
+  uint8_t length;
+  uint8_t tap;
+
+  switch (gen->pattern) {
+    case KMESH_PRBS_PATTERN_COUNTER:
+      byte = (uint8_t)(gen->state >> (24U - 8U * gen->phase));
+      if (++gen->phase == 4U) {
+        gen->phase = 0U;
+        gen->state++;
+      }
+      return byte;
+    case KMESH_PRBS_PATTERN_INCREMENT:
+      return (uint8_t)gen->state++;
+    default:
+      length = lfsr_length[gen->pattern];
+      tap = lfsr_tap[gen->pattern];
+      for (uint8_t i = 0U; i < 8U; i++) {
+        bit = ((gen->state >> (length - 1U)) ^ (gen->state >> (tap - 1U))) & 1U;
+        gen->state = ((gen->state << 1) | bit) & ((1UL << length) - 1U);
+        byte = (uint8_t)((byte << 1) | bit);
+      }
+      return byte;
+  }
+}
+
+static RAIL_Status_t start_frame(RAIL_Handle_t rail_handle)
+{
+  uint8_t raw[KMESH_PRBS_FRAME_HEADER];
+  kmesh_frame_header_t header = {
+    .length = tx_length,
+    .type = KMESH_FRAME_TYPE_PRBS,
+    .flags = 0U,
+    .sequence = tx_sequence,
+    .destination = KMESH_ADDRESS_BROADCAST,
+    .source = kmesh_get_address(),
+    .next_hop = KMESH_ADDRESS_BROADCAST,
+    .hop_limit = 0U,
+  };
+
+  // Counter frames start on a word boundary.
+  if (tx_gen.phase != 0U) {
+    tx_gen.phase = 0U;
+    tx_gen.state++;
+  }
+  (void) kmesh_frame_encode_header(raw, &header);
+  raw[KMESH_FRAME_HEADER_LENGTH + KMESH_PRBS_OFFSET_PATTERN] = (uint8_t)tx_gen.pattern;
+  kmesh_frame_put_u16(raw, KMESH_FRAME_HEADER_LENGTH + KMESH_PRBS_OFFSET_STATE,
+                      (uint16_t)(tx_gen.state >> 16));
+  kmesh_frame_put_u16(raw, KMESH_FRAME_HEADER_LENGTH + KMESH_PRBS_OFFSET_STATE + 2U,
+                      (uint16_t)tx_gen.state);
+  if (RAIL_WriteTxFifo(rail_handle, raw, sizeof(raw), true) != sizeof(raw)) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  tx_remaining = tx_length - sizeof(raw);
+  fill_fifo(rail_handle);
+  return RAIL_StartTx(rail_handle, tx_channel, RAIL_TX_OPTIONS_DEFAULT, NULL);
+}
+
+// Generate as much of the frame as the TX FIFO has room for.
+static void fill_fifo(RAIL_Handle_t rail_handle)
+{
+  uint8_t chunk[KMESH_PRBS_CHUNK];
+  uint16_t space = RAIL_GetTxFifoSpaceAvailable(rail_handle);
+  uint16_t length;
+
+  while (tx_remaining != 0U && space != 0U) {
+    length = (tx_remaining < space) ? tx_remaining : space;
+    if (length > sizeof(chunk)) {
+      length = sizeof(chunk);
+    }
+    for (uint16_t i = 0U; i < length; i++) {
+      chunk[i] = gen_byte(&tx_gen);
+    }
+    (void) RAIL_WriteTxFifo(rail_handle, chunk, length, false);
+    tx_remaining -= length;
+    space -= length;
+  }
+}
+
+// Start frames until one is on its way, the count is reached, or
+// KMESH_PRBS_MAX_FAILURES of them failed to start in a row.
+static void start_next(void)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+
+  while (running && (tx_limit == 0U || tx_started < tx_limit)) {
+    if ((RAIL_GetRadioState(rail_handle) & RAIL_RF_STATE_TX) == RAIL_RF_STATE_TX) {
+      kmesh_prbs_tx_counters.deferred++;
+      deferred = true;
+      return;
+    }
+    tx_started++;
+    if (start_frame(rail_handle) == RAIL_STATUS_NO_ERROR) {
+      tx_sequence++;
+      failures_in_row = 0U;
+      tx_pending = true;
+      return;
+    }
+    kmesh_prbs_tx_counters.errors++;
+    if (++failures_in_row >= KMESH_PRBS_MAX_FAILURES) {
+      break;
+    }
+  }
+  finish();
+}
+
+static void on_tx_done(RAIL_Events_t events)
+{
+  tx_pending = false;
+  if ((events & RAIL_EVENT_TX_PACKET_SENT) != 0U) {
+    kmesh_prbs_tx_counters.sent++;
+    kmesh_prbs_tx_counters.bytes += tx_length;
+  } else {
+    kmesh_prbs_tx_counters.errors++;
+    if ((events & RAIL_EVENT_TX_UNDERFLOW) != 0U) {
+      kmesh_prbs_tx_counters.underflows++;
+    }
+  }
+  kmesh_prbs_tx_counters.elapsed_us = RAIL_GetTime() - run_start;
+  if (stopping) {
+    finish();
+    return;
+  }
+  start_next();
+}
+
+static void finish(void)
+{
+  running = false;
+  stopping = false;
+  tx_pending = false;
+  deferred = false;
+  tx_remaining = 0U;
+  (void) RAIL_SetTxFifoThreshold(kmesh_get_rail_handle(), saved_threshold);
+  done = true;
+}
+
+static void check_frame(RAIL_Handle_t rail_handle)
+{
+  RAIL_RxPacketInfo_t info;
+  RAIL_RxPacketHandle_t packet;
+  uint8_t raw[KMESH_PRBS_FRAME_HEADER];
+  kmesh_frame_header_t header;
+  kmesh_prbs_gen_t gen;
+  uint8_t expected;
+  uint8_t diff;
+  bool errored = false;
+
+  packet = RAIL_GetRxPacketInfo(rail_handle, RAIL_RX_PACKET_HANDLE_NEWEST, &info);
+  if ((packet == RAIL_RX_PACKET_HANDLE_INVALID)
+      || (info.packetStatus != RAIL_RX_PACKET_READY_SUCCESS
+          && info.packetStatus != RAIL_RX_PACKET_READY_CRC_ERROR)
+      || (info.packetBytes <= sizeof(raw))) {
+    return;
+  }
+  (void) RAIL_PeekRxPacket(rail_handle, packet, raw, sizeof(raw), 0U);
+  if (!kmesh_frame_decode_header(raw, info.packetBytes, &header)
+      || header.type != KMESH_FRAME_TYPE_PRBS
+      || raw[KMESH_FRAME_HEADER_LENGTH + KMESH_PRBS_OFFSET_PATTERN]
+      >= KMESH_PRBS_PATTERN_COUNT) {
+    return;
+  }
+  gen.pattern = (kmesh_prbs_pattern_t)raw[KMESH_FRAME_HEADER_LENGTH + KMESH_PRBS_OFFSET_PATTERN];
+  gen.state = ((uint32_t)kmesh_frame_get_u16(raw, KMESH_FRAME_HEADER_LENGTH
+                                             + KMESH_PRBS_OFFSET_STATE) << 16)
+              | kmesh_frame_get_u16(raw, KMESH_FRAME_HEADER_LENGTH
+                                    + KMESH_PRBS_OFFSET_STATE + 2U);
+  gen.phase = 0U;
+
+  if (rx_have_sequence) {
+    kmesh_prbs_rx_counters.lost += (uint8_t)(header.sequence - rx_next_sequence);
+  }
+  rx_have_sequence = true;
+  rx_next_sequence = (uint8_t)(header.sequence + 1U);
+  kmesh_prbs_rx_counters.packets++;
+  if (info.packetStatus == RAIL_RX_PACKET_READY_CRC_ERROR) {
+    kmesh_prbs_rx_counters.crc_errors++;
+  }
+
+  for (uint16_t offset = sizeof(raw); offset < info.packetBytes; offset++) {
+    expected = gen_byte(&gen);
+    diff = expected ^ *kmesh_rx_byte(&info, offset);
+    if (diff == 0U) {
+      continue;
+    }
+    errored = true;
+    kmesh_prbs_rx_counters.byte_errors++;
+    log_error(offset, expected, expected ^ diff);
+    for (; diff != 0U; diff &= (uint8_t)(diff - 1U)) {
+      kmesh_prbs_rx_counters.bit_errors++;
+    }
+  }
+  kmesh_prbs_rx_counters.bytes += info.packetBytes - sizeof(raw);
+  if (errored) {
+    kmesh_prbs_rx_counters.errored_packets++;
+  }
+}
+
+// Keeps the first KMESH_PRBS_ERROR_LOG wrong bytes since the checker was
+// enabled; the counters go on after that.
+static void log_error(uint16_t offset, uint8_t expected, uint8_t received)
+{
+  kmesh_prbs_error_t *error;
+
+  if (error_count >= KMESH_PRBS_ERROR_LOG) {
+    return;
+  }
+  error = &errors[error_count++];
+  error->packet = kmesh_prbs_rx_counters.packets - 1U;
+  error->offset = offset;
+  error->expected = expected;
+  error->received = received;
+}
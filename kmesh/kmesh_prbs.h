@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * @file kmesh_prbs.h
+ * @brief Pseudo-random test traffic: generator on TX, checker on RX.
+ ******************************************************************************/
+
+#ifndef KMESH_PRBS_H
+#define KMESH_PRBS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+typedef enum kmesh_prbs_pattern {
+  // ITU-T O.150 sequences: x^9 + x^5 + 1, x^15 + x^14 + 1, x^23 + x^18 + 1.
+  KMESH_PRBS_PATTERN_PRBS9,
+  KMESH_PRBS_PATTERN_PRBS15,
+  KMESH_PRBS_PATTERN_PRBS23,
+  // 32-bit big-endian words counting up by one.
+  KMESH_PRBS_PATTERN_COUNTER,
+  // Bytes counting up by one.
+  KMESH_PRBS_PATTERN_INCREMENT,
+  KMESH_PRBS_PATTERN_COUNT,
+} kmesh_prbs_pattern_t;
+
+typedef struct kmesh_prbs_tx_counters {
+  uint32_t sent;
+  // Transmissions that failed to start or ended in anything but TX_PACKET_SENT,
+  // and those of them where the generator did not keep the FIFO fed.
+  uint32_t errors;
+  uint32_t underflows;
+  uint32_t refills;
+  // Frames held back until another transmission had completed.
+  uint32_t deferred;
+  uint32_t bytes;
+  // First start to last completion.
+  uint32_t elapsed_us;
+} kmesh_prbs_tx_counters_t;
+
+typedef struct kmesh_prbs_rx_counters {
+  uint32_t packets;
+  // Checked packets that failed CRC, those with at least one wrong byte and
+  // those missing from the sequence numbers.
+  uint32_t crc_errors;
+  uint32_t errored_packets;
+  uint32_t lost;
+  uint32_t bytes;
+  uint32_t byte_errors;
+  uint32_t bit_errors;
+} kmesh_prbs_rx_counters_t;
+
+// A wrong byte, at offset bytes into the frame of the packet-th checked packet.
+typedef struct kmesh_prbs_error {
+  uint32_t packet;
+  uint16_t offset;
+  uint8_t expected;
+  uint8_t received;
+} kmesh_prbs_error_t;
+
+extern kmesh_prbs_tx_counters_t kmesh_prbs_tx_counters;
+extern kmesh_prbs_rx_counters_t kmesh_prbs_rx_counters;
+
+// Send count PRBS frames of length bytes, length header included, on
+// channel back to back, 0 meaning until stopped. The generator runs on
+// across frames. Prints prbsTxDone when done.
+RAIL_Status_t kmesh_prbs_tx_start(kmesh_prbs_pattern_t pattern, uint16_t length,
+                                  uint16_t channel, uint32_t count);
+void kmesh_prbs_tx_stop(void);
+bool kmesh_prbs_tx_is_running(void);
+
+// Check received PRBS frames, resetting the counters and the error log.
+void kmesh_prbs_rx_enable(bool enable);
+bool kmesh_prbs_rx_is_enabled(void);
+void kmesh_prbs_rx_get_counters(kmesh_prbs_rx_counters_t *counters);
+// Copy out logged error index; returns false past the last one.
+bool kmesh_prbs_rx_get_error(uint8_t index, kmesh_prbs_error_t *error);
+
+// Refills the TX FIFO, starts the next frame and checks received frames.
+// Interrupt context.
+void kmesh_prbs_on_rail_event(RAIL_Handle_t rail_handle, RAIL_Events_t events);
+
+// Reports the end of a TX run. Called from kmesh_process_action().
+void kmesh_prbs_process_action(void);
+
+#endif // KMESH_PRBS_H
@@ -0,0 +1,289 @@
+/***************************************************************************//**
+ * @file kmesh_rate.c
+ * @brief Per-neighbor PHY selection from ACK loss and reported RSSI.
+ *
+ * Each channel group of the channel config is one rate, ordered from the
+ * slowest, most robust PHY to the fastest. KMESH_RATE_COMMON_GROUP is the
+ * common PHY everybody receives on by default: broadcasts use it and new
+ * neighbors start on it, so marginal links can still fall back below it. A
+ * channel maps across groups by its offset from the group's first channel,
+ * so one channel number names the same spot on every rate.
+ *
+ * Every unicast ACK and ACK timeout updates the neighbor's ACK loss, as a
+ * 1/8 weighted average in per mille, and the RSSI it reported for our frame.
+ * A loss above KMESH_RATE_DOWN_PER_PERMILLE, two misses in a row with the
+ * defaults, drops one rate at once. KMESH_RATE_UP_ACKS ACKs in a row with the
+ * loss under KMESH_RATE_UP_PER_PERMILLE move up one; rates above the common
+ * one also need KMESH_RATE_STEP_DB more RSSI each than
+ * KMESH_RATE_BASE_RSSI_DBM. Statistics restart on
+ * every change, since they describe the PHY they were taken on.
+ *
+ * A receiver on a single PHY cannot decode the others, so while adaptation is
+ * on RX scans one channel of every group with RAIL channel hopping, staying
+ * on a channel only while it senses a preamble. That shares the hopping
+ * engine with listen mode, so only one of them can be on at a time.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "rail_config.h"
+#include "kmesh.h"
+#include "kmesh_neighbor.h"
+#include "kmesh_power.h"
+#include "kmesh_rate.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_RATE_PER_SHIFT   3U
+#define KMESH_RATE_RSSI_WEIGHT 4
+#define KMESH_RATE_PERMILLE    1000U
+
+typedef struct kmesh_rate_entry {
+  kmesh_neighbor_entry_t header;
+  kmesh_rate_link_t link;
+  uint8_t good_acks;
+} kmesh_rate_entry_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static kmesh_rate_entry_t *claim_entry(uint16_t address);
+static void set_rate(kmesh_rate_entry_t *entry, uint8_t rate);
+static uint16_t rate_channel(uint8_t rate, uint16_t channel);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static const RAIL_ChannelConfigEntry_t *groups;
+static uint8_t rate_count;
+static uint8_t common_rate;
+
+static kmesh_rate_entry_t entries[KMESH_RATE_NEIGHBORS];
+static const kmesh_neighbor_table_t table = KMESH_NEIGHBOR_TABLE(entries);
+
+static bool enabled;
+static bool scanning;
+static uint16_t common_channel;
+
+static RAIL_RxChannelHoppingConfigEntry_t hop_entries[KMESH_RATE_MAX];
+static uint32_t hop_buffer[KMESH_RATE_MAX * RAIL_CHANNEL_HOPPING_BUFFER_SIZE_PER_CHANNEL];
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_rate_init(void)
+{
+  groups = channelConfigs[0]->configs;
+  rate_count = (channelConfigs[0]->length < KMESH_RATE_MAX)
+               ? (uint8_t)channelConfigs[0]->length : (uint8_t)KMESH_RATE_MAX;
+  common_rate = (KMESH_RATE_COMMON_GROUP < rate_count) ? KMESH_RATE_COMMON_GROUP : 0U;
+}
+
+RAIL_Status_t kmesh_rate_configure(bool enable)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  RAIL_RxChannelHoppingConfig_t config = {
+    .buffer = hop_buffer,
+    .bufferLength = RAIL_CHANNEL_HOPPING_BUFFER_SIZE_PER_CHANNEL * KMESH_RATE_MAX,
+    .numberOfChannels = rate_count,
+    .entries = hop_entries,
+  };
+  RAIL_Status_t status;
+  uint16_t channel = common_channel;
+  CORE_DECLARE_IRQ_STATE;
+
+  // A channel config generated before the rate groups were added has nothing
+  // to adapt between.
+  if (enable && rate_count < 2U) {
+    return RAIL_STATUS_INVALID_CALL;
+  }
+  if (enable && kmesh_power_is_listening()) {
+    return RAIL_STATUS_INVALID_STATE;
+  }
+  if (!scanning) {
+    status = RAIL_GetChannel(rail_handle, &channel);
+    if (status != RAIL_STATUS_NO_ERROR) {
+      return status;
+    }
+  }
+  if (channel < groups[common_rate].channelNumberStart
+      || channel > groups[common_rate].channelNumberEnd) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+
+  CORE_ENTER_ATOMIC();
+  enabled = false;
+  common_channel = channel;
+  kmesh_neighbor_clear(&table);
+  CORE_EXIT_ATOMIC();
+
+  RAIL_Idle(rail_handle, RAIL_IDLE, true);
+  if (scanning) {
+    (void) RAIL_EnableRxChannelHopping(rail_handle, false, false);
+    scanning = false;
+  }
+  if (enable) {
+    memset(hop_entries, 0, sizeof(hop_entries));
+    for (uint8_t i = 0U; i < rate_count; i++) {
+      hop_entries[i].channel = rate_channel(i, common_channel);
+      hop_entries[i].mode = RAIL_RX_CHANNEL_HOPPING_MODE_PREAMBLE_SENSE;
+      hop_entries[i].parameter = KMESH_RATE_DWELL_US;
+      hop_entries[i].delayMode = RAIL_RX_CHANNEL_HOPPING_DELAY_MODE_STATIC;
+      hop_entries[i].options = RAIL_RX_CHANNEL_HOPPING_OPTIONS_DEFAULT;
+    }
+    status = RAIL_ConfigRxChannelHopping(rail_handle, &config);
+    if (status == RAIL_STATUS_NO_ERROR) {
+      status = RAIL_EnableRxChannelHopping(rail_handle, true, true);
+    }
+    if (status != RAIL_STATUS_NO_ERROR) {
+      (void) RAIL_StartRx(rail_handle, common_channel, NULL);
+      return status;
+    }
+    scanning = true;
+  }
+  enabled = enable;
+  return RAIL_StartRx(rail_handle, common_channel, NULL);
+}
+
+bool kmesh_rate_is_enabled(void)
+{
+  return enabled;
+}
+
+bool kmesh_rate_is_scanning(void)
+{
+  return scanning;
+}
+
+uint8_t kmesh_rate_get_count(void)
+{
+  return rate_count;
+}
+
+uint16_t kmesh_rate_get_common_channel(void)
+{
+  return common_channel;
+}
+
+uint8_t kmesh_rate_get_common_rate(void)
+{
+  return common_rate;
+}
+
+uint16_t kmesh_rate_tx_channel(uint16_t next_hop, uint16_t channel)
+{
+  kmesh_rate_entry_t *entry;
+
+  if (!enabled) {
+    return channel;
+  }
+  entry = (next_hop == KMESH_ADDRESS_BROADCAST) ? NULL : kmesh_neighbor_find(&table, next_hop);
+  return rate_channel((entry != NULL) ? entry->link.rate : common_rate, channel);
+}
+
+void kmesh_rate_on_ack(uint16_t neighbor, int8_t rssi)
+{
+  kmesh_rate_entry_t *entry;
+  kmesh_rate_link_t *link;
+  int32_t margin_db;
+
+  if (!enabled) {
+    return;
+  }
+  entry = claim_entry(neighbor);
+  link = &entry->link;
+  link->acks++;
+  link->per_permille -= link->per_permille >> KMESH_RATE_PER_SHIFT;
+  if (rssi != RAIL_RSSI_INVALID_DBM) {
+    link->rssi = (link->rssi == RAIL_RSSI_INVALID_DBM) ? rssi
+                 : (int8_t)(link->rssi + (rssi - link->rssi) / KMESH_RATE_RSSI_WEIGHT);
+  }
+  if (entry->good_acks < UINT8_MAX) {
+    entry->good_acks++;
+  }
+  if ((uint8_t)(link->rate + 1U) >= rate_count
+      || entry->good_acks < KMESH_RATE_UP_ACKS
+      || link->per_permille > KMESH_RATE_UP_PER_PERMILLE
+      || link->rssi == RAIL_RSSI_INVALID_DBM) {
+    return;
+  }
+  margin_db = (int32_t)link->rssi - KMESH_RATE_BASE_RSSI_DBM;
+  if (margin_db >= (int32_t)KMESH_RATE_STEP_DB * ((int32_t)link->rate + 1 - common_rate)) {
+    set_rate(entry, link->rate + 1U);
+  }
+}
+
+void kmesh_rate_on_miss(uint16_t neighbor)
+{
+  kmesh_rate_entry_t *entry;
+  kmesh_rate_link_t *link;
+
+  if (!enabled) {
+    return;
+  }
+  entry = claim_entry(neighbor);
+  link = &entry->link;
+  link->misses++;
+  link->per_permille += (KMESH_RATE_PERMILLE - link->per_permille) >> KMESH_RATE_PER_SHIFT;
+  entry->good_acks = 0U;
+  if (link->rate > 0U && link->per_permille > KMESH_RATE_DOWN_PER_PERMILLE) {
+    set_rate(entry, link->rate - 1U);
+  }
+}
+
+bool kmesh_rate_get_link(uint8_t index, kmesh_rate_link_t *link)
+{
+  const kmesh_rate_entry_t *entry = kmesh_neighbor_get(&table, index);
+
+  if (entry == NULL) {
+    return false;
+  }
+  *link = entry->link;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// The neighbor's entry, a new one started on the common PHY if it had none.
+static kmesh_rate_entry_t *claim_entry(uint16_t address)
+{
+  bool claimed;
+  kmesh_rate_entry_t *entry = kmesh_neighbor_claim(&table, address, &claimed);
+
+  if (claimed) {
+    entry->link.address = address;
+    entry->link.rate = common_rate;
+    entry->link.rssi = RAIL_RSSI_INVALID_DBM;
+  }
+  return entry;
+}
+
+static void set_rate(kmesh_rate_entry_t *entry, uint8_t rate)
+{
+  entry->link.rate = rate;
+  entry->link.rssi = RAIL_RSSI_INVALID_DBM;
+  entry->link.per_permille = 0U;
+  entry->good_acks = 0U;
+}
+
+// channel's place in its own group, carried over to the group of rate. The
+// channel RAIL is on is used rather than the one rates were configured on,
+// so setChannel takes effect, and while scanning it may be in any group.
+static uint16_t rate_channel(uint8_t rate, uint16_t channel)
+{
+  uint16_t offset = 0U;
+
+  for (uint8_t i = 0U; i < rate_count; i++) {
+    if (channel >= groups[i].channelNumberStart && channel <= groups[i].channelNumberEnd) {
+      offset = channel - groups[i].channelNumberStart;
+      break;
+    }
+  }
+  channel = groups[rate].channelNumberStart + offset;
+  return (channel > groups[rate].channelNumberEnd) ? groups[rate].channelNumberEnd : channel;
+}
@@ -0,0 +1,50 @@
+/***************************************************************************//**
+ * @file kmesh_rate.h
+ * @brief Per-neighbor PHY selection from ACK loss and reported RSSI.
+ ******************************************************************************/
+
+#ifndef KMESH_RATE_H
+#define KMESH_RATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+typedef struct kmesh_rate_link {
+  uint16_t address;
+  // Index of the channel group (PHY) frames to this neighbor go out on,
+  // slowest first.
+  uint8_t rate;
+  int8_t rssi;
+  // Exponentially weighted ACK loss, in per mille.
+  uint16_t per_permille;
+  uint32_t acks;
+  uint32_t misses;
+} kmesh_rate_link_t;
+
+// Builds the rate table from the channel groups of the channel config.
+// Called from kmesh_init().
+void kmesh_rate_init(void);
+
+// With enable, receive by scanning one channel of every group, starting from
+// the present channel, which must be in the common group, and pick a rate
+// per neighbor. RAIL_STATUS_INVALID_CALL with fewer than two rates,
+// RAIL_STATUS_INVALID_STATE while listen mode is on.
+RAIL_Status_t kmesh_rate_configure(bool enable);
+bool kmesh_rate_is_enabled(void);
+bool kmesh_rate_is_scanning(void);
+uint8_t kmesh_rate_get_count(void);
+uint16_t kmesh_rate_get_common_channel(void);
+uint8_t kmesh_rate_get_common_rate(void);
+
+// Channel to transmit to next_hop on, given the channel RAIL is on.
+uint16_t kmesh_rate_tx_channel(uint16_t next_hop, uint16_t channel);
+
+// Feedback from the ARQ. Interrupt context.
+void kmesh_rate_on_ack(uint16_t neighbor, int8_t rssi);
+void kmesh_rate_on_miss(uint16_t neighbor);
+
+// Copy out entry index; returns false past the last valid entry.
+bool kmesh_rate_get_link(uint8_t index, kmesh_rate_link_t *link);
+
+#endif // KMESH_RATE_H
@@ -0,0 +1,385 @@
+/***************************************************************************//**
+ * @file kmesh_route.c
+ * @brief Unicast routing table and next-hop forwarding for kmesh frames.
+ *
+ * Routes are learned distance-vector style from periodic broadcast route
+ * advertisements. An advertisement payload is a count byte followed by
+ * {destination (2 bytes), metric (1 byte), next hop (2 bytes)} entries, the
+ * first of which is always the advertising node itself at metric 0.
+ *
+ * Advertisements are broadcast, so split horizon is applied by the
+ * receiver: a route whose next hop is the receiving node counts as
+ * unreachable there (poisoned reverse). An unreachable metric from the
+ * current next hop drops the route at once instead of letting two nodes
+ * count up to KMESH_ROUTE_METRIC_INFINITY through each other.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "sl_core.h"
+#include "kmesh.h"
+#include "kmesh_route.h"
+#include "kmesh_lbt.h"
+#include "kmesh_rate.h"
+#include "kmesh_tpc.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_ROUTE_ADVERT_ENTRY_LENGTH 5U
+#define KMESH_ROUTE_ADVERT_MAX_ENTRIES \
+  ((KMESH_FRAME_MAX_LENGTH - KMESH_FRAME_HEADER_LENGTH - 1U) / KMESH_ROUTE_ADVERT_ENTRY_LENGTH)
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static kmesh_route_t *find_route(uint16_t destination);
+static void learn_route(uint16_t destination, uint16_t next_hop, uint8_t metric);
+static void handle_advert(RAIL_Handle_t rail_handle,
+                          RAIL_RxPacketHandle_t packet,
+                          const RAIL_RxPacketInfo_t *info,
+                          uint16_t neighbor);
+static void forward_frame(RAIL_Handle_t rail_handle,
+                          const RAIL_RxPacketInfo_t *info,
+                          const kmesh_frame_header_t *header);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+// Entries with metric KMESH_ROUTE_METRIC_INFINITY are free.
+static kmesh_route_t routes[KMESH_ROUTE_TABLE_SIZE];
+static bool routing_enabled;
+static uint16_t advertise_countdown_s;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_route_init(void)
+{
+  for (uint8_t i = 0U; i < KMESH_ROUTE_TABLE_SIZE; i++) {
+    routes[i].metric = KMESH_ROUTE_METRIC_INFINITY;
+  }
+  routing_enabled = false;
+  advertise_countdown_s = 0U;
+}
+
+void kmesh_route_on_second(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  for (uint8_t i = 0U; i < KMESH_ROUTE_TABLE_SIZE; i++) {
+    if (routes[i].metric >= KMESH_ROUTE_METRIC_INFINITY
+        || routes[i].lifetime_s == KMESH_ROUTE_LIFETIME_STATIC) {
+      continue;
+    }
+    if (routes[i].lifetime_s <= 1U) {
+      routes[i].metric = KMESH_ROUTE_METRIC_INFINITY;
+    } else {
+      routes[i].lifetime_s--;
+    }
+  }
+  CORE_EXIT_ATOMIC();
+
+  if (routing_enabled) {
+    if (advertise_countdown_s <= 1U) {
+      advertise_countdown_s = KMESH_ROUTE_ADVERTISE_PERIOD_S;
+      (void) kmesh_route_advertise();
+    } else {
+      advertise_countdown_s--;
+    }
+  }
+}
+
+void kmesh_route_set_enabled(bool enable)
+{
+  routing_enabled = enable;
+  // Advertise on the next tick so neighbors learn about us right away.
+  advertise_countdown_s = 1U;
+}
+
+bool kmesh_route_is_enabled(void)
+{
+  return routing_enabled;
+}
+
+bool kmesh_route_lookup(uint16_t destination, uint16_t *next_hop)
+{
+  kmesh_route_t *route;
+  bool found = false;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  route = find_route(destination);
+  if (route != NULL) {
+    *next_hop = route->next_hop;
+    found = true;
+  }
+  CORE_EXIT_ATOMIC();
+  return found;
+}
+
+bool kmesh_route_add(uint16_t destination,
+                     uint16_t next_hop,
+                     uint8_t metric,
+                     uint16_t lifetime_s)
+{
+  kmesh_route_t *route;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (metric >= KMESH_ROUTE_METRIC_INFINITY) {
+    return false;
+  }
+  CORE_ENTER_ATOMIC();
+  route = find_route(destination);
+  for (uint8_t i = 0U; (route == NULL) && (i < KMESH_ROUTE_TABLE_SIZE); i++) {
+    if (routes[i].metric >= KMESH_ROUTE_METRIC_INFINITY) {
+      route = &routes[i];
+    }
+  }
+  if (route != NULL) {
+    route->destination = destination;
+    route->next_hop = next_hop;
+    route->metric = metric;
+    route->lifetime_s = lifetime_s;
+  }
+  CORE_EXIT_ATOMIC();
+  return (route != NULL);
+}
+
+bool kmesh_route_remove(uint16_t destination)
+{
+  kmesh_route_t *route;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  route = find_route(destination);
+  if (route != NULL) {
+    route->metric = KMESH_ROUTE_METRIC_INFINITY;
+  }
+  CORE_EXIT_ATOMIC();
+  return (route != NULL);
+}
+
+uint8_t kmesh_route_count(void)
+{
+  uint8_t count = 0U;
+
+  for (uint8_t i = 0U; i < KMESH_ROUTE_TABLE_SIZE; i++) {
+    if (routes[i].metric < KMESH_ROUTE_METRIC_INFINITY) {
+      count++;
+    }
+  }
+  return count;
+}
+
+bool kmesh_route_get(uint8_t index, kmesh_route_t *route)
+{
+  bool found = false;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  for (uint8_t i = 0U; i < KMESH_ROUTE_TABLE_SIZE; i++) {
+    if (routes[i].metric >= KMESH_ROUTE_METRIC_INFINITY) {
+      continue;
+    }
+    if (index == 0U) {
+      *route = routes[i];
+      found = true;
+      break;
+    }
+    index--;
+  }
+  CORE_EXIT_ATOMIC();
+  return found;
+}
+
+RAIL_Status_t kmesh_route_advertise(void)
+{
+  uint8_t payload[1U + (KMESH_ROUTE_ADVERT_MAX_ENTRIES
+                        * KMESH_ROUTE_ADVERT_ENTRY_LENGTH)];
+  uint8_t count = 1U;
+  uint16_t offset = 1U;
+  CORE_DECLARE_IRQ_STATE;
+
+  kmesh_frame_put_u16(payload, offset, kmesh_get_address());
+  payload[offset + 2U] = 0U;
+  kmesh_frame_put_u16(payload, offset + 3U, kmesh_get_address());
+  offset += KMESH_ROUTE_ADVERT_ENTRY_LENGTH;
+
+  CORE_ENTER_ATOMIC();
+  for (uint8_t i = 0U;
+       (i < KMESH_ROUTE_TABLE_SIZE) && (count < KMESH_ROUTE_ADVERT_MAX_ENTRIES);
+       i++) {
+    if (routes[i].metric >= KMESH_ROUTE_METRIC_INFINITY) {
+      continue;
+    }
+    kmesh_frame_put_u16(payload, offset, routes[i].destination);
+    payload[offset + 2U] = routes[i].metric;
+    kmesh_frame_put_u16(payload, offset + 3U, routes[i].next_hop);
+    offset += KMESH_ROUTE_ADVERT_ENTRY_LENGTH;
+    count++;
+  }
+  CORE_EXIT_ATOMIC();
+  payload[0] = count;
+
+  return kmesh_send(KMESH_ADDRESS_BROADCAST, KMESH_FRAME_TYPE_ROUTE_ADVERT,
+                    payload, offset);
+}
+
+void kmesh_route_on_rx(RAIL_Handle_t rail_handle,
+                       RAIL_RxPacketHandle_t packet,
+                       const RAIL_RxPacketInfo_t *info,
+                       const kmesh_frame_header_t *header)
+{
+  if (!routing_enabled || header->source == kmesh_get_address()) {
+    return;
+  }
+  if (header->type == KMESH_FRAME_TYPE_ROUTE_ADVERT) {
+    handle_advert(rail_handle, packet, info, header->source);
+  } else if ((header->type == KMESH_FRAME_TYPE_DATA || header->type == KMESH_FRAME_TYPE_ACK)
+             && header->next_hop == kmesh_get_address()
+             && header->destination != kmesh_get_address()
+             && header->destination != KMESH_ADDRESS_BROADCAST) {
+    forward_frame(rail_handle, info, header);
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static kmesh_route_t *find_route(uint16_t destination)
+{
+  for (uint8_t i = 0U; i < KMESH_ROUTE_TABLE_SIZE; i++) {
+    if (routes[i].metric < KMESH_ROUTE_METRIC_INFINITY
+        && routes[i].destination == destination) {
+      return &routes[i];
+    }
+  }
+  return NULL;
+}
+
+// Called from the RAIL interrupt, so the table is never observed half
+// updated by the main loop, which takes CORE_ENTER_ATOMIC() around access.
+static void learn_route(uint16_t destination, uint16_t next_hop, uint8_t metric)
+{
+  kmesh_route_t *route = find_route(destination);
+  kmesh_route_t *victim = NULL;
+
+  if (destination == kmesh_get_address()) {
+    return;
+  }
+  if (route != NULL) {
+    if (route->lifetime_s == KMESH_ROUTE_LIFETIME_STATIC) {
+      return;
+    }
+    // Always believe the current next hop, even if it got worse or lost
+    // the destination, which frees the entry; otherwise only switch to a
+    // strictly better path.
+    if (route->next_hop == next_hop || metric < route->metric) {
+      route->next_hop = next_hop;
+      route->metric = metric;
+      route->lifetime_s = KMESH_ROUTE_LIFETIME_S;
+    }
+    return;
+  }
+  if (metric >= KMESH_ROUTE_METRIC_INFINITY) {
+    return;
+  }
+  // Take a free slot, else evict the dynamic route closest to expiring.
+  for (uint8_t i = 0U; i < KMESH_ROUTE_TABLE_SIZE; i++) {
+    if (routes[i].metric >= KMESH_ROUTE_METRIC_INFINITY) {
+      victim = &routes[i];
+      break;
+    }
+    if (routes[i].lifetime_s != KMESH_ROUTE_LIFETIME_STATIC
+        && (victim == NULL || routes[i].lifetime_s < victim->lifetime_s)) {
+      victim = &routes[i];
+    }
+  }
+  if (victim != NULL) {
+    victim->destination = destination;
+    victim->next_hop = next_hop;
+    victim->metric = metric;
+    victim->lifetime_s = KMESH_ROUTE_LIFETIME_S;
+  }
+}
+
+static void handle_advert(RAIL_Handle_t rail_handle,
+                          RAIL_RxPacketHandle_t packet,
+                          const RAIL_RxPacketInfo_t *info,
+                          uint16_t neighbor)
+{
+  uint8_t entry[KMESH_ROUTE_ADVERT_ENTRY_LENGTH];
+  uint8_t count = *kmesh_rx_byte(info, KMESH_FRAME_HEADER_LENGTH);
+  uint16_t offset = KMESH_FRAME_HEADER_LENGTH + 1U;
+  uint8_t metric;
+
+  learn_route(neighbor, neighbor, 1U);
+  for (uint8_t i = 0U; i < count; i++) {
+    if ((offset + KMESH_ROUTE_ADVERT_ENTRY_LENGTH) > info->packetBytes) {
+      break;
+    }
+    (void) RAIL_PeekRxPacket(rail_handle, packet, entry, sizeof(entry), offset);
+    offset += KMESH_ROUTE_ADVERT_ENTRY_LENGTH;
+    metric = entry[2];
+    // Poisoned reverse: the neighbor reaches it through us.
+    if (metric >= KMESH_ROUTE_METRIC_INFINITY - 1U
+        || kmesh_frame_get_u16(entry, 3U) == kmesh_get_address()) {
+      metric = KMESH_ROUTE_METRIC_INFINITY;
+    } else {
+      metric++;
+    }
+    learn_route(kmesh_frame_get_u16(entry, 0U), neighbor, metric);
+  }
+}
+
+// Rewrite next hop and hop limit inside the RX FIFO and hand the very same
+// bytes to the TX FIFO, avoiding an intermediate application buffer.
+static void forward_frame(RAIL_Handle_t rail_handle,
+                          const RAIL_RxPacketInfo_t *info,
+                          const kmesh_frame_header_t *header)
+{
+  uint8_t hop_limit = header->hop_limit;
+  kmesh_route_t *route = find_route(header->destination);
+  uint16_t channel;
+
+  if (hop_limit <= 1U) {
+    kmesh_counters.hop_limit_exceeded++;
+    return;
+  }
+  if (route == NULL) {
+    kmesh_counters.no_route++;
+    return;
+  }
+  // As in kmesh_transmit(), never reset the FIFO under a frame still going out.
+  if ((RAIL_GetRadioState(rail_handle) & RAIL_RF_STATE_TX) == RAIL_RF_STATE_TX) {
+    kmesh_counters.tx_errors++;
+    return;
+  }
+  *kmesh_rx_byte(info, KMESH_FRAME_OFFSET_NEXT_HOP) = (uint8_t)(route->next_hop >> 8);
+  *kmesh_rx_byte(info, KMESH_FRAME_OFFSET_NEXT_HOP + 1U) = (uint8_t)route->next_hop;
+  *kmesh_rx_byte(info, KMESH_FRAME_OFFSET_HOP_LIMIT) = hop_limit - 1U;
+
+  // A frame that does not fit completely is dropped rather than sent short.
+  if ((RAIL_WriteTxFifo(rail_handle, info->firstPortionData,
+                        info->firstPortionBytes, true) != info->firstPortionBytes)
+      || ((info->packetBytes > info->firstPortionBytes)
+          && (RAIL_WriteTxFifo(rail_handle, info->lastPortionData,
+                               info->packetBytes - info->firstPortionBytes, false)
+              != info->packetBytes - info->firstPortionBytes))) {
+    kmesh_counters.tx_errors++;
+    return;
+  }
+  kmesh_tpc_apply(route->next_hop);
+  if ((RAIL_GetChannel(rail_handle, &channel) != RAIL_STATUS_NO_ERROR)
+      || (kmesh_lbt_start_tx(rail_handle, kmesh_rate_tx_channel(route->next_hop, channel),
+                             header->type != KMESH_FRAME_TYPE_ACK)
+          != RAIL_STATUS_NO_ERROR)) {
+    kmesh_tpc_restore();
+    kmesh_counters.tx_errors++;
+    return;
+  }
+  kmesh_counters.forwarded++;
+}
@@ -0,0 +1,50 @@
+/***************************************************************************//**
+ * @file kmesh_route.h
+ * @brief Unicast routing table and next-hop forwarding for kmesh frames.
+ ******************************************************************************/
+
+#ifndef KMESH_ROUTE_H
+#define KMESH_ROUTE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+#include "kmesh_frame.h"
+
+// Lifetime value of routes that never expire (added from the CLI).
+#define KMESH_ROUTE_LIFETIME_STATIC 0xFFFFU
+
+typedef struct kmesh_route {
+  uint16_t destination;
+  uint16_t next_hop;
+  uint8_t metric;
+  uint16_t lifetime_s;
+} kmesh_route_t;
+
+void kmesh_route_init(void);
+void kmesh_route_on_second(void);
+
+void kmesh_route_set_enabled(bool enable);
+bool kmesh_route_is_enabled(void);
+
+bool kmesh_route_lookup(uint16_t destination, uint16_t *next_hop);
+bool kmesh_route_add(uint16_t destination,
+                     uint16_t next_hop,
+                     uint8_t metric,
+                     uint16_t lifetime_s);
+bool kmesh_route_remove(uint16_t destination);
+uint8_t kmesh_route_count(void);
+// Copy out entry index; returns false past the last valid entry.
+bool kmesh_route_get(uint8_t index, kmesh_route_t *route);
+
+RAIL_Status_t kmesh_route_advertise(void);
+
+// Handle a received frame whose header has already been validated. Route
+// advertisements update the table; data frames for which this node is the
+// next hop are patched in place and retransmitted from the RX FIFO.
+void kmesh_route_on_rx(RAIL_Handle_t rail_handle,
+                       RAIL_RxPacketHandle_t packet,
+                       const RAIL_RxPacketInfo_t *info,
+                       const kmesh_frame_header_t *header);
+
+#endif // KMESH_ROUTE_H
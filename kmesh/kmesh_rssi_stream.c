@@ -0,0 +1,253 @@
+/***************************************************************************//**
+ * @file kmesh_rssi_stream.c
+ * @brief Binary RSSI sample bursts and the device side of the stream.
+ *
+ * getRssi costs a full CLI round trip per sample. Here a RAIL multitimer
+ * reads the RSSI register every period, by default the RSSI update period of
+ * the PHY (8 symbols, 80 us at 100 kbaud), scheduled on absolute times so
+ * the period does not drift with interrupt latency.
+ *
+ * Samples go straight into one of two RAM blocks laid out as a finished
+ * burst, header and checksum space included. When a block is full the timer
+ * moves on to the other one and the main loop seals the full block and hands
+ * it to the console in one write. If both are still waiting for the console
+ * the samples are counted as lost instead; a sampling interrupt that ran a
+ * period or more late closes the block early, so every burst has a constant
+ * period from its timestamp.
+ *
+ * At 115200 baud the console carries about 11 kB/s, just under one sample
+ * per 90 us, so longer captures at the update period lose bursts.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "sl_core.h"
+#include "sl_power_manager.h"
+#include "kmesh.h"
+#include "kmesh_console.h"
+#include "kmesh_rssi_stream.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_RSSI_STREAM_US_PER_S  1000000UL
+#define KMESH_RSSI_STREAM_QDBM      4
+
+typedef struct kmesh_rssi_block {
+  uint8_t data[KMESH_RSSI_STREAM_OVERHEAD + KMESH_RSSI_STREAM_BLOCK_SIZE];
+  kmesh_rssi_burst_t burst;
+  volatile bool ready;
+} kmesh_rssi_block_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void on_sample(RAIL_MultiTimer_t *tmr, RAIL_Time_t expected_time, void *arg);
+static void store_sample(RAIL_Handle_t rail_handle, RAIL_Time_t time);
+static void finish_block(void);
+static void count_lost(uint32_t samples);
+static void stop(void);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_rssi_stream_counters_t kmesh_rssi_stream_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static kmesh_rssi_block_t blocks[2];
+// Block the timer fills and how far, and the next one to go to the console.
+static uint8_t filling;
+static uint16_t fill;
+static uint8_t sending;
+static uint32_t lost_since_burst;
+
+static bool enabled;
+static uint16_t period_us;
+static uint32_t burst_limit;
+static uint32_t bursts_sent;
+static uint16_t sequence;
+static RAIL_MultiTimer_t timer;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+RAIL_Status_t kmesh_rssi_stream_configure(bool enable, uint16_t period, uint32_t bursts)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  uint32_t symbol_rate;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!enable) {
+    stop();
+    return RAIL_STATUS_NO_ERROR;
+  }
+  if (period == 0U) {
+    symbol_rate = RAIL_GetSymbolRate(rail_handle);
+    if (symbol_rate == 0U) {
+      return RAIL_STATUS_INVALID_STATE;
+    }
+    period = (uint16_t)((KMESH_RSSI_STREAM_UPDATE_SYMBOLS * KMESH_RSSI_STREAM_US_PER_S
+                         + symbol_rate - 1U) / symbol_rate);
+  }
+  if (period < KMESH_RSSI_STREAM_MIN_PERIOD_US) {
+    return RAIL_STATUS_INVALID_PARAMETER;
+  }
+  stop();
+
+  CORE_ENTER_ATOMIC();
+  memset(blocks, 0, sizeof(blocks));
+  filling = 0U;
+  fill = 0U;
+  sending = 0U;
+  lost_since_burst = 0U;
+  period_us = period;
+  burst_limit = bursts;
+  bursts_sent = 0U;
+  enabled = true;
+  CORE_EXIT_ATOMIC();
+
+  // The RAIL timer keeps running in EM2, but the HF clock the radio needs
+  // to report RSSI does not; streaming is an EM1 activity.
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+  (void) RAIL_ConfigMultiTimer(true);
+  if (!RAIL_SetMultiTimer(&timer, RAIL_GetTime() + period_us, RAIL_TIME_ABSOLUTE,
+                          &on_sample, NULL)) {
+    stop();
+    return RAIL_STATUS_INVALID_CALL;
+  }
+  return RAIL_STATUS_NO_ERROR;
+}
+
+bool kmesh_rssi_stream_is_enabled(void)
+{
+  return enabled;
+}
+
+uint16_t kmesh_rssi_stream_get_period(void)
+{
+  return period_us;
+}
+
+void kmesh_rssi_stream_process_action(void)
+{
+  kmesh_rssi_block_t *block;
+  uint16_t length;
+
+  while (blocks[sending].ready) {
+    block = &blocks[sending];
+    // Blocks filled past the burst limit are dropped.
+    if (burst_limit == 0U || bursts_sent < burst_limit) {
+      if ((size_t)KMESH_RSSI_STREAM_OVERHEAD + block->burst.sample_count
+          > kmesh_console_get_free()) {
+        // Leave it queued; the timer counts what it cannot store.
+        return;
+      }
+      block->burst.sequence = sequence++;
+      length = kmesh_rssi_stream_seal(block->data, &block->burst);
+      (void) kmesh_console_write(block->data, length);
+      kmesh_rssi_stream_counters.bursts++;
+      bursts_sent++;
+    }
+    block->ready = false;
+    sending ^= 1U;
+    if (burst_limit != 0U && bursts_sent >= burst_limit) {
+      stop();
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// RAIL timer interrupt.
+static void on_sample(RAIL_MultiTimer_t *tmr, RAIL_Time_t expected_time, void *arg)
+{
+  RAIL_Time_t next = expected_time + period_us;
+  RAIL_Time_t now = RAIL_GetTime();
+  uint32_t missed = 0U;
+
+  (void) tmr;
+  (void) arg;
+  if (!enabled) {
+    return;
+  }
+  if ((int32_t)(now - next) >= 0) {
+    missed = (now - next) / period_us + 1U;
+    next += missed * period_us;
+    kmesh_rssi_stream_counters.late++;
+  }
+  (void) RAIL_SetMultiTimer(&timer, next, RAIL_TIME_ABSOLUTE, &on_sample, NULL);
+  store_sample(kmesh_get_rail_handle(), expected_time);
+  if (missed != 0U) {
+    finish_block();
+    count_lost(missed);
+  }
+}
+
+static void store_sample(RAIL_Handle_t rail_handle, RAIL_Time_t time)
+{
+  kmesh_rssi_block_t *block = &blocks[filling];
+  int16_t rssi;
+
+  if (block->ready) {
+    count_lost(1U);
+    return;
+  }
+  if (fill == 0U) {
+    block->burst.time = time;
+    block->burst.period_us = period_us;
+    block->burst.lost = (lost_since_burst > UINT16_MAX) ? UINT16_MAX
+                        : (uint16_t)lost_since_burst;
+    lost_since_burst = 0U;
+    (void) RAIL_GetChannel(rail_handle, &block->burst.channel);
+  }
+  rssi = RAIL_GetRssi(rail_handle, false);
+  block->data[KMESH_RSSI_STREAM_HEADER_LENGTH + fill] = (rssi == RAIL_RSSI_INVALID)
+                                                         ? (uint8_t)RAIL_RSSI_INVALID_DBM
+                                                         : (uint8_t)(rssi / KMESH_RSSI_STREAM_QDBM);
+  fill++;
+  kmesh_rssi_stream_counters.samples++;
+  if (fill == KMESH_RSSI_STREAM_BLOCK_SIZE) {
+    finish_block();
+  }
+}
+
+static void finish_block(void)
+{
+  kmesh_rssi_block_t *block = &blocks[filling];
+
+  if (fill == 0U) {
+    return;
+  }
+  block->burst.sample_count = fill;
+  block->ready = true;
+  filling ^= 1U;
+  fill = 0U;
+}
+
+static void count_lost(uint32_t samples)
+{
+  lost_since_burst += samples;
+  kmesh_rssi_stream_counters.lost += samples;
+}
+
+// Ships the partly filled block, if there is room for it.
+static void stop(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (!enabled) {
+    CORE_EXIT_ATOMIC();
+    return;
+  }
+  enabled = false;
+  (void) RAIL_CancelMultiTimer(&timer);
+  finish_block();
+  CORE_EXIT_ATOMIC();
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+}
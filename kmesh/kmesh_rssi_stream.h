@@ -0,0 +1,137 @@
+/***************************************************************************//**
+ * @file kmesh_rssi_stream.h
+ * @brief Binary RSSI sample bursts and the device side of the stream.
+ *
+ * Each filled sample block goes to the console as one burst, interleaved with
+ * ordinary text output and RX log records:
+ *
+ *   0     sync 0xA5
+ *   1     sync 0x52
+ *   2..3  burst length, sync and checksum included
+ *   4..5  burst sequence number
+ *   6..9  time of the first sample in microseconds (RAIL time)
+ *   10..11 sample period in microseconds
+ *   12..13 channel
+ *   14..15 samples not taken since the previous burst, saturating
+ *   16..  RSSI samples, one signed byte each, in dBm; -128 when invalid
+ *   last 2 Fletcher-16 over bytes 2 up to the checksum
+ *
+ * Multi-byte fields are little endian. Sample i was taken period * i after
+ * the first one. Lost samples come from blocks the console could not take
+ * in time and from sampling interrupts that ran late.
+ *
+ * Plain C with no SDK dependencies so tools/kmesh_rssi_decode.c builds it,
+ * with KMESH_RXLOG_HOST and KMESH_RSSI_STREAM_HOST defined.
+ ******************************************************************************/
+
+#ifndef KMESH_RSSI_STREAM_H
+#define KMESH_RSSI_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Shares the Fletcher-16 and little-endian helpers of the RX log.
+#include "kmesh_rxlog.h"
+
+#define KMESH_RSSI_STREAM_SYNC0            0xA5U
+#define KMESH_RSSI_STREAM_SYNC1            0x52U
+
+#define KMESH_RSSI_STREAM_OFFSET_LENGTH    2U
+#define KMESH_RSSI_STREAM_OFFSET_SEQUENCE  4U
+#define KMESH_RSSI_STREAM_OFFSET_TIME      6U
+#define KMESH_RSSI_STREAM_OFFSET_PERIOD    10U
+#define KMESH_RSSI_STREAM_OFFSET_CHANNEL   12U
+#define KMESH_RSSI_STREAM_OFFSET_LOST      14U
+#define KMESH_RSSI_STREAM_HEADER_LENGTH    16U
+#define KMESH_RSSI_STREAM_CHECKSUM_LENGTH  2U
+#define KMESH_RSSI_STREAM_OVERHEAD \
+  (KMESH_RSSI_STREAM_HEADER_LENGTH + KMESH_RSSI_STREAM_CHECKSUM_LENGTH)
+
+typedef struct kmesh_rssi_burst {
+  uint16_t sequence;
+  uint32_t time;
+  uint16_t period_us;
+  uint16_t channel;
+  uint16_t lost;
+  uint16_t sample_count;
+  const int8_t *samples;
+} kmesh_rssi_burst_t;
+
+// Fill in the header and checksum around the sample_count samples already at
+// out + KMESH_RSSI_STREAM_HEADER_LENGTH. Returns the burst length.
+static inline uint16_t kmesh_rssi_stream_seal(uint8_t *out, const kmesh_rssi_burst_t *burst)
+{
+  uint16_t length = (uint16_t)(KMESH_RSSI_STREAM_OVERHEAD + burst->sample_count);
+
+  out[0] = KMESH_RSSI_STREAM_SYNC0;
+  out[1] = KMESH_RSSI_STREAM_SYNC1;
+  kmesh_rxlog_put16(&out[KMESH_RSSI_STREAM_OFFSET_LENGTH], length);
+  kmesh_rxlog_put16(&out[KMESH_RSSI_STREAM_OFFSET_SEQUENCE], burst->sequence);
+  kmesh_rxlog_put16(&out[KMESH_RSSI_STREAM_OFFSET_TIME], (uint16_t)burst->time);
+  kmesh_rxlog_put16(&out[KMESH_RSSI_STREAM_OFFSET_TIME + 2U], (uint16_t)(burst->time >> 16));
+  kmesh_rxlog_put16(&out[KMESH_RSSI_STREAM_OFFSET_PERIOD], burst->period_us);
+  kmesh_rxlog_put16(&out[KMESH_RSSI_STREAM_OFFSET_CHANNEL], burst->channel);
+  kmesh_rxlog_put16(&out[KMESH_RSSI_STREAM_OFFSET_LOST], burst->lost);
+  kmesh_rxlog_put16(&out[length - KMESH_RSSI_STREAM_CHECKSUM_LENGTH],
+                    kmesh_rxlog_fletcher16(&out[KMESH_RSSI_STREAM_OFFSET_LENGTH],
+                                           length - KMESH_RSSI_STREAM_OFFSET_LENGTH
+                                           - KMESH_RSSI_STREAM_CHECKSUM_LENGTH));
+  return length;
+}
+
+// Decode the complete burst at in, available bytes long. Returns false if it
+// is not a valid burst; burst->samples points into in.
+static inline bool kmesh_rssi_stream_decode(const uint8_t *in, size_t available,
+                                            kmesh_rssi_burst_t *burst)
+{
+  uint16_t length;
+
+  if (available < KMESH_RSSI_STREAM_OVERHEAD
+      || in[0] != KMESH_RSSI_STREAM_SYNC0 || in[1] != KMESH_RSSI_STREAM_SYNC1) {
+    return false;
+  }
+  length = kmesh_rxlog_get16(&in[KMESH_RSSI_STREAM_OFFSET_LENGTH]);
+  if (length < KMESH_RSSI_STREAM_OVERHEAD || length > available
+      || kmesh_rxlog_get16(&in[length - KMESH_RSSI_STREAM_CHECKSUM_LENGTH])
+      != kmesh_rxlog_fletcher16(&in[KMESH_RSSI_STREAM_OFFSET_LENGTH],
+                                length - KMESH_RSSI_STREAM_OFFSET_LENGTH
+                                - KMESH_RSSI_STREAM_CHECKSUM_LENGTH)) {
+    return false;
+  }
+  burst->sequence = kmesh_rxlog_get16(&in[KMESH_RSSI_STREAM_OFFSET_SEQUENCE]);
+  burst->time = kmesh_rxlog_get16(&in[KMESH_RSSI_STREAM_OFFSET_TIME])
+                | ((uint32_t)kmesh_rxlog_get16(&in[KMESH_RSSI_STREAM_OFFSET_TIME + 2U]) << 16);
+  burst->period_us = kmesh_rxlog_get16(&in[KMESH_RSSI_STREAM_OFFSET_PERIOD]);
+  burst->channel = kmesh_rxlog_get16(&in[KMESH_RSSI_STREAM_OFFSET_CHANNEL]);
+  burst->lost = kmesh_rxlog_get16(&in[KMESH_RSSI_STREAM_OFFSET_LOST]);
+  burst->sample_count = (uint16_t)(length - KMESH_RSSI_STREAM_OVERHEAD);
+  burst->samples = (const int8_t *)&in[KMESH_RSSI_STREAM_HEADER_LENGTH];
+  return true;
+}
+
+#ifndef KMESH_RSSI_STREAM_HOST
+#include "rail.h"
+
+typedef struct kmesh_rssi_stream_counters {
+  uint32_t samples;
+  uint32_t bursts;
+  // Samples lost to a full block, and sampling interrupts that ran late.
+  uint32_t lost;
+  uint32_t late;
+} kmesh_rssi_stream_counters_t;
+
+extern kmesh_rssi_stream_counters_t kmesh_rssi_stream_counters;
+
+// Sample RSSI every period_us, 0 meaning the RSSI update period of the PHY,
+// and stream the samples in bursts of KMESH_RSSI_STREAM_BLOCK_SIZE. Stops by
+// itself after bursts bursts unless that is 0.
+RAIL_Status_t kmesh_rssi_stream_configure(bool enable, uint16_t period_us, uint32_t bursts);
+bool kmesh_rssi_stream_is_enabled(void);
+uint16_t kmesh_rssi_stream_get_period(void);
+
+// Writes filled blocks to the console. Called from kmesh_process_action().
+void kmesh_rssi_stream_process_action(void);
+#endif
+
+#endif // KMESH_RSSI_STREAM_H
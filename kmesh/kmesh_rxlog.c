@@ -0,0 +1,154 @@
+/***************************************************************************//**
+ * @file kmesh_rxlog.c
+ * @brief Binary RX log: one fixed-layout record per received packet.
+ *
+ * Records are built in the RAIL event handler, while the packet is still in
+ * the receive FIFO, into a byte ring; the main loop moves whole records to
+ * the console TX ring. Whatever does not fit in either is dropped and shows
+ * up as a gap in the record sequence numbers.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "sl_core.h"
+#include "kmesh.h"
+#include "kmesh_console.h"
+#include "kmesh_rxlog.h"
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void ring_put(const uint8_t *data, uint16_t length);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+kmesh_rxlog_counters_t kmesh_rxlog_counters;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static bool enabled;
+static uint8_t payload_limit = KMESH_RXLOG_DEFAULT_PAYLOAD;
+static uint16_t sequence;
+
+// Written by the RAIL event handler, read by the main loop.
+static uint8_t ring[KMESH_RXLOG_BUFFER_SIZE];
+static volatile uint16_t ring_head;
+static volatile uint16_t ring_tail;
+static volatile uint16_t ring_used;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_rxlog_configure(bool enable, uint8_t max_payload)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  enabled = enable;
+  payload_limit = (max_payload > KMESH_RXLOG_MAX_PAYLOAD)
+                  ? KMESH_RXLOG_MAX_PAYLOAD : max_payload;
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_rxlog_is_enabled(void)
+{
+  return enabled;
+}
+
+uint8_t kmesh_rxlog_get_max_payload(void)
+{
+  return payload_limit;
+}
+
+void kmesh_rxlog_process_action(void)
+{
+  uint8_t record[KMESH_RXLOG_OVERHEAD + KMESH_RXLOG_MAX_PAYLOAD];
+
+  while (ring_used != 0U) {
+    CORE_DECLARE_IRQ_STATE;
+    uint16_t at = ring_tail;
+    uint8_t length = ring[(at + KMESH_RXLOG_OFFSET_LENGTH) % KMESH_RXLOG_BUFFER_SIZE];
+
+    if (length > kmesh_console_get_free()) {
+      // Leave it queued; the console drains at UART speed.
+      return;
+    }
+    for (uint8_t i = 0U; i < length; i++) {
+      record[i] = ring[at];
+      at = (at + 1U) % KMESH_RXLOG_BUFFER_SIZE;
+    }
+    CORE_ENTER_ATOMIC();
+    ring_tail = at;
+    ring_used -= length;
+    CORE_EXIT_ATOMIC();
+    (void) kmesh_console_write(record, length);
+  }
+}
+
+void kmesh_rxlog_on_rx(RAIL_Handle_t rail_handle)
+{
+  // RAIL events are not nested, and this keeps it off the interrupt stack.
+  static uint8_t record[KMESH_RXLOG_OVERHEAD + KMESH_RXLOG_MAX_PAYLOAD];
+  RAIL_RxPacketInfo_t info;
+  RAIL_RxPacketDetails_t details;
+  RAIL_RxPacketHandle_t packet;
+  kmesh_rxlog_record_t entry = { 0 };
+  uint8_t length;
+
+  if (!enabled) {
+    return;
+  }
+  packet = RAIL_GetRxPacketInfo(rail_handle, RAIL_RX_PACKET_HANDLE_NEWEST, &info);
+  if (packet == RAIL_RX_PACKET_HANDLE_INVALID) {
+    return;
+  }
+  entry.sequence = sequence++;
+  if (RAIL_GetRxPacketDetails(rail_handle, packet, &details) == RAIL_STATUS_NO_ERROR) {
+    entry.time = details.timeReceived.packetTime;
+    entry.rssi = details.rssi;
+    entry.lqi = details.lqi;
+    entry.channel = details.channel;
+    entry.flags |= details.isAck ? KMESH_RXLOG_FLAG_ACK : 0U;
+  }
+  if (info.packetStatus == RAIL_RX_PACKET_READY_SUCCESS) {
+    entry.flags |= KMESH_RXLOG_FLAG_CRC_OK;
+  }
+  entry.packet_length = info.packetBytes;
+  entry.payload_length = (info.packetBytes > payload_limit) ? payload_limit
+                         : (uint8_t)info.packetBytes;
+  if (entry.payload_length < info.packetBytes) {
+    entry.flags |= KMESH_RXLOG_FLAG_TRUNCATED;
+  }
+  // Gather the payload in place; encoding then copies it onto itself.
+  for (uint8_t i = 0U; i < entry.payload_length; i++) {
+    record[KMESH_RXLOG_HEADER_LENGTH + i] = *kmesh_rx_byte(&info, i);
+  }
+  entry.payload = &record[KMESH_RXLOG_HEADER_LENGTH];
+
+  length = kmesh_rxlog_encode(record, &entry);
+  if (length > KMESH_RXLOG_BUFFER_SIZE - ring_used) {
+    kmesh_rxlog_counters.dropped++;
+    return;
+  }
+  ring_put(record, length);
+  kmesh_rxlog_counters.logged++;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Interrupt context, so the main loop only ever sees whole records.
+static void ring_put(const uint8_t *data, uint16_t length)
+{
+  uint16_t at = ring_head;
+
+  for (uint16_t i = 0U; i < length; i++) {
+    ring[at] = data[i];
+    at = (at + 1U) % KMESH_RXLOG_BUFFER_SIZE;
+  }
+  ring_head = at;
+  ring_used += length;
+}
@@ -0,0 +1,172 @@
+/***************************************************************************//**
+ * @file kmesh_rxlog.h
+ * @brief Binary RX log records and the device side of the logger.
+ *
+ * Each received packet becomes one record on the console, interleaved with
+ * ordinary text output:
+ *
+ *   0     sync 0xA5
+ *   1     sync 0x4B
+ *   2     record length, sync and checksum included
+ *   3     flags, see KMESH_RXLOG_FLAG_*
+ *   4..5  log sequence number, one per received packet, logged or not
+ *   6..9  receive timestamp in microseconds (RAIL time, end of packet)
+ *   10    RSSI in dBm
+ *   11    LQI
+ *   12..13 channel
+ *   14..15 packet length as received
+ *   16..  payload, truncated to the configured maximum
+ *   last 2 Fletcher-16 over bytes 2 up to the checksum
+ *
+ * Multi-byte fields are little endian. Gaps in the sequence number mean
+ * records were dropped on the device. A record is at most 18 bytes plus the
+ * logged payload, against roughly 100 characters of formatted text.
+ *
+ * Plain C with no SDK dependencies so tools/kmesh_rxlog_decode.c builds it.
+ ******************************************************************************/
+
+#ifndef KMESH_RXLOG_H
+#define KMESH_RXLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define KMESH_RXLOG_SYNC0            0xA5U
+#define KMESH_RXLOG_SYNC1            0x4BU
+
+#define KMESH_RXLOG_OFFSET_LENGTH    2U
+#define KMESH_RXLOG_OFFSET_FLAGS     3U
+#define KMESH_RXLOG_OFFSET_SEQUENCE  4U
+#define KMESH_RXLOG_OFFSET_TIME      6U
+#define KMESH_RXLOG_OFFSET_RSSI      10U
+#define KMESH_RXLOG_OFFSET_LQI       11U
+#define KMESH_RXLOG_OFFSET_CHANNEL   12U
+#define KMESH_RXLOG_OFFSET_PACKET_LENGTH 14U
+#define KMESH_RXLOG_HEADER_LENGTH    16U
+#define KMESH_RXLOG_CHECKSUM_LENGTH  2U
+#define KMESH_RXLOG_OVERHEAD         (KMESH_RXLOG_HEADER_LENGTH + KMESH_RXLOG_CHECKSUM_LENGTH)
+#define KMESH_RXLOG_MAX_PAYLOAD      (255U - KMESH_RXLOG_OVERHEAD)
+
+#define KMESH_RXLOG_FLAG_CRC_OK      0x01U
+#define KMESH_RXLOG_FLAG_TRUNCATED   0x02U
+#define KMESH_RXLOG_FLAG_ACK         0x04U
+
+typedef struct kmesh_rxlog_record {
+  uint8_t flags;
+  uint16_t sequence;
+  uint32_t time;
+  int8_t rssi;
+  uint8_t lqi;
+  uint16_t channel;
+  uint16_t packet_length;
+  uint8_t payload_length;
+  const uint8_t *payload;
+} kmesh_rxlog_record_t;
+
+static inline uint16_t kmesh_rxlog_fletcher16(const uint8_t *data, size_t length)
+{
+  uint16_t sum1 = 0U;
+  uint16_t sum2 = 0U;
+
+  for (size_t i = 0U; i < length; i++) {
+    sum1 = (uint16_t)((sum1 + data[i]) % 255U);
+    sum2 = (uint16_t)((sum2 + sum1) % 255U);
+  }
+  return (uint16_t)((sum2 << 8) | sum1);
+}
+
+static inline void kmesh_rxlog_put16(uint8_t *out, uint16_t value)
+{
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+}
+
+static inline uint16_t kmesh_rxlog_get16(const uint8_t *in)
+{
+  return (uint16_t)(in[0] | ((uint16_t)in[1] << 8));
+}
+
+// Encode record into out, which must hold KMESH_RXLOG_OVERHEAD plus
+// record->payload_length bytes. Returns the record length.
+static inline uint8_t kmesh_rxlog_encode(uint8_t *out, const kmesh_rxlog_record_t *record)
+{
+  uint8_t length = (uint8_t)(KMESH_RXLOG_OVERHEAD + record->payload_length);
+
+  out[0] = KMESH_RXLOG_SYNC0;
+  out[1] = KMESH_RXLOG_SYNC1;
+  out[KMESH_RXLOG_OFFSET_LENGTH] = length;
+  out[KMESH_RXLOG_OFFSET_FLAGS] = record->flags;
+  kmesh_rxlog_put16(&out[KMESH_RXLOG_OFFSET_SEQUENCE], record->sequence);
+  kmesh_rxlog_put16(&out[KMESH_RXLOG_OFFSET_TIME], (uint16_t)record->time);
+  kmesh_rxlog_put16(&out[KMESH_RXLOG_OFFSET_TIME + 2U], (uint16_t)(record->time >> 16));
+  out[KMESH_RXLOG_OFFSET_RSSI] = (uint8_t)record->rssi;
+  out[KMESH_RXLOG_OFFSET_LQI] = record->lqi;
+  kmesh_rxlog_put16(&out[KMESH_RXLOG_OFFSET_CHANNEL], record->channel);
+  kmesh_rxlog_put16(&out[KMESH_RXLOG_OFFSET_PACKET_LENGTH], record->packet_length);
+  for (uint8_t i = 0U; i < record->payload_length; i++) {
+    out[KMESH_RXLOG_HEADER_LENGTH + i] = record->payload[i];
+  }
+  kmesh_rxlog_put16(&out[length - KMESH_RXLOG_CHECKSUM_LENGTH],
+                    kmesh_rxlog_fletcher16(&out[KMESH_RXLOG_OFFSET_LENGTH],
+                                           length - KMESH_RXLOG_OFFSET_LENGTH
+                                           - KMESH_RXLOG_CHECKSUM_LENGTH));
+  return length;
+}
+
+// Decode the complete record at in, available bytes long. Returns false if
+// it is not a valid record; record->payload points into in.
+static inline bool kmesh_rxlog_decode(const uint8_t *in, size_t available,
+                                      kmesh_rxlog_record_t *record)
+{
+  uint8_t length;
+
+  if (available < KMESH_RXLOG_OVERHEAD
+      || in[0] != KMESH_RXLOG_SYNC0 || in[1] != KMESH_RXLOG_SYNC1) {
+    return false;
+  }
+  length = in[KMESH_RXLOG_OFFSET_LENGTH];
+  if (length < KMESH_RXLOG_OVERHEAD || length > available
+      || kmesh_rxlog_get16(&in[length - KMESH_RXLOG_CHECKSUM_LENGTH])
+      != kmesh_rxlog_fletcher16(&in[KMESH_RXLOG_OFFSET_LENGTH],
+                                length - KMESH_RXLOG_OFFSET_LENGTH
+                                - KMESH_RXLOG_CHECKSUM_LENGTH)) {
+    return false;
+  }
+  record->flags = in[KMESH_RXLOG_OFFSET_FLAGS];
+  record->sequence = kmesh_rxlog_get16(&in[KMESH_RXLOG_OFFSET_SEQUENCE]);
+  record->time = kmesh_rxlog_get16(&in[KMESH_RXLOG_OFFSET_TIME])
+                 | ((uint32_t)kmesh_rxlog_get16(&in[KMESH_RXLOG_OFFSET_TIME + 2U]) << 16);
+  record->rssi = (int8_t)in[KMESH_RXLOG_OFFSET_RSSI];
+  record->lqi = in[KMESH_RXLOG_OFFSET_LQI];
+  record->channel = kmesh_rxlog_get16(&in[KMESH_RXLOG_OFFSET_CHANNEL]);
+  record->packet_length = kmesh_rxlog_get16(&in[KMESH_RXLOG_OFFSET_PACKET_LENGTH]);
+  record->payload_length = (uint8_t)(length - KMESH_RXLOG_OVERHEAD);
+  record->payload = &in[KMESH_RXLOG_HEADER_LENGTH];
+  return true;
+}
+
+#ifndef KMESH_RXLOG_HOST
+#include "rail.h"
+
+typedef struct kmesh_rxlog_counters {
+  uint32_t logged;
+  uint32_t dropped;
+} kmesh_rxlog_counters_t;
+
+extern kmesh_rxlog_counters_t kmesh_rxlog_counters;
+
+// Enable binary logging of every received packet with at most max_payload
+// payload bytes per record (0 = header only).
+void kmesh_rxlog_configure(bool enable, uint8_t max_payload);
+bool kmesh_rxlog_is_enabled(void);
+uint8_t kmesh_rxlog_get_max_payload(void);
+
+// Writes queued records to the console. Called from kmesh_process_action().
+void kmesh_rxlog_process_action(void);
+
+// Captures the newest received packet. Interrupt context.
+void kmesh_rxlog_on_rx(RAIL_Handle_t rail_handle);
+#endif
+
+#endif // KMESH_RXLOG_H
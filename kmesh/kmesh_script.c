@@ -0,0 +1,1191 @@
+/***************************************************************************//**
+ * @file kmesh_script.c
+ * @brief Compiled CLI scripts executed from bytecode.
+ *
+ * runScript hands every stored line back to the CLI parser on each pass. Here
+ * each line is looked up in the command table and its arguments converted
+ * once, when the script is compiled; playback then calls the handlers
+ * directly with pre-built argument vectors. Bytecode is also much denser than
+ * the fixed SL_CLI_INPUT_BUFFER_SIZE text lines of the RAM store, so scripts
+ * can be compiled from several enterScript sessions in a row.
+ *
+ * Besides CLI commands a script may contain these keywords:
+ *
+ *   wait <us> [rel|abs]              pause the player, not the CLI
+ *   waitEvent <event> [timeoutUs]    pause until a RAIL event since the last
+ *                                    waitEvent, e.g. txSent or rx
+ *   set $var <value>, add $var <n>   update $channel, $power or $counter
+ *   repeat <n> ... endRepeat         loop n times, 0 = forever; nestable
+ *
+ * Instructions:
+ *
+ *   CALL        op, command table index (2), argc, argument values
+ *   CALL_VARS   op, command table index (2), argc, variable mask (4), values
+ *   WAIT        op, time in us (4), absolute flag
+ *   WAIT_EVENT  op, event index, timeout in us (4)
+ *   SET, ADD    op, variable, value (4)
+ *   REPEAT      op, count (4)
+ *   END_REPEAT  op, offset of the loop body (2)
+ *
+ * Integer arguments take 1, 2 or 4 bytes, native byte order, according to
+ * the command's argument types; strings are stored NUL terminated. Arguments
+ * whose bit is set in the variable mask hold a variable index instead.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sl_core.h"
+#include "sl_cli.h"
+#include "sl_cli_config.h"
+#include "sl_cli_handles.h"
+#include "sl_cli_storage_ram_instances.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_crc.h"
+#include "kmesh_idle.h"
+#include "kmesh_script.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_SCRIPT_OP_CALL              0x01U
+#define KMESH_SCRIPT_OP_WAIT              0x02U
+#define KMESH_SCRIPT_OP_CALL_VARS         0x03U
+#define KMESH_SCRIPT_OP_WAIT_EVENT        0x04U
+#define KMESH_SCRIPT_OP_SET               0x05U
+#define KMESH_SCRIPT_OP_ADD               0x06U
+#define KMESH_SCRIPT_OP_REPEAT            0x07U
+#define KMESH_SCRIPT_OP_END_REPEAT        0x08U
+
+#define KMESH_SCRIPT_CALL_HEADER_LENGTH   4U
+#define KMESH_SCRIPT_VARS_MASK_LENGTH     4U
+#define KMESH_SCRIPT_WAIT_LENGTH          6U
+#define KMESH_SCRIPT_WAIT_EVENT_LENGTH    6U
+#define KMESH_SCRIPT_VARIABLE_OP_LENGTH   6U
+#define KMESH_SCRIPT_REPEAT_LENGTH        5U
+#define KMESH_SCRIPT_END_REPEAT_LENGTH    3U
+
+#define KMESH_SCRIPT_ARG_TYPE_MASK        0x0FU
+#define KMESH_SCRIPT_ARG_REPEATS          (SL_CLI_ARG_OPTIONAL | SL_CLI_ARG_ADDITIONAL)
+
+// Instructions executed per kmesh_script_process_action() pass before
+// yielding to the rest of the main loop.
+#define KMESH_SCRIPT_STEPS_PER_PASS       16U
+
+typedef struct kmesh_script_event {
+  const char *name;
+  RAIL_Events_t events;
+} kmesh_script_event_t;
+
+typedef struct kmesh_script_loop {
+  uint16_t body;
+  uint32_t remaining;
+} kmesh_script_loop_t;
+
+typedef kmesh_script_status_t (*kmesh_script_keyword_t)(char **tokens, uint8_t count);
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static uint8_t tokenize(char *line, char **tokens, uint8_t max_tokens);
+static kmesh_script_status_t compile_wait(char **tokens, uint8_t count);
+static kmesh_script_status_t compile_wait_event(char **tokens, uint8_t count);
+static kmesh_script_status_t compile_set(char **tokens, uint8_t count);
+static kmesh_script_status_t compile_add(char **tokens, uint8_t count);
+static kmesh_script_status_t compile_repeat(char **tokens, uint8_t count);
+static kmesh_script_status_t compile_end_repeat(char **tokens, uint8_t count);
+static kmesh_script_status_t compile_variable_op(uint8_t op, char **tokens, uint8_t count);
+static kmesh_script_status_t compile_call(char **tokens, uint8_t count);
+static bool parse_argument(const char *token, sl_cli_arg_t type,
+                           uint8_t *out, uint16_t room, uint16_t *length);
+static int8_t parse_variable(const char *token);
+static sl_cli_arg_t argument_type(const sl_cli_arg_t *types, uint8_t index);
+static uint8_t argument_size(sl_cli_arg_t type);
+static void store_value(void *out, uint8_t size, uint32_t value);
+static int16_t find_command(const char *name);
+static bool step(void);
+static void execute_call(void);
+static uint16_t disassemble_call(uint16_t offset, char *line, size_t size);
+static uint16_t instruction_length(uint16_t offset);
+static uint16_t call_length(uint16_t offset);
+static bool validate(void);
+static uint32_t get_u32(uint16_t offset);
+static uint16_t get_u16(uint16_t offset);
+static void put_u32(uint16_t offset, uint32_t value);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+extern const sl_cli_command_entry_t sl_cli_default_command_table[];
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static uint8_t script[KMESH_SCRIPT_SIZE];
+static uint16_t script_size;
+static uint16_t instruction_count;
+// Bodies of repeat blocks whose endRepeat has not been compiled yet.
+static uint16_t open_loops[KMESH_SCRIPT_LOOP_DEPTH];
+static uint8_t open_loop_count;
+
+static bool running;
+static uint16_t pc;
+static uint32_t iterations_left;
+static kmesh_script_loop_t loops[KMESH_SCRIPT_LOOP_DEPTH];
+static uint8_t loop_count;
+static int32_t variables[KMESH_SCRIPT_VARIABLE_COUNT];
+
+static bool waiting;
+static RAIL_Time_t wait_until;
+static RAIL_Events_t wait_events;
+static bool wait_timeout;
+static volatile RAIL_Events_t latched_events;
+static uint32_t event_timeouts;
+
+static const char *const variable_names[KMESH_SCRIPT_VARIABLE_COUNT] = {
+  "channel",
+  "power",
+  "counter",
+};
+
+static const kmesh_script_event_t script_events[] = {
+  { "txSent", RAIL_EVENT_TX_PACKET_SENT },
+  { "txDone", RAIL_EVENTS_TX_COMPLETION },
+  { "txError", RAIL_EVENTS_TX_COMPLETION & ~RAIL_EVENT_TX_PACKET_SENT },
+  { "rx", RAIL_EVENT_RX_PACKET_RECEIVED },
+  { "rxError", RAIL_EVENT_RX_FRAME_ERROR | RAIL_EVENT_RX_PACKET_ABORTED
+    | RAIL_EVENT_RX_FIFO_OVERFLOW },
+  { "rxTimeout", RAIL_EVENT_RX_TIMEOUT },
+};
+
+static const struct {
+  const char *name;
+  kmesh_script_keyword_t compile;
+} keywords[] = {
+  { "wait", compile_wait },
+  { "waitEvent", compile_wait_event },
+  { "set", compile_set },
+  { "add", compile_add },
+  { "repeat", compile_repeat },
+  { "endRepeat", compile_end_repeat },
+};
+
+// Commands that would modify or restart the script underneath the player.
+static const char *const disallowed_commands[] = {
+  "compileScript",
+  "clearCompiledScript",
+  "runCompiledScript",
+  "enterScript",
+  "runScript",
+  "saveScript",
+  "loadScript",
+  "deleteScript",
+  "setScriptAutorun",
+};
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_script_init(void)
+{
+  kmesh_script_clear();
+}
+
+void kmesh_script_process_action(void)
+{
+  for (uint8_t i = 0U; running && i < KMESH_SCRIPT_STEPS_PER_PASS; i++) {
+    if (!step()) {
+      return;
+    }
+  }
+}
+
+uint32_t kmesh_script_idle_us(RAIL_Time_t now)
+{
+  int32_t left = (int32_t)(wait_until - now);
+
+  if (!running) {
+    return KMESH_IDLE_FOREVER;
+  }
+  if (!waiting) {
+    return 0U;
+  }
+  // The awaited event arrives by interrupt, which wakes the main loop.
+  if (wait_events != RAIL_EVENTS_NONE && !wait_timeout) {
+    return KMESH_IDLE_FOREVER;
+  }
+  return (left > 0) ? (uint32_t)left : 0U;
+}
+
+void kmesh_script_on_rail_event(RAIL_Events_t events)
+{
+  if (running) {
+    latched_events |= events;
+  }
+}
+
+kmesh_script_status_t kmesh_script_compile_line(const char *line)
+{
+  char buffer[SL_CLI_INPUT_BUFFER_SIZE];
+  char *tokens[SL_CLI_MAX_INPUT_ARGUMENTS + 1];
+  uint8_t count;
+
+  if (running) {
+    return KMESH_SCRIPT_BUSY;
+  }
+  strncpy(buffer, line, sizeof(buffer) - 1U);
+  buffer[sizeof(buffer) - 1U] = '\0';
+  count = tokenize(buffer, tokens, SL_CLI_MAX_INPUT_ARGUMENTS + 1);
+  if (count == 0U || tokens[0][0] == '#') {
+    return KMESH_SCRIPT_OK;
+  }
+  if (count > SL_CLI_MAX_INPUT_ARGUMENTS) {
+    return KMESH_SCRIPT_TOO_MANY_ARGUMENTS;
+  }
+  for (size_t i = 0U; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+    if (strcmp(tokens[0], keywords[i].name) == 0) {
+      return keywords[i].compile(tokens, count);
+    }
+  }
+  return compile_call(tokens, count);
+}
+
+kmesh_script_status_t kmesh_script_compile_ram_store(uint8_t *failed_line)
+{
+  cli_storage_ram_handle_t store
+    = sl_cli_storage_ram_instances_convert_handle(sl_cli_inst0_handle);
+  uint16_t saved_size = script_size;
+  uint16_t saved_count = instruction_count;
+  uint16_t saved_loops[KMESH_SCRIPT_LOOP_DEPTH];
+  uint8_t saved_loop_count = open_loop_count;
+  kmesh_script_status_t status = KMESH_SCRIPT_OK;
+
+  *failed_line = 0U;
+  if (store == NULL) {
+    return KMESH_SCRIPT_EMPTY;
+  }
+  memcpy(saved_loops, open_loops, sizeof(saved_loops));
+  for (size_t line = 0U; line < store->ram_size; line++) {
+    const char *text = &store->ram_buffer[line * SL_CLI_INPUT_BUFFER_SIZE];
+    if (text[0] == '\0') {
+      break;
+    }
+    status = kmesh_script_compile_line(text);
+    if (status != KMESH_SCRIPT_OK) {
+      *failed_line = (uint8_t)(line + 1U);
+      script_size = saved_size;
+      instruction_count = saved_count;
+      memcpy(open_loops, saved_loops, sizeof(open_loops));
+      open_loop_count = saved_loop_count;
+      break;
+    }
+  }
+  return status;
+}
+
+void kmesh_script_clear(void)
+{
+  kmesh_script_stop();
+  script_size = 0U;
+  instruction_count = 0U;
+  open_loop_count = 0U;
+}
+
+kmesh_script_status_t kmesh_script_check(void)
+{
+  if (script_size == 0U) {
+    return KMESH_SCRIPT_EMPTY;
+  }
+  if (open_loop_count != 0U) {
+    return KMESH_SCRIPT_UNBALANCED;
+  }
+  return KMESH_SCRIPT_OK;
+}
+
+kmesh_script_status_t kmesh_script_load(uint16_t size,
+                                        uint16_t instructions,
+                                        kmesh_script_read_t read,
+                                        void *context)
+{
+  if (running) {
+    return KMESH_SCRIPT_BUSY;
+  }
+  if (size > KMESH_SCRIPT_SIZE) {
+    return KMESH_SCRIPT_FULL;
+  }
+  kmesh_script_clear();
+  if (!read(context, script, size)) {
+    return KMESH_SCRIPT_STORAGE_ERROR;
+  }
+  script_size = size;
+  instruction_count = instructions;
+  if (!validate()) {
+    kmesh_script_clear();
+    return KMESH_SCRIPT_CORRUPT;
+  }
+  return KMESH_SCRIPT_OK;
+}
+
+const uint8_t *kmesh_script_get_bytecode(void)
+{
+  return script;
+}
+
+uint32_t kmesh_script_get_table_fingerprint(void)
+{
+  uint32_t crc = KMESH_CRC_SEED;
+
+  for (uint16_t i = 0U; sl_cli_default_command_table[i].name != NULL; i++) {
+    const sl_cli_command_info_t *command = sl_cli_default_command_table[i].command;
+    const char *name = sl_cli_default_command_table[i].name;
+    uint8_t types = 0U;
+
+    crc = kmesh_crc_table(crc, (const uint8_t *)name, strlen(name) + 1U);
+    if (command == NULL) {
+      continue;
+    }
+    while (command->arg_type_list[types] != SL_CLI_ARG_END) {
+      types++;
+    }
+    crc = kmesh_crc_table(crc, command->arg_type_list, types);
+  }
+  return crc;
+}
+
+kmesh_script_status_t kmesh_script_run(uint32_t iterations)
+{
+  CORE_DECLARE_IRQ_STATE;
+  kmesh_script_status_t status = kmesh_script_check();
+
+  if (status != KMESH_SCRIPT_OK) {
+    return status;
+  }
+  pc = 0U;
+  loop_count = 0U;
+  waiting = false;
+  iterations_left = iterations;
+  event_timeouts = 0U;
+  memset(variables, 0, sizeof(variables));
+  CORE_ENTER_ATOMIC();
+  latched_events = RAIL_EVENTS_NONE;
+  running = true;
+  CORE_EXIT_ATOMIC();
+  return KMESH_SCRIPT_OK;
+}
+
+void kmesh_script_stop(void)
+{
+  running = false;
+  waiting = false;
+  pc = 0U;
+  loop_count = 0U;
+}
+
+bool kmesh_script_is_running(void)
+{
+  return running;
+}
+
+int32_t kmesh_script_get_variable(kmesh_script_variable_t variable)
+{
+  return (variable < KMESH_SCRIPT_VARIABLE_COUNT) ? variables[variable] : 0;
+}
+
+uint32_t kmesh_script_get_event_timeouts(void)
+{
+  return event_timeouts;
+}
+
+uint16_t kmesh_script_get_size(void)
+{
+  return script_size;
+}
+
+uint16_t kmesh_script_get_instruction_count(void)
+{
+  return instruction_count;
+}
+
+const char *kmesh_script_status_string(kmesh_script_status_t status)
+{
+  switch (status) {
+    case KMESH_SCRIPT_OK:                 return "Ok";
+    case KMESH_SCRIPT_UNKNOWN_COMMAND:    return "Unknown command";
+    case KMESH_SCRIPT_BAD_ARGUMENT:       return "Bad argument";
+    case KMESH_SCRIPT_MISSING_ARGUMENT:   return "Missing argument";
+    case KMESH_SCRIPT_TOO_MANY_ARGUMENTS: return "Too many arguments";
+    case KMESH_SCRIPT_NOT_ALLOWED:        return "Command not allowed in a script";
+    case KMESH_SCRIPT_FULL:               return "Script full";
+    case KMESH_SCRIPT_EMPTY:              return "Script empty";
+    case KMESH_SCRIPT_BUSY:               return "Script running";
+    case KMESH_SCRIPT_UNBALANCED:         return "repeat without endRepeat or vice versa";
+    case KMESH_SCRIPT_STALE:              return "Compiled for a different command table";
+    case KMESH_SCRIPT_NO_SLOT:            return "No such script slot";
+    case KMESH_SCRIPT_STORAGE_ERROR:      return "Flash storage error";
+    case KMESH_SCRIPT_CORRUPT:            return "Corrupt bytecode";
+    default:                              return "Unknown";
+  }
+}
+
+uint16_t kmesh_script_disassemble(uint16_t offset, char *line, size_t size)
+{
+  if (offset >= script_size || size == 0U || instruction_length(offset) == 0U) {
+    return 0U;
+  }
+  switch (script[offset]) {
+    case KMESH_SCRIPT_OP_WAIT:
+      (void) snprintf(line, size, "wait %lu %s", (unsigned long)get_u32(offset + 1U),
+                      (script[offset + 5U] != 0U) ? "abs" : "rel");
+      return offset + KMESH_SCRIPT_WAIT_LENGTH;
+    case KMESH_SCRIPT_OP_WAIT_EVENT:
+      (void) snprintf(line, size, "waitEvent %s %lu",
+                      script_events[script[offset + 1U]].name,
+                      (unsigned long)get_u32(offset + 2U));
+      return offset + KMESH_SCRIPT_WAIT_EVENT_LENGTH;
+    case KMESH_SCRIPT_OP_SET:
+    case KMESH_SCRIPT_OP_ADD:
+      (void) snprintf(line, size, "%s $%s %ld",
+                      (script[offset] == KMESH_SCRIPT_OP_SET) ? "set" : "add",
+                      variable_names[script[offset + 1U]],
+                      (long)(int32_t)get_u32(offset + 2U));
+      return offset + KMESH_SCRIPT_VARIABLE_OP_LENGTH;
+    case KMESH_SCRIPT_OP_REPEAT:
+      (void) snprintf(line, size, "repeat %lu", (unsigned long)get_u32(offset + 1U));
+      return offset + KMESH_SCRIPT_REPEAT_LENGTH;
+    case KMESH_SCRIPT_OP_END_REPEAT:
+      (void) snprintf(line, size, "endRepeat");
+      return offset + KMESH_SCRIPT_END_REPEAT_LENGTH;
+    default:
+      return disassemble_call(offset, line, size);
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Split on whitespace in place. Double quotes group a string argument.
+// Returns max_tokens if there are at least that many.
+static uint8_t tokenize(char *line, char **tokens, uint8_t max_tokens)
+{
+  uint8_t count = 0U;
+
+  while (*line != '\0' && count < max_tokens) {
+    char end = ' ';
+    while (*line == ' ' || *line == '\t' || *line == '\r' || *line == '\n') {
+      line++;
+    }
+    if (*line == '\0') {
+      break;
+    }
+    if (*line == '"') {
+      end = '"';
+      line++;
+    }
+    tokens[count++] = line;
+    while (*line != '\0' && *line != end
+           && (end == '"' || (*line != '\t' && *line != '\r' && *line != '\n'))) {
+      line++;
+    }
+    if (*line != '\0') {
+      *line++ = '\0';
+    }
+  }
+  return count;
+}
+
+static kmesh_script_status_t compile_wait(char **tokens, uint8_t count)
+{
+  uint16_t length;
+  uint32_t time;
+
+  if (count < 2U) {
+    return KMESH_SCRIPT_MISSING_ARGUMENT;
+  }
+  if (count > 3U) {
+    return KMESH_SCRIPT_TOO_MANY_ARGUMENTS;
+  }
+  if ((script_size + KMESH_SCRIPT_WAIT_LENGTH) > KMESH_SCRIPT_SIZE) {
+    return KMESH_SCRIPT_FULL;
+  }
+  if (!parse_argument(tokens[1], SL_CLI_ARG_UINT32, (uint8_t *)&time,
+                      sizeof(time), &length)
+      || (count == 3U && strcmp(tokens[2], "abs") != 0
+          && strcmp(tokens[2], "rel") != 0)) {
+    return KMESH_SCRIPT_BAD_ARGUMENT;
+  }
+  script[script_size] = KMESH_SCRIPT_OP_WAIT;
+  put_u32(script_size + 1U, time);
+  script[script_size + 5U] = (count == 3U && strcmp(tokens[2], "abs") == 0) ? 1U : 0U;
+  script_size += KMESH_SCRIPT_WAIT_LENGTH;
+  instruction_count++;
+  return KMESH_SCRIPT_OK;
+}
+
+static kmesh_script_status_t compile_wait_event(char **tokens, uint8_t count)
+{
+  uint16_t length;
+  uint32_t timeout = 0U;
+  uint8_t event;
+
+  if (count < 2U) {
+    return KMESH_SCRIPT_MISSING_ARGUMENT;
+  }
+  if (count > 3U) {
+    return KMESH_SCRIPT_TOO_MANY_ARGUMENTS;
+  }
+  if ((script_size + KMESH_SCRIPT_WAIT_EVENT_LENGTH) > KMESH_SCRIPT_SIZE) {
+    return KMESH_SCRIPT_FULL;
+  }
+  for (event = 0U; event < sizeof(script_events) / sizeof(script_events[0]); event++) {
+    if (strcmp(tokens[1], script_events[event].name) == 0) {
+      break;
+    }
+  }
+  if (event == sizeof(script_events) / sizeof(script_events[0])
+      || (count == 3U && !parse_argument(tokens[2], SL_CLI_ARG_UINT32,
+                                         (uint8_t *)&timeout, sizeof(timeout),
+                                         &length))) {
+    return KMESH_SCRIPT_BAD_ARGUMENT;
+  }
+  script[script_size] = KMESH_SCRIPT_OP_WAIT_EVENT;
+  script[script_size + 1U] = event;
+  put_u32(script_size + 2U, timeout);
+  script_size += KMESH_SCRIPT_WAIT_EVENT_LENGTH;
+  instruction_count++;
+  return KMESH_SCRIPT_OK;
+}
+
+static kmesh_script_status_t compile_set(char **tokens, uint8_t count)
+{
+  return compile_variable_op(KMESH_SCRIPT_OP_SET, tokens, count);
+}
+
+static kmesh_script_status_t compile_add(char **tokens, uint8_t count)
+{
+  return compile_variable_op(KMESH_SCRIPT_OP_ADD, tokens, count);
+}
+
+static kmesh_script_status_t compile_variable_op(uint8_t op, char **tokens, uint8_t count)
+{
+  uint16_t length;
+  int32_t value;
+  int8_t variable;
+
+  if (count < 3U) {
+    return KMESH_SCRIPT_MISSING_ARGUMENT;
+  }
+  if (count > 3U) {
+    return KMESH_SCRIPT_TOO_MANY_ARGUMENTS;
+  }
+  if ((script_size + KMESH_SCRIPT_VARIABLE_OP_LENGTH) > KMESH_SCRIPT_SIZE) {
+    return KMESH_SCRIPT_FULL;
+  }
+  variable = parse_variable(tokens[1]);
+  if (variable < 0
+      || !parse_argument(tokens[2], SL_CLI_ARG_INT32, (uint8_t *)&value,
+                         sizeof(value), &length)) {
+    return KMESH_SCRIPT_BAD_ARGUMENT;
+  }
+  script[script_size] = op;
+  script[script_size + 1U] = (uint8_t)variable;
+  put_u32(script_size + 2U, (uint32_t)value);
+  script_size += KMESH_SCRIPT_VARIABLE_OP_LENGTH;
+  instruction_count++;
+  return KMESH_SCRIPT_OK;
+}
+
+static kmesh_script_status_t compile_repeat(char **tokens, uint8_t count)
+{
+  uint16_t length;
+  uint32_t repeat;
+
+  if (count < 2U) {
+    return KMESH_SCRIPT_MISSING_ARGUMENT;
+  }
+  if (count > 2U) {
+    return KMESH_SCRIPT_TOO_MANY_ARGUMENTS;
+  }
+  if (open_loop_count >= KMESH_SCRIPT_LOOP_DEPTH) {
+    return KMESH_SCRIPT_NOT_ALLOWED;
+  }
+  if ((script_size + KMESH_SCRIPT_REPEAT_LENGTH) > KMESH_SCRIPT_SIZE) {
+    return KMESH_SCRIPT_FULL;
+  }
+  if (!parse_argument(tokens[1], SL_CLI_ARG_UINT32, (uint8_t *)&repeat,
+                      sizeof(repeat), &length)) {
+    return KMESH_SCRIPT_BAD_ARGUMENT;
+  }
+  script[script_size] = KMESH_SCRIPT_OP_REPEAT;
+  put_u32(script_size + 1U, repeat);
+  script_size += KMESH_SCRIPT_REPEAT_LENGTH;
+  open_loops[open_loop_count++] = script_size;
+  instruction_count++;
+  return KMESH_SCRIPT_OK;
+}
+
+static kmesh_script_status_t compile_end_repeat(char **tokens, uint8_t count)
+{
+  uint16_t body;
+
+  (void) tokens;
+  if (count > 1U) {
+    return KMESH_SCRIPT_TOO_MANY_ARGUMENTS;
+  }
+  if (open_loop_count == 0U) {
+    return KMESH_SCRIPT_UNBALANCED;
+  }
+  if ((script_size + KMESH_SCRIPT_END_REPEAT_LENGTH) > KMESH_SCRIPT_SIZE) {
+    return KMESH_SCRIPT_FULL;
+  }
+  body = open_loops[--open_loop_count];
+  script[script_size] = KMESH_SCRIPT_OP_END_REPEAT;
+  script[script_size + 1U] = (uint8_t)body;
+  script[script_size + 2U] = (uint8_t)(body >> 8);
+  script_size += KMESH_SCRIPT_END_REPEAT_LENGTH;
+  instruction_count++;
+  return KMESH_SCRIPT_OK;
+}
+
+static kmesh_script_status_t compile_call(char **tokens, uint8_t count)
+{
+  const sl_cli_arg_t *types;
+  int16_t index = find_command(tokens[0]);
+  // Assume variables are used; the mask is dropped again if none are.
+  uint16_t offset = script_size + KMESH_SCRIPT_CALL_HEADER_LENGTH
+                    + KMESH_SCRIPT_VARS_MASK_LENGTH;
+  uint16_t values = offset;
+  uint8_t argc = count - 1U;
+  uint32_t mask = 0U;
+
+  if (index < 0) {
+    return KMESH_SCRIPT_UNKNOWN_COMMAND;
+  }
+  for (size_t i = 0U; i < sizeof(disallowed_commands) / sizeof(disallowed_commands[0]); i++) {
+    if (strcmp(tokens[0], disallowed_commands[i]) == 0) {
+      return KMESH_SCRIPT_NOT_ALLOWED;
+    }
+  }
+  if (offset > KMESH_SCRIPT_SIZE) {
+    return KMESH_SCRIPT_FULL;
+  }
+
+  types = sl_cli_default_command_table[index].command->arg_type_list;
+  for (uint8_t i = 0U; types[i] != SL_CLI_ARG_END; i++) {
+    if (i >= argc && (types[i] & SL_CLI_ARG_OPTIONAL) == 0U) {
+      return KMESH_SCRIPT_MISSING_ARGUMENT;
+    }
+  }
+  for (uint8_t i = 0U; i < argc; i++) {
+    sl_cli_arg_t type = argument_type(types, i);
+    uint16_t length;
+    if (type == SL_CLI_ARG_END) {
+      return KMESH_SCRIPT_TOO_MANY_ARGUMENTS;
+    }
+    if (tokens[i + 1U][0] == '$') {
+      int8_t variable = parse_variable(tokens[i + 1U]);
+      if (variable < 0 || argument_size(type) == 0U
+          || i >= (KMESH_SCRIPT_VARS_MASK_LENGTH * 8U)) {
+        return KMESH_SCRIPT_BAD_ARGUMENT;
+      }
+      if (offset >= KMESH_SCRIPT_SIZE) {
+        return KMESH_SCRIPT_FULL;
+      }
+      script[offset++] = (uint8_t)variable;
+      mask |= 1UL << i;
+      continue;
+    }
+    if (!parse_argument(tokens[i + 1U], type, &script[offset],
+                        KMESH_SCRIPT_SIZE - offset, &length)) {
+      return (length == 0U) ? KMESH_SCRIPT_FULL : KMESH_SCRIPT_BAD_ARGUMENT;
+    }
+    offset += length;
+  }
+
+  if (mask == 0U) {
+    memmove(&script[values - KMESH_SCRIPT_VARS_MASK_LENGTH], &script[values],
+            offset - values);
+    offset -= KMESH_SCRIPT_VARS_MASK_LENGTH;
+  } else {
+    put_u32(script_size + KMESH_SCRIPT_CALL_HEADER_LENGTH, mask);
+  }
+  script[script_size] = (mask == 0U) ? KMESH_SCRIPT_OP_CALL : KMESH_SCRIPT_OP_CALL_VARS;
+  script[script_size + 1U] = (uint8_t)index;
+  script[script_size + 2U] = (uint8_t)((uint16_t)index >> 8);
+  script[script_size + 3U] = argc;
+  script_size = offset;
+  instruction_count++;
+  return KMESH_SCRIPT_OK;
+}
+
+// Convert a token to its binary form at out. On failure *length is 0 if the
+// value did not fit in room, non-zero if the token itself is invalid.
+static bool parse_argument(const char *token, sl_cli_arg_t type,
+                           uint8_t *out, uint16_t room, uint16_t *length)
+{
+  char *end;
+
+  type &= KMESH_SCRIPT_ARG_TYPE_MASK;
+  *length = (type == SL_CLI_ARG_STRING) ? (uint16_t)(strlen(token) + 1U)
+            : argument_size(type);
+  if (*length == 0U) {
+    *length = 1U;
+    return false;
+  }
+  if (*length > room) {
+    *length = 0U;
+    return false;
+  }
+
+  switch (type) {
+    case SL_CLI_ARG_STRING:
+      memcpy(out, token, *length);
+      return true;
+    case SL_CLI_ARG_UINT8:
+    case SL_CLI_ARG_UINT16:
+    case SL_CLI_ARG_UINT32: {
+      unsigned long value;
+      if (token[0] == '-') {
+        return false;
+      }
+      value = strtoul(token, &end, 0);
+      if (end == token || *end != '\0'
+          || (*length < 4U && value >= (1UL << (*length * 8U)))
+          || value > 0xFFFFFFFFUL) {
+        return false;
+      }
+      store_value(out, (uint8_t)*length, (uint32_t)value);
+      return true;
+    }
+    default: {
+      long value = strtol(token, &end, 0);
+      long limit = (*length < 4U) ? (1L << (*length * 8U - 1U)) : 0x80000000L;
+      if (end == token || *end != '\0' || value < -limit || value > (limit - 1L)) {
+        return false;
+      }
+      store_value(out, (uint8_t)*length, (uint32_t)value);
+      return true;
+    }
+  }
+}
+
+static int8_t parse_variable(const char *token)
+{
+  if (token[0] != '$') {
+    return -1;
+  }
+  for (uint8_t i = 0U; i < KMESH_SCRIPT_VARIABLE_COUNT; i++) {
+    if (strcmp(&token[1], variable_names[i]) == 0) {
+      return (int8_t)i;
+    }
+  }
+  return -1;
+}
+
+// Type of argument index; trailing optional or additional types repeat, as
+// for the byte lists of setTxPayload.
+static sl_cli_arg_t argument_type(const sl_cli_arg_t *types, uint8_t index)
+{
+  uint8_t i;
+
+  for (i = 0U; types[i] != SL_CLI_ARG_END; i++) {
+    if (i == index) {
+      return types[i];
+    }
+  }
+  if (i > 0U && (types[i - 1U] & KMESH_SCRIPT_ARG_REPEATS) != 0U) {
+    return types[i - 1U];
+  }
+  return SL_CLI_ARG_END;
+}
+
+// Bytes taken by an integer argument; 0 for anything else.
+static uint8_t argument_size(sl_cli_arg_t type)
+{
+  switch (type & KMESH_SCRIPT_ARG_TYPE_MASK) {
+    case SL_CLI_ARG_UINT8:
+    case SL_CLI_ARG_INT8:
+      return 1U;
+    case SL_CLI_ARG_UINT16:
+    case SL_CLI_ARG_INT16:
+      return 2U;
+    case SL_CLI_ARG_UINT32:
+    case SL_CLI_ARG_INT32:
+      return 4U;
+    default:
+      return 0U;
+  }
+}
+
+// Store the low size bytes of value the way a size-byte integer is laid out
+// in memory, so signed and unsigned types of that width read it back.
+static void store_value(void *out, uint8_t size, uint32_t value)
+{
+  if (size == 1U) {
+    uint8_t v = (uint8_t)value;
+    memcpy(out, &v, sizeof(v));
+  } else if (size == 2U) {
+    uint16_t v = (uint16_t)value;
+    memcpy(out, &v, sizeof(v));
+  } else {
+    memcpy(out, &value, sizeof(value));
+  }
+}
+
+static int16_t find_command(const char *name)
+{
+  for (int16_t i = 0; sl_cli_default_command_table[i].name != NULL; i++) {
+    if (sl_cli_default_command_table[i].command != NULL
+        && sl_cli_default_command_table[i].command->function != NULL
+        && strcmp(sl_cli_default_command_table[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Execute one instruction. Returns false when the player has to yield.
+static bool step(void)
+{
+  if (waiting) {
+    bool timed_out = (int32_t)(RAIL_GetTime() - wait_until) >= 0;
+    if (wait_events != RAIL_EVENTS_NONE) {
+      CORE_DECLARE_IRQ_STATE;
+      bool fired;
+      CORE_ENTER_ATOMIC();
+      fired = (latched_events & wait_events) != RAIL_EVENTS_NONE;
+      if (fired || (wait_timeout && timed_out)) {
+        latched_events = RAIL_EVENTS_NONE;
+      }
+      CORE_EXIT_ATOMIC();
+      if (!fired && !(wait_timeout && timed_out)) {
+        return false;
+      }
+      if (!fired) {
+        event_timeouts++;
+      }
+    } else if (!timed_out) {
+      return false;
+    }
+    waiting = false;
+  }
+
+  if (pc >= script_size) {
+    pc = 0U;
+    loop_count = 0U;
+    if (iterations_left != 0U && --iterations_left == 0U) {
+      running = false;
+      responsePrint("runCompiledScript", "Status:Done,EventTimeouts:%lu",
+                    event_timeouts);
+    }
+    return false;
+  }
+
+  switch (script[pc]) {
+    case KMESH_SCRIPT_OP_WAIT:
+      wait_until = get_u32(pc + 1U);
+      if (script[pc + 5U] == 0U) {
+        wait_until += RAIL_GetTime();
+      }
+      wait_events = RAIL_EVENTS_NONE;
+      waiting = true;
+      pc += KMESH_SCRIPT_WAIT_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_WAIT_EVENT:
+      wait_events = script_events[script[pc + 1U]].events;
+      wait_timeout = get_u32(pc + 2U) != 0U;
+      wait_until = RAIL_GetTime() + get_u32(pc + 2U);
+      waiting = true;
+      pc += KMESH_SCRIPT_WAIT_EVENT_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_SET:
+      variables[script[pc + 1U]] = (int32_t)get_u32(pc + 2U);
+      pc += KMESH_SCRIPT_VARIABLE_OP_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_ADD:
+      variables[script[pc + 1U]] += (int32_t)get_u32(pc + 2U);
+      pc += KMESH_SCRIPT_VARIABLE_OP_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_REPEAT:
+      pc += KMESH_SCRIPT_REPEAT_LENGTH;
+      loops[loop_count].body = pc;
+      loops[loop_count].remaining = get_u32(pc - 4U);
+      loop_count++;
+      break;
+    case KMESH_SCRIPT_OP_END_REPEAT: {
+      kmesh_script_loop_t *loop = &loops[loop_count - 1U];
+      if (loop->remaining != 0U && --loop->remaining == 0U) {
+        loop_count--;
+        pc += KMESH_SCRIPT_END_REPEAT_LENGTH;
+      } else {
+        pc = loop->body;
+      }
+      break;
+    }
+    default:
+      execute_call();
+      break;
+  }
+  return true;
+}
+
+static void execute_call(void)
+{
+  const sl_cli_command_entry_t *entry
+    = &sl_cli_default_command_table[get_u16(pc + 1U)];
+  uint8_t argc = script[pc + 3U];
+  uint32_t mask = 0U;
+  void *argv[SL_CLI_MAX_INPUT_ARGUMENTS + 1];
+  uint32_t values[SL_CLI_MAX_INPUT_ARGUMENTS];
+  sl_cli_command_arg_t arguments = {
+    .handle = sl_cli_inst0_handle,
+    .argc = argc + 1,
+    .argv = argv,
+    .arg_ofs = 1,
+    .arg_type_list = entry->command->arg_type_list,
+  };
+
+  if (script[pc] == KMESH_SCRIPT_OP_CALL_VARS) {
+    mask = get_u32(pc + KMESH_SCRIPT_CALL_HEADER_LENGTH);
+    pc += KMESH_SCRIPT_VARS_MASK_LENGTH;
+  }
+  argv[0] = (void *)entry->name;
+  pc += KMESH_SCRIPT_CALL_HEADER_LENGTH;
+  for (uint8_t i = 0U; i < argc; i++) {
+    sl_cli_arg_t type = argument_type(entry->command->arg_type_list, i);
+    uint8_t size = argument_size(type);
+    if ((mask & (1UL << i)) != 0U) {
+      // Copy out so handlers can dereference 16- and 32-bit values aligned.
+      store_value(&values[i], size, (uint32_t)variables[script[pc]]);
+      argv[i + 1U] = &values[i];
+      pc++;
+    } else if (size == 0U) {
+      argv[i + 1U] = &script[pc];
+      pc += (uint16_t)strlen((const char *)&script[pc]) + 1U;
+    } else {
+      values[i] = 0U;
+      memcpy(&values[i], &script[pc], size);
+      argv[i + 1U] = &values[i];
+      pc += size;
+    }
+  }
+  entry->command->function(&arguments);
+}
+
+static uint16_t disassemble_call(uint16_t offset, char *line, size_t size)
+{
+  const sl_cli_command_entry_t *entry
+    = &sl_cli_default_command_table[get_u16(offset + 1U)];
+  uint8_t argc = script[offset + 3U];
+  uint32_t mask = 0U;
+  int used;
+
+  if (script[offset] == KMESH_SCRIPT_OP_CALL_VARS) {
+    mask = get_u32(offset + KMESH_SCRIPT_CALL_HEADER_LENGTH);
+    offset += KMESH_SCRIPT_VARS_MASK_LENGTH;
+  }
+  used = snprintf(line, size, "%s", entry->name);
+  offset += KMESH_SCRIPT_CALL_HEADER_LENGTH;
+  for (uint8_t i = 0U; i < argc; i++) {
+    sl_cli_arg_t type = argument_type(entry->command->arg_type_list, i)
+                        & KMESH_SCRIPT_ARG_TYPE_MASK;
+    uint32_t value = 0U;
+    size_t left = (used >= 0 && (size_t)used < size) ? (size - (size_t)used) : 0U;
+
+    if ((mask & (1UL << i)) != 0U) {
+      if (left > 0U) {
+        used += snprintf(&line[used], left, " $%s", variable_names[script[offset]]);
+      }
+      offset++;
+      continue;
+    }
+    if (type == SL_CLI_ARG_STRING) {
+      if (left > 0U) {
+        const char *text = (const char *)&script[offset];
+        used += snprintf(&line[used], left,
+                         (strchr(text, ' ') != NULL) ? " \"%s\"" : " %s", text);
+      }
+      offset += (uint16_t)strlen((const char *)&script[offset]) + 1U;
+      continue;
+    }
+    memcpy(&value, &script[offset], argument_size(type));
+    offset += argument_size(type);
+    if (left == 0U) {
+      continue;
+    }
+    switch (type) {
+      case SL_CLI_ARG_INT8:
+        used += snprintf(&line[used], left, " %d", *(int8_t *)&value);
+        break;
+      case SL_CLI_ARG_INT16:
+        used += snprintf(&line[used], left, " %d", *(int16_t *)&value);
+        break;
+      case SL_CLI_ARG_INT32:
+        used += snprintf(&line[used], left, " %ld", (long)*(int32_t *)&value);
+        break;
+      case SL_CLI_ARG_UINT8:
+        used += snprintf(&line[used], left, " %u", *(uint8_t *)&value);
+        break;
+      case SL_CLI_ARG_UINT16:
+        used += snprintf(&line[used], left, " %u", *(uint16_t *)&value);
+        break;
+      default:
+        used += snprintf(&line[used], left, " %lu", (unsigned long)value);
+        break;
+    }
+  }
+  return offset;
+}
+
+// Bytes taken by the instruction at offset, or 0 if it runs past the end of
+// the script or any of its operands is out of range for this firmware.
+static uint16_t instruction_length(uint16_t offset)
+{
+  uint16_t length;
+
+  switch (script[offset]) {
+    case KMESH_SCRIPT_OP_WAIT:
+      length = KMESH_SCRIPT_WAIT_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_WAIT_EVENT:
+      length = KMESH_SCRIPT_WAIT_EVENT_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_SET:
+    case KMESH_SCRIPT_OP_ADD:
+      length = KMESH_SCRIPT_VARIABLE_OP_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_REPEAT:
+      length = KMESH_SCRIPT_REPEAT_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_END_REPEAT:
+      length = KMESH_SCRIPT_END_REPEAT_LENGTH;
+      break;
+    case KMESH_SCRIPT_OP_CALL:
+    case KMESH_SCRIPT_OP_CALL_VARS:
+      return call_length(offset);
+    default:
+      return 0U;
+  }
+  if ((uint32_t)offset + length > script_size) {
+    return 0U;
+  }
+  if (script[offset] == KMESH_SCRIPT_OP_WAIT_EVENT
+      && script[offset + 1U] >= sizeof(script_events) / sizeof(script_events[0])) {
+    return 0U;
+  }
+  if ((script[offset] == KMESH_SCRIPT_OP_SET || script[offset] == KMESH_SCRIPT_OP_ADD)
+      && script[offset + 1U] >= KMESH_SCRIPT_VARIABLE_COUNT) {
+    return 0U;
+  }
+  return length;
+}
+
+static uint16_t call_length(uint16_t offset)
+{
+  uint16_t start = offset;
+  uint16_t header = KMESH_SCRIPT_CALL_HEADER_LENGTH;
+  const sl_cli_command_entry_t *entry;
+  uint16_t index;
+  uint32_t mask = 0U;
+  uint8_t argc;
+
+  if (script[offset] == KMESH_SCRIPT_OP_CALL_VARS) {
+    header += KMESH_SCRIPT_VARS_MASK_LENGTH;
+  }
+  if ((uint32_t)offset + header > script_size) {
+    return 0U;
+  }
+  index = get_u16(offset + 1U);
+  for (uint16_t i = 0U; i <= index; i++) {
+    if (sl_cli_default_command_table[i].name == NULL) {
+      return 0U;
+    }
+  }
+  entry = &sl_cli_default_command_table[index];
+  argc = script[offset + 3U];
+  if (entry->command == NULL || entry->command->function == NULL
+      || argc > SL_CLI_MAX_INPUT_ARGUMENTS) {
+    return 0U;
+  }
+  if (script[offset] == KMESH_SCRIPT_OP_CALL_VARS) {
+    mask = get_u32(offset + KMESH_SCRIPT_CALL_HEADER_LENGTH);
+  }
+  offset += header;
+  for (uint8_t i = 0U; i < argc; i++) {
+    sl_cli_arg_t type = argument_type(entry->command->arg_type_list, i);
+    uint8_t size = argument_size(type);
+    if (type == SL_CLI_ARG_END || offset >= script_size) {
+      return 0U;
+    }
+    if (i < (KMESH_SCRIPT_VARS_MASK_LENGTH * 8U) && (mask & (1UL << i)) != 0U) {
+      if (size == 0U || script[offset] >= KMESH_SCRIPT_VARIABLE_COUNT) {
+        return 0U;
+      }
+      offset++;
+    } else if (size == 0U) {
+      const uint8_t *end = memchr(&script[offset], '\0', script_size - offset);
+      if (end == NULL) {
+        return 0U;
+      }
+      offset = (uint16_t)(end - script) + 1U;
+    } else {
+      if ((uint32_t)offset + size > script_size) {
+        return 0U;
+      }
+      offset += size;
+    }
+  }
+  return offset - start;
+}
+
+// Check bytecode loaded from storage before it is played or disassembled:
+// every instruction well formed, repeat blocks balanced and pointing back at
+// their own body, and the instruction count as recorded.
+static bool validate(void)
+{
+  uint16_t bodies[KMESH_SCRIPT_LOOP_DEPTH];
+  uint8_t depth = 0U;
+  uint16_t count = 0U;
+  uint16_t offset = 0U;
+
+  while (offset < script_size) {
+    uint16_t length = instruction_length(offset);
+    if (length == 0U) {
+      return false;
+    }
+    if (script[offset] == KMESH_SCRIPT_OP_REPEAT) {
+      if (depth >= KMESH_SCRIPT_LOOP_DEPTH) {
+        return false;
+      }
+      bodies[depth++] = offset + length;
+    } else if (script[offset] == KMESH_SCRIPT_OP_END_REPEAT) {
+      if (depth == 0U || get_u16(offset + 1U) != bodies[--depth]) {
+        return false;
+      }
+    }
+    offset += length;
+    count++;
+  }
+  return depth == 0U && count == instruction_count;
+}
+
+static uint32_t get_u32(uint16_t offset)
+{
+  uint32_t value;
+
+  memcpy(&value, &script[offset], sizeof(value));
+  return value;
+}
+
+static uint16_t get_u16(uint16_t offset)
+{
+  return (uint16_t)(script[offset] | ((uint16_t)script[offset + 1U] << 8));
+}
+
+static void put_u32(uint16_t offset, uint32_t value)
+{
+  memcpy(&script[offset], &value, sizeof(value));
+}
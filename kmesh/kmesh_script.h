@@ -0,0 +1,101 @@
+/***************************************************************************//**
+ * @file kmesh_script.h
+ * @brief Compiled CLI scripts executed from bytecode.
+ ******************************************************************************/
+
+#ifndef KMESH_SCRIPT_H
+#define KMESH_SCRIPT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rail.h"
+
+typedef enum kmesh_script_status {
+  KMESH_SCRIPT_OK,
+  KMESH_SCRIPT_UNKNOWN_COMMAND,
+  KMESH_SCRIPT_BAD_ARGUMENT,
+  KMESH_SCRIPT_MISSING_ARGUMENT,
+  KMESH_SCRIPT_TOO_MANY_ARGUMENTS,
+  KMESH_SCRIPT_NOT_ALLOWED,
+  KMESH_SCRIPT_FULL,
+  KMESH_SCRIPT_EMPTY,
+  KMESH_SCRIPT_BUSY,
+  KMESH_SCRIPT_UNBALANCED,
+  KMESH_SCRIPT_STALE,
+  KMESH_SCRIPT_NO_SLOT,
+  KMESH_SCRIPT_STORAGE_ERROR,
+  KMESH_SCRIPT_CORRUPT,
+} kmesh_script_status_t;
+
+// Fills buffer with the next length bytes of bytecode being loaded.
+typedef bool (*kmesh_script_read_t)(void *context, uint8_t *buffer, uint16_t length);
+
+// Variables scripts can set, step and pass as $channel, $power, $counter
+// wherever a command takes an integer argument.
+typedef enum kmesh_script_variable {
+  KMESH_SCRIPT_VARIABLE_CHANNEL,
+  KMESH_SCRIPT_VARIABLE_POWER,
+  KMESH_SCRIPT_VARIABLE_COUNTER,
+  KMESH_SCRIPT_VARIABLE_COUNT,
+} kmesh_script_variable_t;
+
+void kmesh_script_init(void);
+
+// Runs compiled instructions until the script waits, ends, or has used its
+// share of this pass. Called from kmesh_process_action().
+void kmesh_script_process_action(void);
+
+// Microseconds until the player has to run again, or KMESH_IDLE_FOREVER.
+uint32_t kmesh_script_idle_us(RAIL_Time_t now);
+
+// Latches RAIL events for waitEvent. Interrupt context.
+void kmesh_script_on_rail_event(RAIL_Events_t events);
+
+// Resolve one CLI line against the command table, parse its arguments and
+// append the result to the compiled script.
+kmesh_script_status_t kmesh_script_compile_line(const char *line);
+
+// Compile every line of the RAM script store (enterScript ... endScript),
+// appending to the compiled script. On failure nothing is appended and
+// *failed_line holds the 1-based line that did not compile.
+kmesh_script_status_t kmesh_script_compile_ram_store(uint8_t *failed_line);
+
+void kmesh_script_clear(void);
+
+// KMESH_SCRIPT_OK if the compiled script can be run or saved.
+kmesh_script_status_t kmesh_script_check(void);
+
+// Replace the compiled script with size bytes of previously compiled
+// bytecode supplied by read. The script is left empty if read fails or the
+// bytecode does not decode against this firmware's command table.
+kmesh_script_status_t kmesh_script_load(uint16_t size,
+                                        uint16_t instructions,
+                                        kmesh_script_read_t read,
+                                        void *context);
+const uint8_t *kmesh_script_get_bytecode(void);
+
+// CRC over the names and argument types of the CLI command table. Bytecode
+// refers to commands by table index, so it is only valid for a firmware with
+// the same fingerprint.
+uint32_t kmesh_script_get_table_fingerprint(void);
+
+// Play the compiled script iterations times, 0 meaning until stopped.
+kmesh_script_status_t kmesh_script_run(uint32_t iterations);
+void kmesh_script_stop(void);
+bool kmesh_script_is_running(void);
+
+int32_t kmesh_script_get_variable(kmesh_script_variable_t variable);
+// waitEvent instructions that gave up after their timeout.
+uint32_t kmesh_script_get_event_timeouts(void);
+
+uint16_t kmesh_script_get_size(void);
+uint16_t kmesh_script_get_instruction_count(void);
+const char *kmesh_script_status_string(kmesh_script_status_t status);
+
+// Render the instruction at offset back into CLI text. Returns the offset of
+// the next instruction, or 0 once offset is past the end of the script or
+// the instruction there is malformed.
+uint16_t kmesh_script_disassemble(uint16_t offset, char *line, size_t size);
+
+#endif // KMESH_SCRIPT_H
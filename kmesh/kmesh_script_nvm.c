@@ -0,0 +1,231 @@
+/***************************************************************************//**
+ * @file kmesh_script_nvm.c
+ * @brief Compiled scripts saved to NVM3, with optional autorun at boot.
+ *
+ * Each slot is one object in the default NVM3 instance: a header followed by
+ * the bytecode exactly as compiled, so loading at boot copies it back without
+ * tokenizing or looking up anything. The header records the command table
+ * fingerprint; a slot saved by a firmware whose table differs is listed but
+ * refused by load, since its command indices no longer mean the same thing.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <string.h>
+#include "nvm3_default.h"
+#include "nvm3_default_config.h"
+#include "response_print.h"
+#include "kmesh.h"
+#include "kmesh_script_nvm.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_SCRIPT_NVM_VERSION      1U
+#define KMESH_SCRIPT_NVM_AUTORUN_KEY  (KMESH_SCRIPT_NVM3_KEY_BASE + 0xFFU)
+
+typedef struct kmesh_script_slot_header {
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t size;
+  uint16_t instruction_count;
+  uint16_t reserved2;
+  uint32_t fingerprint;
+  char name[KMESH_SCRIPT_NAME_LENGTH + 1U];
+} kmesh_script_slot_header_t;
+
+typedef struct kmesh_script_autorun {
+  uint8_t slot;
+  uint8_t reserved[3];
+  uint32_t iterations;
+} kmesh_script_autorun_t;
+
+_Static_assert(sizeof(kmesh_script_slot_header_t) + KMESH_SCRIPT_SIZE
+               <= NVM3_DEFAULT_MAX_OBJECT_SIZE,
+               "NVM3_DEFAULT_MAX_OBJECT_SIZE too small for KMESH_SCRIPT_SIZE");
+_Static_assert(KMESH_SCRIPT_SLOTS < 0xFFU, "Slot keys overlap the autorun key");
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static kmesh_script_status_t read_header(uint8_t slot,
+                                         kmesh_script_slot_header_t *header);
+static bool read_bytecode(void *context, uint8_t *buffer, uint16_t length);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+// NVM3 writes an object in one go, so header and bytecode are staged here
+// rather than on the 2 kB main stack.
+static uint8_t slot_object[sizeof(kmesh_script_slot_header_t) + KMESH_SCRIPT_SIZE];
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_script_nvm_init(void)
+{
+  uint32_t iterations;
+  uint8_t slot = kmesh_script_nvm_get_autorun(&iterations);
+  kmesh_script_status_t status;
+
+  if (slot == KMESH_SCRIPT_AUTORUN_NONE) {
+    return;
+  }
+  status = kmesh_script_nvm_load(slot);
+  if (status == KMESH_SCRIPT_OK) {
+    status = kmesh_script_run(iterations);
+  }
+  responsePrint("scriptAutorun", "Slot:%u,Iterations:%lu,Status:%s",
+                slot, iterations, kmesh_script_status_string(status));
+}
+
+kmesh_script_status_t kmesh_script_nvm_save(uint8_t slot, const char *name)
+{
+  kmesh_script_slot_header_t header = { 0 };
+  kmesh_script_status_t status = kmesh_script_check();
+  Ecode_t ecode;
+
+  if (slot >= KMESH_SCRIPT_SLOTS) {
+    return KMESH_SCRIPT_NO_SLOT;
+  }
+  if (status != KMESH_SCRIPT_OK) {
+    return status;
+  }
+  header.version = KMESH_SCRIPT_NVM_VERSION;
+  header.size = kmesh_script_get_size();
+  header.instruction_count = kmesh_script_get_instruction_count();
+  header.fingerprint = kmesh_script_get_table_fingerprint();
+  strncpy(header.name, name, KMESH_SCRIPT_NAME_LENGTH);
+  memcpy(slot_object, &header, sizeof(header));
+  memcpy(&slot_object[sizeof(header)], kmesh_script_get_bytecode(), header.size);
+  ecode = nvm3_writeData(nvm3_defaultHandle, KMESH_SCRIPT_NVM3_KEY_BASE + slot,
+                         slot_object, sizeof(header) + header.size);
+  return (ecode == ECODE_NVM3_OK) ? KMESH_SCRIPT_OK : KMESH_SCRIPT_STORAGE_ERROR;
+}
+
+kmesh_script_status_t kmesh_script_nvm_load(uint8_t slot)
+{
+  kmesh_script_slot_header_t header;
+  nvm3_ObjectKey_t key = KMESH_SCRIPT_NVM3_KEY_BASE + slot;
+  kmesh_script_status_t status = read_header(slot, &header);
+
+  if (status != KMESH_SCRIPT_OK) {
+    return status;
+  }
+  if (header.fingerprint != kmesh_script_get_table_fingerprint()) {
+    return KMESH_SCRIPT_STALE;
+  }
+  return kmesh_script_load(header.size, header.instruction_count,
+                           read_bytecode, &key);
+}
+
+kmesh_script_status_t kmesh_script_nvm_delete(uint8_t slot)
+{
+  uint32_t iterations;
+  Ecode_t ecode;
+
+  if (slot >= KMESH_SCRIPT_SLOTS) {
+    return KMESH_SCRIPT_NO_SLOT;
+  }
+  ecode = nvm3_deleteObject(nvm3_defaultHandle, KMESH_SCRIPT_NVM3_KEY_BASE + slot);
+  if (ecode == ECODE_NVM3_ERR_KEY_NOT_FOUND) {
+    return KMESH_SCRIPT_NO_SLOT;
+  }
+  if (ecode != ECODE_NVM3_OK) {
+    return KMESH_SCRIPT_STORAGE_ERROR;
+  }
+  if (kmesh_script_nvm_get_autorun(&iterations) == slot) {
+    return kmesh_script_nvm_set_autorun(KMESH_SCRIPT_AUTORUN_NONE, 0U);
+  }
+  return KMESH_SCRIPT_OK;
+}
+
+kmesh_script_status_t kmesh_script_nvm_get_info(uint8_t slot,
+                                                kmesh_script_slot_info_t *info)
+{
+  kmesh_script_slot_header_t header;
+  kmesh_script_status_t status = read_header(slot, &header);
+
+  if (status != KMESH_SCRIPT_OK) {
+    return status;
+  }
+  memcpy(info->name, header.name, sizeof(info->name));
+  info->name[KMESH_SCRIPT_NAME_LENGTH] = '\0';
+  info->size = header.size;
+  info->instruction_count = header.instruction_count;
+  info->current = (header.fingerprint == kmesh_script_get_table_fingerprint());
+  return KMESH_SCRIPT_OK;
+}
+
+kmesh_script_status_t kmesh_script_nvm_set_autorun(uint8_t slot, uint32_t iterations)
+{
+  kmesh_script_slot_header_t header;
+  kmesh_script_autorun_t autorun = { .slot = slot, .iterations = iterations };
+  Ecode_t ecode;
+
+  if (slot == KMESH_SCRIPT_AUTORUN_NONE) {
+    ecode = nvm3_deleteObject(nvm3_defaultHandle, KMESH_SCRIPT_NVM_AUTORUN_KEY);
+    return (ecode == ECODE_NVM3_OK || ecode == ECODE_NVM3_ERR_KEY_NOT_FOUND)
+           ? KMESH_SCRIPT_OK : KMESH_SCRIPT_STORAGE_ERROR;
+  }
+  if (read_header(slot, &header) != KMESH_SCRIPT_OK) {
+    return KMESH_SCRIPT_NO_SLOT;
+  }
+  ecode = nvm3_writeData(nvm3_defaultHandle, KMESH_SCRIPT_NVM_AUTORUN_KEY,
+                         &autorun, sizeof(autorun));
+  return (ecode == ECODE_NVM3_OK) ? KMESH_SCRIPT_OK : KMESH_SCRIPT_STORAGE_ERROR;
+}
+
+uint8_t kmesh_script_nvm_get_autorun(uint32_t *iterations)
+{
+  kmesh_script_autorun_t autorun;
+
+  *iterations = 0U;
+  if (nvm3_readData(nvm3_defaultHandle, KMESH_SCRIPT_NVM_AUTORUN_KEY,
+                    &autorun, sizeof(autorun)) != ECODE_NVM3_OK
+      || autorun.slot >= KMESH_SCRIPT_SLOTS) {
+    return KMESH_SCRIPT_AUTORUN_NONE;
+  }
+  *iterations = autorun.iterations;
+  return autorun.slot;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+static kmesh_script_status_t read_header(uint8_t slot,
+                                         kmesh_script_slot_header_t *header)
+{
+  uint32_t type;
+  size_t length;
+
+  if (slot >= KMESH_SCRIPT_SLOTS) {
+    return KMESH_SCRIPT_NO_SLOT;
+  }
+  if (nvm3_getObjectInfo(nvm3_defaultHandle, KMESH_SCRIPT_NVM3_KEY_BASE + slot,
+                         &type, &length) != ECODE_NVM3_OK
+      || type != NVM3_OBJECTTYPE_DATA) {
+    return KMESH_SCRIPT_NO_SLOT;
+  }
+  if (length < sizeof(*header)
+      || nvm3_readPartialData(nvm3_defaultHandle, KMESH_SCRIPT_NVM3_KEY_BASE + slot,
+                              header, 0U, sizeof(*header)) != ECODE_NVM3_OK) {
+    return KMESH_SCRIPT_STORAGE_ERROR;
+  }
+  if (header->version != KMESH_SCRIPT_NVM_VERSION
+      || header->size > KMESH_SCRIPT_SIZE
+      || length != sizeof(*header) + header->size) {
+    return KMESH_SCRIPT_STALE;
+  }
+  return KMESH_SCRIPT_OK;
+}
+
+static bool read_bytecode(void *context, uint8_t *buffer, uint16_t length)
+{
+  const nvm3_ObjectKey_t *key = context;
+
+  return nvm3_readPartialData(nvm3_defaultHandle, *key, buffer,
+                              sizeof(kmesh_script_slot_header_t), length)
+         == ECODE_NVM3_OK;
+}
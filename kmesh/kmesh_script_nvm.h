@@ -0,0 +1,44 @@
+/***************************************************************************//**
+ * @file kmesh_script_nvm.h
+ * @brief Compiled scripts saved to NVM3, with optional autorun at boot.
+ ******************************************************************************/
+
+#ifndef KMESH_SCRIPT_NVM_H
+#define KMESH_SCRIPT_NVM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "kmesh_script.h"
+
+#define KMESH_SCRIPT_NAME_LENGTH     15U
+#define KMESH_SCRIPT_AUTORUN_NONE    0xFFU
+
+typedef struct kmesh_script_slot_info {
+  char name[KMESH_SCRIPT_NAME_LENGTH + 1U];
+  uint16_t size;
+  uint16_t instruction_count;
+  // Saved by a firmware with the same command table, so it can be loaded.
+  bool current;
+} kmesh_script_slot_info_t;
+
+// Loads and starts the autorun slot, if one is set. Called from kmesh_init().
+void kmesh_script_nvm_init(void);
+
+// Save the compiled script, which must be complete, to slot.
+kmesh_script_status_t kmesh_script_nvm_save(uint8_t slot, const char *name);
+
+// Replace the compiled script with the one saved in slot.
+kmesh_script_status_t kmesh_script_nvm_load(uint8_t slot);
+
+kmesh_script_status_t kmesh_script_nvm_delete(uint8_t slot);
+
+// KMESH_SCRIPT_NO_SLOT if slot is out of range or empty.
+kmesh_script_status_t kmesh_script_nvm_get_info(uint8_t slot,
+                                                kmesh_script_slot_info_t *info);
+
+// Run slot iterations times (0 = until stopped) after every boot, or
+// nothing at boot with KMESH_SCRIPT_AUTORUN_NONE.
+kmesh_script_status_t kmesh_script_nvm_set_autorun(uint8_t slot, uint32_t iterations);
+uint8_t kmesh_script_nvm_get_autorun(uint32_t *iterations);
+
+#endif // KMESH_SCRIPT_NVM_H
@@ -0,0 +1,235 @@
+/***************************************************************************//**
+ * @file kmesh_slab.c
+ * @brief Size-class slab allocator behind the buffer pool allocator API.
+ *
+ * The SDK buffer pool hands out BUFFER_POOL_ALLOCATOR_BUFFER_SIZE_MAX bytes
+ * for every request, so five 1068-byte buffers hold five packets however
+ * short they are. Here the same RAM is split into small, medium and
+ * full-size classes, each a free list of fixed blocks: allocation pops the
+ * first class that fits and has a block, falling back to larger ones, and
+ * freeing pushes the block back, both in constant time inside a short
+ * atomic section so RAILtest can keep allocating from the RAIL interrupt.
+ *
+ * RAILtest calls memoryAllocate() and friends directly. The project links
+ * with --wrap for those four symbols, which sends the calls to the
+ * __wrap_ functions at the end of this file; the SDK pool is then never
+ * referenced and --gc-sections drops it.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include <stddef.h>
+#include <string.h>
+#include "sl_core.h"
+#include "buffer_pool_allocator.h"
+#include "buffer_pool_allocator_config.h"
+#include "kmesh.h"
+#include "kmesh_slab.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_SLAB_NONE  0xFFFFU
+
+// Keeps the data that follows word aligned.
+typedef struct kmesh_slab_header {
+  uint16_t next;
+  uint8_t class_index;
+  uint8_t references;
+} kmesh_slab_header_t;
+
+typedef struct kmesh_slab_class {
+  uint8_t *blocks;
+  uint16_t block_size;
+  uint16_t free_head;
+  kmesh_slab_class_info_t info;
+} kmesh_slab_class_t;
+
+#define KMESH_SLAB_BLOCK_SIZE(size) \
+  ((sizeof(kmesh_slab_header_t) + (size) + 3U) & ~3U)
+#define KMESH_SLAB_WORDS(size, count) \
+  ((KMESH_SLAB_BLOCK_SIZE(size) * (count)) / sizeof(uint32_t))
+
+#if (KMESH_SLAB_SMALL_SIZE >= KMESH_SLAB_MEDIUM_SIZE) \
+  || (KMESH_SLAB_MEDIUM_SIZE >= KMESH_SLAB_LARGE_SIZE)
+#error "kmesh slab classes must be in increasing size order"
+#endif
+#if KMESH_SLAB_LARGE_SIZE < BUFFER_POOL_ALLOCATOR_BUFFER_SIZE_MAX
+#error "KMESH_SLAB_LARGE_SIZE must hold BUFFER_POOL_ALLOCATOR_BUFFER_SIZE_MAX"
+#endif
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void init_classes(void);
+static kmesh_slab_header_t *block_header(const kmesh_slab_class_t *slab, uint16_t index);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static uint32_t small_blocks[KMESH_SLAB_WORDS(KMESH_SLAB_SMALL_SIZE, KMESH_SLAB_SMALL_COUNT)];
+static uint32_t medium_blocks[KMESH_SLAB_WORDS(KMESH_SLAB_MEDIUM_SIZE, KMESH_SLAB_MEDIUM_COUNT)];
+static uint32_t large_blocks[KMESH_SLAB_WORDS(KMESH_SLAB_LARGE_SIZE, KMESH_SLAB_LARGE_COUNT)];
+
+static kmesh_slab_class_t classes[KMESH_SLAB_CLASSES] = {
+  { (uint8_t *)small_blocks, KMESH_SLAB_BLOCK_SIZE(KMESH_SLAB_SMALL_SIZE), 0U,
+    { KMESH_SLAB_SMALL_SIZE, KMESH_SLAB_SMALL_COUNT, 0U, 0U, 0U, 0U, 0U } },
+  { (uint8_t *)medium_blocks, KMESH_SLAB_BLOCK_SIZE(KMESH_SLAB_MEDIUM_SIZE), 0U,
+    { KMESH_SLAB_MEDIUM_SIZE, KMESH_SLAB_MEDIUM_COUNT, 0U, 0U, 0U, 0U, 0U } },
+  { (uint8_t *)large_blocks, KMESH_SLAB_BLOCK_SIZE(KMESH_SLAB_LARGE_SIZE), 0U,
+    { KMESH_SLAB_LARGE_SIZE, KMESH_SLAB_LARGE_COUNT, 0U, 0U, 0U, 0U, 0U } },
+};
+
+// RAILtest may allocate before kmesh_init(), so the free lists are built on
+// first use.
+static bool initialized;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void *kmesh_slab_alloc(uint32_t size)
+{
+  kmesh_slab_header_t *header = NULL;
+  uint8_t first = KMESH_SLAB_CLASSES;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (!initialized) {
+    init_classes();
+  }
+  for (uint8_t i = 0U; i < KMESH_SLAB_CLASSES; i++) {
+    kmesh_slab_class_t *slab = &classes[i];
+
+    if (size > slab->info.size) {
+      continue;
+    }
+    if (first == KMESH_SLAB_CLASSES) {
+      first = i;
+    }
+    if (slab->free_head == KMESH_SLAB_NONE) {
+      continue;
+    }
+    header = block_header(slab, slab->free_head);
+    slab->free_head = header->next;
+    header->references = 1U;
+    slab->info.allocations++;
+    slab->info.in_use++;
+    if (slab->info.in_use > slab->info.peak) {
+      slab->info.peak = slab->info.in_use;
+    }
+    if (i != first) {
+      classes[first].info.fallbacks++;
+    }
+    break;
+  }
+  if (header == NULL && first < KMESH_SLAB_CLASSES) {
+    classes[first].info.failures++;
+  }
+  CORE_EXIT_ATOMIC();
+
+  if (header == NULL) {
+    return NULL;
+  }
+#if BUFFER_POOL_ALLOCATOR_CLEAR_ON_INIT
+  memset(header + 1, 0, classes[header->class_index].info.size);
+#endif
+  return header + 1;
+}
+
+void kmesh_slab_free(void *buffer)
+{
+  kmesh_slab_header_t *header;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (buffer == NULL) {
+    return;
+  }
+  header = (kmesh_slab_header_t *)buffer - 1;
+  CORE_ENTER_ATOMIC();
+  if (header->references != 0U && --header->references == 0U) {
+    kmesh_slab_class_t *slab = &classes[header->class_index];
+    header->next = slab->free_head;
+    slab->free_head = (uint16_t)(((uint8_t *)header - slab->blocks) / slab->block_size);
+    slab->info.in_use--;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+void kmesh_slab_take_reference(void *buffer)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  if (buffer == NULL) {
+    return;
+  }
+  CORE_ENTER_ATOMIC();
+  ((kmesh_slab_header_t *)buffer - 1)->references++;
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_slab_get_class_info(uint8_t class_index, kmesh_slab_class_info_t *info)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  if (class_index >= KMESH_SLAB_CLASSES) {
+    return false;
+  }
+  CORE_ENTER_ATOMIC();
+  *info = classes[class_index].info;
+  CORE_EXIT_ATOMIC();
+  return true;
+}
+
+// Buffer pool allocator API, reached through the linker's --wrap. Handles
+// are the data pointers themselves.
+void *__wrap_memoryAllocate(uint32_t size)
+{
+  void *buffer = kmesh_slab_alloc(size);
+
+  return (buffer == NULL) ? INVALID_BUFFER_OBJ : buffer;
+}
+
+void *__wrap_memoryPtrFromHandle(void *handle)
+{
+  return (handle == INVALID_BUFFER_OBJ) ? NULL : handle;
+}
+
+void __wrap_memoryFree(void *handle)
+{
+  if (handle != INVALID_BUFFER_OBJ) {
+    kmesh_slab_free(handle);
+  }
+}
+
+void __wrap_memoryTakeReference(void *handle)
+{
+  if (handle != INVALID_BUFFER_OBJ) {
+    kmesh_slab_take_reference(handle);
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Called with interrupts off.
+static void init_classes(void)
+{
+  for (uint8_t i = 0U; i < KMESH_SLAB_CLASSES; i++) {
+    kmesh_slab_class_t *slab = &classes[i];
+
+    slab->free_head = (slab->info.count == 0U) ? KMESH_SLAB_NONE : 0U;
+    for (uint16_t block = 0U; block < slab->info.count; block++) {
+      kmesh_slab_header_t *header = block_header(slab, block);
+      header->next = (block + 1U < slab->info.count) ? (uint16_t)(block + 1U) : KMESH_SLAB_NONE;
+      header->class_index = i;
+      header->references = 0U;
+    }
+  }
+  initialized = true;
+}
+
+static kmesh_slab_header_t *block_header(const kmesh_slab_class_t *slab, uint16_t index)
+{
+  return (kmesh_slab_header_t *)(void *)&slab->blocks[(size_t)index * slab->block_size];
+}
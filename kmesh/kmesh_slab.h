@@ -0,0 +1,38 @@
+/***************************************************************************//**
+ * @file kmesh_slab.h
+ * @brief Size-class slab allocator behind the buffer pool allocator API.
+ ******************************************************************************/
+
+#ifndef KMESH_SLAB_H
+#define KMESH_SLAB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define KMESH_SLAB_CLASSES  3U
+
+typedef struct kmesh_slab_class_info {
+  uint16_t size;
+  uint16_t count;
+  uint16_t in_use;
+  uint16_t peak;
+  uint32_t allocations;
+  // Served from a larger class because this one was full.
+  uint32_t fallbacks;
+  // Nothing free in this class or any larger one.
+  uint32_t failures;
+} kmesh_slab_class_info_t;
+
+// Allocate a buffer of at least size bytes with a reference count of one.
+// Returns NULL if none is free. Interrupt safe, as are the others.
+void *kmesh_slab_alloc(uint32_t size);
+
+// Drop one reference; the buffer is freed when the last one goes.
+void kmesh_slab_free(void *buffer);
+
+void kmesh_slab_take_reference(void *buffer);
+
+// Returns false for class >= KMESH_SLAB_CLASSES.
+bool kmesh_slab_get_class_info(uint8_t class_index, kmesh_slab_class_info_t *info);
+
+#endif // KMESH_SLAB_H
@@ -0,0 +1,144 @@
+/***************************************************************************//**
+ * @file kmesh_stack.c
+ * @brief Main stack high-water mark, RAIL interrupt entry depth and overflow guard.
+ *
+ * Interrupts run on the same 2 KB main stack as the CLI handlers, so the
+ * worst case is the deepest handler with RAIL's interrupt on top of it. The
+ * free part of the stack is painted with a pattern; the high-water mark is
+ * the lowest word no longer holding it. Painting starts in kmesh_init(), so
+ * anything deeper during earlier platform init is not seen.
+ *
+ * The stack pointer is also sampled on entry to kmesh's RAIL event handler,
+ * to show how deep the stack already is when RAIL interrupts. That is not
+ * the interrupt's peak: kmesh's handler and RAILtest's, called after it by
+ * the generated dispatcher, go further, and only the high-water mark sees it.
+ *
+ * The linker file puts the stack at the bottom of RAM, growing down towards
+ * the start of RAM. The lowest KMESH_STACK_GUARD_SIZE bytes become an MPU
+ * region overlapping the mpu component's RAM region; any access to it,
+ * read or write, takes a MemManage fault at the push that overflows instead
+ * of at whatever lies below the start of RAM.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "em_device.h"
+#include "sl_core.h"
+#include "kmesh.h"
+#include "kmesh_stack.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_STACK_PAINT       0xCDCDCDCDUL
+// Left unpainted below the painting function's own frame.
+#define KMESH_STACK_MARGIN      64U
+// ARMv8-M MPU regions are 32-byte aligned.
+#define KMESH_STACK_MPU_ALIGN   32U
+
+#if (KMESH_STACK_GUARD_SIZE % KMESH_STACK_MPU_ALIGN) != 0
+#error "KMESH_STACK_GUARD_SIZE must be a multiple of 32"
+#endif
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static void paint(void);
+static void guard_enable(void);
+
+// -----------------------------------------------------------------------------
+//                                Global Variables
+// -----------------------------------------------------------------------------
+// Provided by the linker file.
+extern uint32_t __StackLimit;
+extern uint32_t __StackTop;
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static uint32_t *stack_bottom;
+static uint32_t guard_size;
+static volatile uint32_t rail_isr_entry_lowest;
+static volatile uint32_t rail_isr_calls;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_stack_init(void)
+{
+  stack_bottom = &__StackLimit;
+  guard_enable();
+  kmesh_stack_reset();
+}
+
+void kmesh_stack_reset(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  paint();
+  rail_isr_entry_lowest = (uint32_t)(uintptr_t)&__StackTop;
+  rail_isr_calls = 0U;
+  CORE_EXIT_ATOMIC();
+}
+
+void kmesh_stack_get_usage(kmesh_stack_usage_t *usage)
+{
+  const uint32_t *at = stack_bottom;
+
+  while (at < &__StackTop && *at == KMESH_STACK_PAINT) {
+    at++;
+  }
+  usage->guard = guard_size;
+  usage->size = (uint32_t)((uintptr_t)&__StackTop - (uintptr_t)stack_bottom);
+  usage->high_water = (uint32_t)((uintptr_t)&__StackTop - (uintptr_t)at);
+  usage->rail_isr_entry = (uint32_t)(uintptr_t)&__StackTop - rail_isr_entry_lowest;
+  usage->rail_isr_calls = rail_isr_calls;
+}
+
+void kmesh_stack_on_rail_event(void)
+{
+  uint32_t sp = __get_MSP();
+
+  if (sp < rail_isr_entry_lowest) {
+    rail_isr_entry_lowest = sp;
+  }
+  rail_isr_calls++;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// Interrupts off, or they would leave frames below the paint.
+static void paint(void)
+{
+  uint32_t *end = (uint32_t *)(uintptr_t)((__get_MSP() - KMESH_STACK_MARGIN) & ~3UL);
+
+  for (uint32_t *at = stack_bottom; at < end; at++) {
+    *at = KMESH_STACK_PAINT;
+  }
+}
+
+static void guard_enable(void)
+{
+#if KMESH_STACK_GUARD_SIZE > 0
+  uint32_t regions = (MPU->TYPE & MPU_TYPE_DREGION_Msk) >> MPU_TYPE_DREGION_Pos;
+  uint32_t base = ((uint32_t)(uintptr_t)&__StackLimit + KMESH_STACK_MPU_ALIGN - 1U)
+                  & ~(KMESH_STACK_MPU_ALIGN - 1U);
+  uint32_t control = MPU->CTRL & ~MPU_CTRL_ENABLE_Msk;
+
+  if (regions == 0U) {
+    return;
+  }
+  // The mpu component fills the low regions; take the last one. The region
+  // is read-only and privileged anyway in case nothing else covers it.
+  ARM_MPU_Disable();
+  ARM_MPU_SetRegion(regions - 1U,
+                    ARM_MPU_RBAR(base, ARM_MPU_SH_NON, 1U, 0U, 1U),
+                    ARM_MPU_RLAR(base + KMESH_STACK_GUARD_SIZE - 1U, 0U));
+  ARM_MPU_Enable(control | MPU_CTRL_PRIVDEFENA_Msk);
+  stack_bottom = (uint32_t *)(uintptr_t)(base + KMESH_STACK_GUARD_SIZE);
+  guard_size = (uint32_t)((uintptr_t)stack_bottom - (uintptr_t)&__StackLimit);
+#endif
+}
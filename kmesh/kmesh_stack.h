@@ -0,0 +1,35 @@
+/***************************************************************************//**
+ * @file kmesh_stack.h
+ * @brief Main stack high-water mark, RAIL interrupt entry depth and overflow guard.
+ ******************************************************************************/
+
+#ifndef KMESH_STACK_H
+#define KMESH_STACK_H
+
+#include <stdint.h>
+
+typedef struct kmesh_stack_usage {
+  uint32_t size;           // Usable bytes, guard excluded
+  uint32_t guard;          // Bytes at the bottom that fault when touched
+  uint32_t high_water;     // Deepest use seen since the last paint
+  // Deepest stack on entry to kmesh's RAIL event handler. Only a sample: the
+  // handler's own frames and RAILtest's handler, which runs after it, go
+  // deeper; high_water covers them.
+  uint32_t rail_isr_entry;
+  uint32_t rail_isr_calls;
+} kmesh_stack_usage_t;
+
+// Paints the unused part of the stack and sets up the MPU guard. Called
+// first thing in kmesh_init().
+void kmesh_stack_init(void);
+
+// Repaints the unused part of the stack and clears the peaks, to measure a
+// single operation.
+void kmesh_stack_reset(void);
+
+void kmesh_stack_get_usage(kmesh_stack_usage_t *usage);
+
+// Samples the stack depth on entry. Called first in kmesh_on_rail_event().
+void kmesh_stack_on_rail_event(void);
+
+#endif // KMESH_STACK_H
@@ -0,0 +1,213 @@
+/***************************************************************************//**
+ * @file kmesh_tpc.c
+ * @brief Per-neighbor TX power control from the RSSI reported in ACKs.
+ *
+ * Every kmesh ACK carries the RSSI at which the acknowledging node heard the
+ * frame. When that node is also the frame's next hop, the RSSI measures our
+ * own transmission over that link, so the power for the neighbor can be moved
+ * by the difference to the target RSSI. A difference within the hysteresis
+ * leaves it alone, a decrease is limited to KMESH_TPC_MAX_STEP_DOWN_DB per ACK
+ * and an increase is applied at once. A missing ACK adds KMESH_TPC_MISS_STEP_DB.
+ *
+ * Frames are sent at the power of their next hop, switched with a raw PA
+ * level converted once per change so the per-packet cost is a register
+ * write. Broadcasts and neighbors without feedback use the ceiling, and the
+ * power RAILtest had is put back after every kmesh transmission.
+ ******************************************************************************/
+
+// -----------------------------------------------------------------------------
+//                                   Includes
+// -----------------------------------------------------------------------------
+#include "sl_core.h"
+#include "kmesh.h"
+#include "kmesh_neighbor.h"
+#include "kmesh_tpc.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros and Typedefs
+// -----------------------------------------------------------------------------
+#define KMESH_TPC_DDBM_PER_DB 10
+
+typedef struct kmesh_tpc_entry {
+  kmesh_neighbor_entry_t header;
+  kmesh_tpc_neighbor_t neighbor;
+  RAIL_TxPowerLevel_t level;
+} kmesh_tpc_entry_t;
+
+// -----------------------------------------------------------------------------
+//                          Static Function Declarations
+// -----------------------------------------------------------------------------
+static kmesh_tpc_entry_t *claim_entry(uint16_t address);
+static void set_power(kmesh_tpc_entry_t *entry, int32_t power_ddbm);
+
+// -----------------------------------------------------------------------------
+//                                Static Variables
+// -----------------------------------------------------------------------------
+static kmesh_tpc_entry_t entries[KMESH_TPC_NEIGHBORS];
+static const kmesh_neighbor_table_t table = KMESH_NEIGHBOR_TABLE(entries);
+
+static bool enabled;
+static int8_t target_rssi = KMESH_TPC_TARGET_RSSI_DBM;
+static uint8_t hysteresis_db = KMESH_TPC_HYSTERESIS_DB;
+static int16_t min_power_ddbm = KMESH_TPC_MIN_POWER_DDBM;
+static int16_t max_power_ddbm;
+static RAIL_TxPowerMode_t pa_mode;
+
+static bool applied;
+static RAIL_TxPowerLevel_t saved_level;
+
+// -----------------------------------------------------------------------------
+//                          Public Function Definitions
+// -----------------------------------------------------------------------------
+void kmesh_tpc_configure(bool enable, int8_t target, uint8_t hysteresis,
+                         int16_t min_power)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  RAIL_TxPowerConfig_t config;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  kmesh_tpc_restore();
+  kmesh_neighbor_clear(&table);
+  target_rssi = target;
+  hysteresis_db = hysteresis;
+  min_power_ddbm = min_power;
+  max_power_ddbm = RAIL_GetTxPowerDbm(rail_handle);
+  if (RAIL_GetTxPowerConfig(rail_handle, &config) == RAIL_STATUS_NO_ERROR) {
+    pa_mode = config.mode;
+  }
+  if (min_power_ddbm > max_power_ddbm) {
+    min_power_ddbm = max_power_ddbm;
+  }
+  enabled = enable;
+  CORE_EXIT_ATOMIC();
+}
+
+bool kmesh_tpc_is_enabled(void)
+{
+  return enabled;
+}
+
+int8_t kmesh_tpc_get_target_rssi(void)
+{
+  return target_rssi;
+}
+
+uint8_t kmesh_tpc_get_hysteresis_db(void)
+{
+  return hysteresis_db;
+}
+
+int16_t kmesh_tpc_get_min_power(void)
+{
+  return min_power_ddbm;
+}
+
+int16_t kmesh_tpc_get_max_power(void)
+{
+  return max_power_ddbm;
+}
+
+void kmesh_tpc_apply(uint16_t next_hop)
+{
+  RAIL_Handle_t rail_handle = kmesh_get_rail_handle();
+  kmesh_tpc_entry_t *entry;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!enabled || next_hop == KMESH_ADDRESS_BROADCAST) {
+    return;
+  }
+  CORE_ENTER_ATOMIC();
+  entry = kmesh_neighbor_find(&table, next_hop);
+  if (entry != NULL && !applied) {
+    saved_level = RAIL_GetTxPower(rail_handle);
+    applied = RAIL_SetTxPower(rail_handle, entry->level) == RAIL_STATUS_NO_ERROR;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+void kmesh_tpc_restore(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (applied) {
+    applied = false;
+    (void) RAIL_SetTxPower(kmesh_get_rail_handle(), saved_level);
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+void kmesh_tpc_on_ack(uint16_t neighbor, int8_t rssi)
+{
+  kmesh_tpc_entry_t *entry;
+  int32_t error_db = (int32_t)rssi - target_rssi;
+
+  if (!enabled || rssi == RAIL_RSSI_INVALID_DBM) {
+    return;
+  }
+  entry = claim_entry(neighbor);
+  entry->neighbor.acks++;
+  entry->neighbor.last_rssi = rssi;
+  if (error_db > (int32_t)hysteresis_db) {
+    if (error_db > KMESH_TPC_MAX_STEP_DOWN_DB) {
+      error_db = KMESH_TPC_MAX_STEP_DOWN_DB;
+    }
+    set_power(entry, entry->neighbor.power_ddbm - error_db * KMESH_TPC_DDBM_PER_DB);
+  } else if (error_db < -(int32_t)hysteresis_db) {
+    set_power(entry, entry->neighbor.power_ddbm - error_db * KMESH_TPC_DDBM_PER_DB);
+  }
+}
+
+void kmesh_tpc_on_miss(uint16_t neighbor)
+{
+  kmesh_tpc_entry_t *entry = kmesh_neighbor_find(&table, neighbor);
+
+  if (!enabled || entry == NULL) {
+    return;
+  }
+  entry->neighbor.misses++;
+  set_power(entry, entry->neighbor.power_ddbm
+            + KMESH_TPC_MISS_STEP_DB * KMESH_TPC_DDBM_PER_DB);
+}
+
+bool kmesh_tpc_get_neighbor(uint8_t index, kmesh_tpc_neighbor_t *neighbor)
+{
+  const kmesh_tpc_entry_t *entry = kmesh_neighbor_get(&table, index);
+
+  if (entry == NULL) {
+    return false;
+  }
+  *neighbor = entry->neighbor;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+//                          Static Function Definitions
+// -----------------------------------------------------------------------------
+// The neighbor's entry, a new one started at the ceiling if it had none.
+static kmesh_tpc_entry_t *claim_entry(uint16_t address)
+{
+  bool claimed;
+  kmesh_tpc_entry_t *entry = kmesh_neighbor_claim(&table, address, &claimed);
+
+  if (claimed) {
+    entry->neighbor.address = address;
+    entry->neighbor.last_rssi = RAIL_RSSI_INVALID_DBM;
+    set_power(entry, max_power_ddbm);
+  }
+  return entry;
+}
+
+static void set_power(kmesh_tpc_entry_t *entry, int32_t power_ddbm)
+{
+  if (power_ddbm > max_power_ddbm) {
+    power_ddbm = max_power_ddbm;
+  }
+  if (power_ddbm < min_power_ddbm) {
+    power_ddbm = min_power_ddbm;
+  }
+  entry->neighbor.power_ddbm = (int16_t)power_ddbm;
+  entry->level = RAIL_ConvertDbmToRaw(kmesh_get_rail_handle(), pa_mode,
+                                      (RAIL_TxPower_t)power_ddbm);
+}
@@ -0,0 +1,45 @@
+/***************************************************************************//**
+ * @file kmesh_tpc.h
+ * @brief Per-neighbor TX power control from the RSSI reported in ACKs.
+ ******************************************************************************/
+
+#ifndef KMESH_TPC_H
+#define KMESH_TPC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rail.h"
+
+typedef struct kmesh_tpc_neighbor {
+  uint16_t address;
+  // Power used for frames to this neighbor, and the RSSI it last reported.
+  int16_t power_ddbm;
+  int8_t last_rssi;
+  uint32_t acks;
+  uint32_t misses;
+} kmesh_tpc_neighbor_t;
+
+// Enabling takes the present TX power as the ceiling and starts every
+// neighbor there. Disabling transmits at the ceiling again.
+void kmesh_tpc_configure(bool enable, int8_t target_rssi, uint8_t hysteresis_db,
+                         int16_t min_power_ddbm);
+bool kmesh_tpc_is_enabled(void);
+int8_t kmesh_tpc_get_target_rssi(void);
+uint8_t kmesh_tpc_get_hysteresis_db(void);
+int16_t kmesh_tpc_get_min_power(void);
+int16_t kmesh_tpc_get_max_power(void);
+
+// Switch to the power of next_hop right before RAIL_StartTx(), and back
+// once the transmission is over or failed to start.
+void kmesh_tpc_apply(uint16_t next_hop);
+void kmesh_tpc_restore(void);
+
+// Feedback from the ARQ: the RSSI at which neighbor heard our frame, or an
+// ACK that never came. Interrupt context.
+void kmesh_tpc_on_ack(uint16_t neighbor, int8_t rssi);
+void kmesh_tpc_on_miss(uint16_t neighbor);
+
+// Copy out entry index; returns false past the last valid entry.
+bool kmesh_tpc_get_neighbor(uint8_t index, kmesh_tpc_neighbor_t *neighbor);
+
+#endif // KMESH_TPC_H
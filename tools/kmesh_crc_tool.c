@@ -0,0 +1,252 @@
+/***************************************************************************//**
+ * @file kmesh_crc_tool.c
+ * @brief Host verification and benchmark harness for kmesh_crc.c.
+ *
+ * Build from the project root:
+ *
+ *   gcc -O2 -DKMESH_CRC_SLICE_BY_8=1 -Ikmesh -Iconfig \
+ *       -o kmesh_crc_tool tools/kmesh_crc_tool.c kmesh/kmesh_crc.c
+ *
+ * Usage:
+ *
+ *   kmesh_crc_tool selftest
+ *   kmesh_crc_tool verify [--dewhitened] <capture.txt>
+ *   kmesh_crc_tool bench [length] [megabytes]
+ *
+ * A capture holds one over-the-air frame per line as hex bytes, optionally
+ * 0x prefixed and separated by spaces, commas or nothing: the 2-byte length
+ * header, the payload and the 4 CRC bytes, still whitened unless
+ * --dewhitened is given. Lines starting with '#' are ignored. verify exits
+ * non-zero if any frame fails.
+ ******************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "kmesh_crc.h"
+
+#if !KMESH_CRC_SLICE_BY_8
+#error "Build the host tool with -DKMESH_CRC_SLICE_BY_8=1"
+#endif
+
+#define MAX_FRAME_LENGTH 2049U
+#define MAX_LINE_LENGTH  (MAX_FRAME_LENGTH * 5U + 2U)
+
+static int parse_hex_line(const char *line, uint8_t *frame, size_t *length)
+{
+  *length = 0U;
+  while (*line != '\0') {
+    if (isspace((unsigned char)*line) || *line == ',') {
+      line++;
+      continue;
+    }
+    if (line[0] == '0' && (line[1] == 'x' || line[1] == 'X')) {
+      line += 2;
+    }
+    if (!isxdigit((unsigned char)line[0]) || !isxdigit((unsigned char)line[1])
+        || *length >= MAX_FRAME_LENGTH) {
+      return -1;
+    }
+    char byte[3] = { line[0], line[1], '\0' };
+    frame[(*length)++] = (uint8_t)strtoul(byte, NULL, 16);
+    line += 2;
+  }
+  return 0;
+}
+
+static int selftest(void)
+{
+  static uint8_t data[4096];
+  const uint8_t check[] = "123456789";
+  const uint8_t pn9_start[] = { 0xFF, 0xE1, 0x1D, 0x9A, 0xED, 0x85, 0x33, 0x24 };
+  uint8_t pn9[sizeof(pn9_start)] = { 0 };
+  uint16_t state = KMESH_WHITEN_SEED;
+  int failures = 0;
+
+  if (kmesh_crc_bitwise(KMESH_CRC_SEED, check, 9U) != KMESH_CRC_CHECK_VALUE) {
+    printf("FAIL bitwise check value\n");
+    failures++;
+  }
+  kmesh_whiten(&state, pn9, sizeof(pn9));
+  if (memcmp(pn9, pn9_start, sizeof(pn9)) != 0) {
+    printf("FAIL PN9 sequence\n");
+    failures++;
+  }
+
+  srand(1);
+  for (size_t i = 0U; i < sizeof(data); i++) {
+    data[i] = (uint8_t)rand();
+  }
+  // Every length and alignment up to a few slices, then one long buffer.
+  for (size_t offset = 0U; offset < 8U; offset++) {
+    for (size_t length = 0U; length < 64U; length++) {
+      uint32_t reference = kmesh_crc_bitwise(KMESH_CRC_SEED, &data[offset], length);
+      if (kmesh_crc_table(KMESH_CRC_SEED, &data[offset], length) != reference
+          || kmesh_crc_slice8(KMESH_CRC_SEED, &data[offset], length) != reference) {
+        printf("FAIL CRC offset %zu length %zu\n", offset, length);
+        failures++;
+      }
+    }
+  }
+  if (kmesh_crc_slice8(KMESH_CRC_SEED, data, sizeof(data))
+      != kmesh_crc_bitwise(KMESH_CRC_SEED, data, sizeof(data))) {
+    printf("FAIL CRC %zu bytes\n", sizeof(data));
+    failures++;
+  }
+
+  // Whitening in odd-sized pieces must match one pass, and undo itself.
+  {
+    uint8_t whole[257];
+    uint8_t pieces[sizeof(whole)];
+    uint16_t whole_state = KMESH_WHITEN_SEED;
+    uint16_t piece_state = KMESH_WHITEN_SEED;
+    size_t done = 0U;
+
+    memcpy(whole, data, sizeof(whole));
+    memcpy(pieces, data, sizeof(pieces));
+    kmesh_whiten(&whole_state, whole, sizeof(whole));
+    while (done < sizeof(pieces)) {
+      size_t step = (sizeof(pieces) - done < 7U) ? (sizeof(pieces) - done) : 7U;
+      kmesh_whiten(&piece_state, &pieces[done], step);
+      done += step;
+    }
+    whole_state = KMESH_WHITEN_SEED;
+    kmesh_whiten(&whole_state, pieces, sizeof(pieces));
+    if (memcmp(pieces, data, sizeof(pieces)) != 0) {
+      printf("FAIL whitening round trip\n");
+      failures++;
+    }
+  }
+
+  printf("selftest: %s\n", (failures == 0) ? "PASS" : "FAIL");
+  return (failures == 0) ? 0 : 1;
+}
+
+static int verify(const char *path, bool whitened)
+{
+  static char line[MAX_LINE_LENGTH];
+  static uint8_t frame[MAX_FRAME_LENGTH];
+  unsigned int line_number = 0U;
+  unsigned int passed = 0U;
+  unsigned int failed = 0U;
+  FILE *file = fopen(path, "r");
+
+  if (file == NULL) {
+    perror(path);
+    return 2;
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    size_t length;
+    uint16_t header_length;
+
+    line_number++;
+    if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') {
+      continue;
+    }
+    if (parse_hex_line(line, frame, &length) != 0 || length < 2U) {
+      printf("%s:%u: cannot parse\n", path, line_number);
+      failed++;
+      continue;
+    }
+    header_length = (uint16_t)((((uint16_t)frame[0] << 8) | frame[1]) & 0x07FFU);
+    if ((size_t)header_length + 2U != length) {
+      printf("%s:%u: length header %u, %zu bytes follow\n",
+             path, line_number, header_length, length - 2U);
+      failed++;
+      continue;
+    }
+    if (!kmesh_crc_check_frame(frame, length, whitened)) {
+      printf("%s:%u: CRC mismatch\n", path, line_number);
+      failed++;
+      continue;
+    }
+    passed++;
+  }
+  fclose(file);
+  printf("verify: %u passed, %u failed\n", passed, failed);
+  return (failed == 0U) ? 0 : 1;
+}
+
+static double seconds_since(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void bench(size_t length, size_t megabytes)
+{
+  uint8_t *data = malloc(length);
+  size_t rounds = (megabytes * 1000000U + length - 1U) / length;
+  volatile uint32_t sink = 0U;
+  uint16_t state = KMESH_WHITEN_SEED;
+  clock_t start;
+  double mb = (double)(rounds * length) / 1e6;
+
+  if (data == NULL) {
+    return;
+  }
+  for (size_t i = 0U; i < length; i++) {
+    data[i] = (uint8_t)i;
+  }
+  (void) kmesh_crc_slice8(KMESH_CRC_SEED, data, 0U);
+  printf("%zu-byte buffers, %.1f MB each\n", length, mb);
+
+  start = clock();
+  for (size_t i = 0U; i < rounds / 8U; i++) {
+    sink ^= kmesh_crc_bitwise(KMESH_CRC_SEED, data, length);
+  }
+  printf("  crc bitwise  %8.1f MB/s\n", mb / 8.0 / seconds_since(start));
+
+  start = clock();
+  for (size_t i = 0U; i < rounds; i++) {
+    sink ^= kmesh_crc_table(KMESH_CRC_SEED, data, length);
+  }
+  printf("  crc table    %8.1f MB/s\n", mb / seconds_since(start));
+
+  start = clock();
+  for (size_t i = 0U; i < rounds; i++) {
+    sink ^= kmesh_crc_slice8(KMESH_CRC_SEED, data, length);
+  }
+  printf("  crc slice8   %8.1f MB/s\n", mb / seconds_since(start));
+
+  start = clock();
+  for (size_t i = 0U; i < rounds; i++) {
+    kmesh_whiten(&state, data, length);
+  }
+  printf("  whiten       %8.1f MB/s\n", mb / seconds_since(start));
+
+  (void) sink;
+  free(data);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc >= 2 && strcmp(argv[1], "selftest") == 0) {
+    return selftest();
+  }
+  if (argc >= 3 && strcmp(argv[1], "verify") == 0) {
+    bool whitened = (strcmp(argv[2], "--dewhitened") != 0);
+    if (!whitened && argc < 4) {
+      fprintf(stderr, "missing capture file\n");
+      return 2;
+    }
+    return verify(argv[whitened ? 2 : 3], whitened);
+  }
+  if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+    size_t length = (argc >= 3) ? strtoul(argv[2], NULL, 0) : 255U;
+    size_t megabytes = (argc >= 4) ? strtoul(argv[3], NULL, 0) : 64U;
+    if (length == 0U || megabytes == 0U) {
+      fprintf(stderr, "length and megabytes must be non-zero\n");
+      return 2;
+    }
+    bench(length, megabytes);
+    return 0;
+  }
+  fprintf(stderr,
+          "usage: %s selftest\n"
+          "       %s verify [--dewhitened] <capture.txt>\n"
+          "       %s bench [length] [megabytes]\n",
+          argv[0], argv[0], argv[0]);
+  return 2;
+}
@@ -0,0 +1,307 @@
+/***************************************************************************//**
+ * @file kmesh_frame_tool.c
+ * @brief Host round-trip, fuzz and benchmark harness for kmesh_frame.h.
+ *
+ * Build from the project root:
+ *
+ *   gcc -O2 -Ikmesh -o kmesh_frame_tool tools/kmesh_frame_tool.c
+ *
+ * Usage:
+ *
+ *   kmesh_frame_tool selftest
+ *   kmesh_frame_tool fuzz [iterations] [seed]
+ *   kmesh_frame_tool bench [megaframes]
+ *
+ * selftest checks every representable length and a set of headers and
+ * aggregate messages against hand-assembled bytes. fuzz decodes random
+ * buffers with random received lengths and checks that only consistent
+ * frames are accepted and that they re-encode to the same bytes. Both exit
+ * non-zero on the first class of failure found.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "kmesh_frame.h"
+
+#define MAX_FRAME_LENGTH KMESH_FRAME_LENGTH_LIMIT
+
+static uint32_t random_state = 1U;
+
+// xorshift32, so runs repeat across C libraries for a given seed.
+static uint32_t random_next(void)
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static void random_header(kmesh_frame_header_t *header)
+{
+  uint32_t value = random_next();
+
+  header->length = (uint16_t)(KMESH_FRAME_HEADER_LENGTH
+                              + random_next() % (KMESH_FRAME_LENGTH_LIMIT
+                                                 - KMESH_FRAME_HEADER_LENGTH + 1U));
+  header->type = (uint8_t)(value & KMESH_FRAME_TYPE_MASK);
+  header->flags = (uint8_t)(value & KMESH_FRAME_FLAGS_MASK);
+  header->sequence = (uint8_t)(value >> 8);
+  header->hop_limit = (uint8_t)(value >> 16);
+  value = random_next();
+  header->destination = (uint16_t)value;
+  header->source = (uint16_t)(value >> 16);
+  header->next_hop = (uint16_t)random_next();
+}
+
+static bool same_header(const kmesh_frame_header_t *a, const kmesh_frame_header_t *b)
+{
+  return a->length == b->length && a->type == b->type && a->flags == b->flags
+         && a->sequence == b->sequence && a->destination == b->destination
+         && a->source == b->source && a->next_hop == b->next_hop
+         && a->hop_limit == b->hop_limit;
+}
+
+static int selftest(void)
+{
+  static uint8_t frame[MAX_FRAME_LENGTH];
+  const uint8_t expected_header[KMESH_FRAME_HEADER_LENGTH] = {
+    0x00, 0x12, 0x12, 0xA5, 0x12, 0x34, 0xBE, 0xEF, 0xFF, 0xFF, 0x07
+  };
+  const uint8_t expected_message[KMESH_AGGR_HEADER_LENGTH] = {
+    0xCA, 0xFE, 0x00, 0x01, 0x03, 0x2A
+  };
+  const kmesh_frame_header_t header = {
+    .length = 20U, .type = KMESH_FRAME_TYPE_ACK, .flags = KMESH_FRAME_FLAG_ACK_REQUEST,
+    .sequence = 0xA5U, .destination = 0x1234U, .source = 0xBEEFU,
+    .next_hop = KMESH_ADDRESS_BROADCAST, .hop_limit = 7U
+  };
+  const kmesh_aggr_message_t message = {
+    .destination = 0xCAFEU, .source = 0x0001U, .hop_limit = 3U, .length = 42U
+  };
+  kmesh_frame_header_t decoded;
+  kmesh_aggr_message_t decoded_message;
+  int failures = 0;
+
+  // Known bytes, both ways.
+  memset(frame, 0, sizeof(frame));
+  if (!kmesh_frame_encode_header(frame, &header)
+      || memcmp(frame, expected_header, sizeof(expected_header)) != 0) {
+    printf("FAIL header encoding\n");
+    failures++;
+  }
+  if (!kmesh_frame_decode_header(expected_header, header.length, &decoded)
+      || !same_header(&decoded, &header)) {
+    printf("FAIL header decoding\n");
+    failures++;
+  }
+  kmesh_aggr_encode_message(frame, &message);
+  kmesh_aggr_decode_message(expected_message, &decoded_message);
+  if (memcmp(frame, expected_message, sizeof(expected_message)) != 0
+      || memcmp(&decoded_message, &message, sizeof(message)) != 0) {
+    printf("FAIL aggregate message\n");
+    failures++;
+  }
+
+  // Every length the header can carry, and the ones just outside.
+  for (uint32_t length = 0U; length <= KMESH_FRAME_LENGTH_LIMIT + 1U; length++) {
+    bool representable = (length >= KMESH_FRAME_LENGTH_HEADER
+                          && length <= KMESH_FRAME_LENGTH_LIMIT);
+
+    memset(frame, 0x5A, KMESH_FRAME_LENGTH_HEADER);
+    if (kmesh_frame_encode_length(frame, (uint16_t)length) != representable) {
+      printf("FAIL length %lu accepted %d\n", (unsigned long)length, !representable);
+      failures++;
+    } else if (representable ? (kmesh_frame_decode_length(frame) != length)
+               : (frame[0] != 0x5AU || frame[1] != 0x5AU)) {
+      printf("FAIL length %lu round trip\n", (unsigned long)length);
+      failures++;
+    }
+  }
+
+  // The flag bits above the 11-bit length must not leak into it.
+  frame[0] = 0xF8U;
+  frame[1] = 0x09U;
+  if (kmesh_frame_decode_length(frame) != 11U) {
+    printf("FAIL length with reserved bits set\n");
+    failures++;
+  }
+
+  // Headers too short for the kmesh fields, or disagreeing with what arrived.
+  {
+    kmesh_frame_header_t short_header = header;
+    short_header.length = KMESH_FRAME_HEADER_LENGTH - 1U;
+    if (kmesh_frame_encode_header(frame, &short_header)) {
+      printf("FAIL short header encoded\n");
+      failures++;
+    }
+  }
+  (void) kmesh_frame_encode_header(frame, &header);
+  if (kmesh_frame_decode_header(frame, header.length - 1U, &decoded)
+      || kmesh_frame_decode_header(frame, header.length + 1U, &decoded)) {
+    printf("FAIL header accepted with the wrong received length\n");
+    failures++;
+  }
+
+  // Random headers round trip.
+  random_state = 1U;
+  for (uint32_t i = 0U; i < 100000U; i++) {
+    kmesh_frame_header_t original;
+    random_header(&original);
+    if (!kmesh_frame_encode_header(frame, &original)
+        || !kmesh_frame_decode_header(frame, original.length, &decoded)
+        || !same_header(&decoded, &original)) {
+      printf("FAIL header round trip %lu\n", (unsigned long)i);
+      failures++;
+      break;
+    }
+  }
+
+  printf("selftest: %s\n", (failures == 0) ? "PASS" : "FAIL");
+  return (failures == 0) ? 0 : 1;
+}
+
+static int fuzz(uint32_t iterations, uint32_t seed)
+{
+  static uint8_t frame[MAX_FRAME_LENGTH];
+  static uint8_t reencoded[MAX_FRAME_LENGTH];
+  uint32_t accepted = 0U;
+  uint32_t messages = 0U;
+  int failures = 0;
+
+  random_state = (seed != 0U) ? seed : 1U;
+  for (uint32_t i = 0U; i < iterations && failures == 0; i++) {
+    kmesh_frame_header_t header;
+    uint16_t received_length;
+    bool valid;
+
+    for (size_t j = 0U; j < KMESH_FRAME_HEADER_LENGTH; j++) {
+      frame[j] = (uint8_t)random_next();
+    }
+    // Half the time make the length header agree, so decoding gets past it.
+    if ((random_next() & 1U) != 0U) {
+      received_length = kmesh_frame_decode_length(frame);
+    } else {
+      received_length = (uint16_t)(random_next() % (MAX_FRAME_LENGTH + 1U));
+    }
+    valid = received_length >= KMESH_FRAME_HEADER_LENGTH
+            && kmesh_frame_decode_length(frame) == received_length;
+    if (kmesh_frame_decode_header(frame, received_length, &header) != valid) {
+      printf("FAIL iteration %lu: received length %u %s\n", (unsigned long)i,
+             received_length, valid ? "rejected" : "accepted");
+      failures++;
+      break;
+    }
+    if (!valid) {
+      continue;
+    }
+    accepted++;
+
+    // Only the reserved length bits may differ after re-encoding.
+    if (!kmesh_frame_encode_header(reencoded, &header)
+        || (reencoded[0] ^ frame[0]) != (frame[0] & ~(KMESH_FRAME_LENGTH_MASK >> 8))
+        || memcmp(&reencoded[1], &frame[1], KMESH_FRAME_HEADER_LENGTH - 1U) != 0) {
+      printf("FAIL iteration %lu: re-encoded header differs\n", (unsigned long)i);
+      failures++;
+      break;
+    }
+
+    // Walk the payload as aggregate messages, the way kmesh_aggr.c does.
+    for (uint16_t j = KMESH_FRAME_HEADER_LENGTH; j < header.length; j++) {
+      frame[j] = (uint8_t)random_next();
+    }
+    for (uint16_t offset = KMESH_FRAME_HEADER_LENGTH;
+         offset + KMESH_AGGR_HEADER_LENGTH <= header.length; ) {
+      kmesh_aggr_message_t message;
+      kmesh_aggr_decode_message(&frame[offset], &message);
+      kmesh_aggr_encode_message(reencoded, &message);
+      if (memcmp(reencoded, &frame[offset], KMESH_AGGR_HEADER_LENGTH) != 0) {
+        printf("FAIL iteration %lu: aggregate message at %u\n", (unsigned long)i, offset);
+        failures++;
+        break;
+      }
+      messages++;
+      offset += KMESH_AGGR_HEADER_LENGTH + message.length;
+    }
+  }
+  printf("fuzz: %lu iterations, %lu headers and %lu messages accepted: %s\n",
+         (unsigned long)iterations, (unsigned long)accepted,
+         (unsigned long)messages, (failures == 0) ? "PASS" : "FAIL");
+  return (failures == 0) ? 0 : 1;
+}
+
+static double seconds_since(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void bench(size_t megaframes)
+{
+  // A spread of headers, so the loop does not collapse to one constant.
+  static kmesh_frame_header_t headers[256];
+  static uint8_t frames[256][KMESH_FRAME_HEADER_LENGTH];
+  size_t rounds = megaframes * 1000000U;
+  double millions = (double)rounds / 1e6;
+  volatile uint32_t sink = 0U;
+  kmesh_frame_header_t decoded = { 0 };
+  clock_t start;
+
+  random_state = 1U;
+  for (size_t i = 0U; i < 256U; i++) {
+    random_header(&headers[i]);
+    (void) kmesh_frame_encode_header(frames[i], &headers[i]);
+  }
+  printf("%zu million headers\n", megaframes);
+
+  start = clock();
+  for (size_t i = 0U; i < rounds; i++) {
+    uint8_t *frame = frames[i & 0xFFU];
+    (void) kmesh_frame_encode_header(frame, &headers[i & 0xFFU]);
+    sink ^= frame[KMESH_FRAME_OFFSET_SEQUENCE];
+  }
+  printf("  encode header  %8.1f M/s\n", millions / seconds_since(start));
+
+  start = clock();
+  for (size_t i = 0U; i < rounds; i++) {
+    const uint8_t *frame = frames[i & 0xFFU];
+    sink ^= kmesh_frame_decode_header(frame, headers[i & 0xFFU].length, &decoded);
+    sink ^= decoded.source;
+  }
+  printf("  decode header  %8.1f M/s\n", millions / seconds_since(start));
+
+  start = clock();
+  for (size_t i = 0U; i < rounds; i++) {
+    sink ^= kmesh_frame_decode_length(frames[i & 0xFFU]);
+  }
+  printf("  decode length  %8.1f M/s\n", millions / seconds_since(start));
+
+  (void) sink;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc >= 2 && strcmp(argv[1], "selftest") == 0) {
+    return selftest();
+  }
+  if (argc >= 2 && strcmp(argv[1], "fuzz") == 0) {
+    uint32_t iterations = (argc >= 3) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1000000U;
+    uint32_t seed = (argc >= 4) ? (uint32_t)strtoul(argv[3], NULL, 0) : 1U;
+    return fuzz(iterations, seed);
+  }
+  if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+    size_t megaframes = (argc >= 3) ? strtoul(argv[2], NULL, 0) : 100U;
+    if (megaframes == 0U) {
+      fprintf(stderr, "megaframes must be non-zero\n");
+      return 2;
+    }
+    bench(megaframes);
+    return 0;
+  }
+  fprintf(stderr,
+          "usage: %s selftest\n"
+          "       %s fuzz [iterations] [seed]\n"
+          "       %s bench [megaframes]\n",
+          argv[0], argv[0], argv[0]);
+  return 2;
+}
@@ -0,0 +1,41 @@
+# RAM/flash budget report from the linker map, see tools/kmesh_mem_report.c.
+#
+# After building the firmware with the generated makefile:
+#
+#   make -f tools/kmesh_mem.mk                  write the report, diff it
+#   make -f tools/kmesh_mem.mk mem-baseline     accept the current report
+#
+# or chain it onto the build:
+#
+#   make -f rail_soc_railtest_kmesh.Makefile -f tools/kmesh_mem.mk all mem-report
+#
+# mem-report fails if RAM grew against the baseline by more than
+# KMESH_MEM_THRESHOLD bytes. Simplicity Studio builds write the map next to
+# the .out file; point KMESH_MEM_MAP there.
+
+KMESH_MEM_MAP ?= build/debug/rail_soc_railtest_kmesh.map
+KMESH_MEM_REPORT ?= $(KMESH_MEM_MAP:.map=.mem.csv)
+KMESH_MEM_BASELINE ?= tools/kmesh_mem_baseline.csv
+KMESH_MEM_THRESHOLD ?= 0
+KMESH_MEM_TOOL ?= build/host/kmesh_mem_report
+HOST_CC ?= gcc
+
+.PHONY: mem-report mem-baseline
+
+mem-report: $(KMESH_MEM_REPORT)
+	@if [ -f $(KMESH_MEM_BASELINE) ]; then \
+	  $(KMESH_MEM_TOOL) diff --threshold $(KMESH_MEM_THRESHOLD) \
+	    $(KMESH_MEM_BASELINE) $(KMESH_MEM_REPORT); \
+	else \
+	  echo "No $(KMESH_MEM_BASELINE) yet, run mem-baseline to create it"; \
+	fi
+
+mem-baseline: $(KMESH_MEM_REPORT)
+	cp $(KMESH_MEM_REPORT) $(KMESH_MEM_BASELINE)
+
+$(KMESH_MEM_REPORT): $(KMESH_MEM_MAP) $(KMESH_MEM_TOOL)
+	$(KMESH_MEM_TOOL) report $(KMESH_MEM_MAP) > $@.tmp && mv $@.tmp $@
+
+$(KMESH_MEM_TOOL): tools/kmesh_mem_report.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) -O2 -o $@ $<
@@ -0,0 +1,481 @@
+/***************************************************************************//**
+ * @file kmesh_mem_report.c
+ * @brief Host RAM/flash budget report from the GNU ld map file.
+ *
+ * Build from the project root:
+ *
+ *   gcc -O2 -o kmesh_mem_report tools/kmesh_mem_report.c
+ *
+ * or let tools/kmesh_mem.mk build and run it after each firmware build.
+ *
+ * Usage:
+ *
+ *   kmesh_mem_report report <image.map>
+ *   kmesh_mem_report diff [--threshold bytes] [--flash] <old.csv> <new.csv>
+ *
+ * report writes CSV to stdout, one row per line:
+ *
+ *   kind,name,ram,flash
+ *   capacity,memory,65536,516096      RAM and FLASH region lengths
+ *   total,image,<ram>,<flash>         everything placed in the regions
+ *   total,stack,<ram>,0               the .stack section (SL_STACK_SIZE)
+ *   total,free,<ram>,0                RAM left over for the heap
+ *   module,<module>,<ram>,<flash>     per module, see module_rules[]
+ *   symbol,<module>:<name>,<ram>,<flash>
+ *
+ * Initialised data counts against both RAM and flash. Symbol rows are only
+ * produced for RAM objects in their own section (-fdata-sections, which the
+ * SDK build uses), e.g. symbol,railtest:protocolAccelerationBuffer. Linker
+ * padding is reported as module (fill).
+ *
+ * diff prints every row whose numbers changed, marking rows whose RAM grew
+ * by more than the threshold (default 0) with GREW, and exits non-zero if
+ * any row is marked. --flash applies the same check to flash.
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE_LENGTH  1024U
+#define MAX_NAME_LENGTH  128U
+#define MAX_ROWS         4096U
+
+typedef struct row {
+  char kind[16];
+  char name[MAX_NAME_LENGTH];
+  unsigned long ram;
+  unsigned long flash;
+} row_t;
+
+typedef struct region {
+  unsigned long origin;
+  unsigned long length;
+} region_t;
+
+typedef struct module_rule {
+  const char *match;
+  const char *module;
+} module_rule_t;
+
+// First match on the object path wins. kmesh objects and archives are named
+// after their file before these are tried.
+static const module_rule_t module_rules[] = {
+  { "/autogen/", "autogen" },
+  { "rail_lib", "rail" },
+  { "/rail_util_", "rail_util" },
+  { "railtest", "railtest" },
+  { "/cli/", "cli" },
+  { "iostream", "iostream" },
+  { "nvm3", "nvm3" },
+  { "power_manager", "power_manager" },
+  { "dmadrv", "dmadrv" },
+  { "sleeptimer", "sleeptimer" },
+  { "emlib", "emlib" },
+  { "/device_init/", "device_init" },
+  { "/Device/", "startup" },
+  { "/platform/", "platform" },
+};
+
+// Toolchain runtime archives, lumped together as libc.
+static const char *const runtime_archives[] = {
+  "libc.a", "libc_nano.a", "libg.a", "libg_nano.a", "libm.a", "libgcc.a",
+  "libnosys.a", "libstdc++.a", "libstdc++_nano.a", "libsupc++.a", "libsupc++_nano.a",
+};
+
+static row_t rows[MAX_ROWS];
+static size_t row_count;
+
+static row_t *find_row(row_t *table, size_t count, const char *kind, const char *name)
+{
+  for (size_t i = 0U; i < count; i++) {
+    if (strcmp(table[i].kind, kind) == 0 && strcmp(table[i].name, name) == 0) {
+      return &table[i];
+    }
+  }
+  return NULL;
+}
+
+static void add_row(const char *kind, const char *name, unsigned long ram,
+                    unsigned long flash)
+{
+  row_t *entry = find_row(rows, row_count, kind, name);
+
+  if (entry == NULL) {
+    if (row_count >= MAX_ROWS) {
+      fprintf(stderr, "too many rows, dropping %s,%s\n", kind, name);
+      return;
+    }
+    entry = &rows[row_count++];
+    snprintf(entry->kind, sizeof(entry->kind), "%s", kind);
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+  }
+  entry->ram += ram;
+  entry->flash += flash;
+}
+
+static void strip_extension(char *name)
+{
+  char *dot = strrchr(name, '.');
+
+  if (dot != NULL) {
+    *dot = '\0';
+  }
+}
+
+// libfoo.a(bar.o) becomes foo; build/debug/kmesh/kmesh_arq.o kmesh_arq.
+static void module_of(const char *path, char *module, size_t size)
+{
+  const char *open = strchr(path, '(');
+  const char *base;
+
+  if (open != NULL) {
+    const char *slash = path;
+    for (const char *at = path; at < open; at++) {
+      if (*at == '/' || *at == '\\') {
+        slash = at + 1;
+      }
+    }
+    for (size_t i = 0U; i < sizeof(runtime_archives) / sizeof(runtime_archives[0]); i++) {
+      if (strlen(runtime_archives[i]) == (size_t)(open - slash)
+          && strncmp(slash, runtime_archives[i], (size_t)(open - slash)) == 0) {
+        snprintf(module, size, "libc");
+        return;
+      }
+    }
+    if (strncmp(slash, "lib", 3U) == 0) {
+      slash += 3;
+    }
+    snprintf(module, size, "%.*s", (int)(open - slash), slash);
+    strip_extension(module);
+    if (strncmp(module, "rail", 4U) == 0) {
+      snprintf(module, size, "rail");
+    }
+    return;
+  }
+  base = strrchr(path, '/');
+  base = (base == NULL) ? path : base + 1;
+  if (strncmp(base, "kmesh", 5U) == 0) {
+    snprintf(module, size, "%s", base);
+    strip_extension(module);
+    return;
+  }
+  if (strcmp(base, "app.o") == 0 || strcmp(base, "main.o") == 0) {
+    snprintf(module, size, "app");
+    return;
+  }
+  for (size_t i = 0U; i < sizeof(module_rules) / sizeof(module_rules[0]); i++) {
+    if (strstr(path, module_rules[i].match) != NULL) {
+      snprintf(module, size, "%s", module_rules[i].module);
+      return;
+    }
+  }
+  snprintf(module, size, "other");
+}
+
+static bool in_region(const region_t *region, unsigned long address)
+{
+  return region->length != 0UL && address >= region->origin
+         && address - region->origin < region->length;
+}
+
+static bool parse_hex(const char *text, unsigned long *value)
+{
+  char *end;
+
+  if (strncmp(text, "0x", 2U) != 0) {
+    return false;
+  }
+  *value = strtoul(text, &end, 16);
+  return end != text + 2;
+}
+
+// Returns what follows the first count whitespace-separated fields.
+static const char *skip_fields(const char *text, int count)
+{
+  for (int i = 0; i < count; i++) {
+    text += strspn(text, " \t");
+    text += strcspn(text, " \t");
+  }
+  return text + strspn(text, " \t");
+}
+
+static void add_input_section(const char *output, const char *input, const char *file_name,
+                              unsigned long ram, unsigned long flash)
+{
+  static const char *const prefixes[] = { ".bss.", ".data.", ".noinit." };
+  char module[MAX_NAME_LENGTH];
+
+  if (strcmp(input, "*fill*") == 0) {
+    snprintf(module, sizeof(module), "(fill)");
+  } else {
+    module_of(file_name, module, sizeof(module));
+  }
+  add_row("total", "image", ram, flash);
+  if (strcmp(output, ".stack") == 0) {
+    add_row("total", "stack", ram, 0UL);
+  }
+  add_row("module", module, ram, flash);
+  for (size_t i = 0U; ram != 0UL && i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+    size_t length = strlen(prefixes[i]);
+    if (strncmp(input, prefixes[i], length) == 0 && input[length] != '\0') {
+      char name[MAX_NAME_LENGTH];
+      snprintf(name, sizeof(name), "%.40s:%.80s", module, &input[length]);
+      add_row("symbol", name, ram, flash);
+    }
+  }
+}
+
+static int kind_rank(const char *kind)
+{
+  static const char *const kinds[] = { "total", "module", "symbol" };
+
+  for (int i = 0; i < 3; i++) {
+    if (strcmp(kind, kinds[i]) == 0) {
+      return i;
+    }
+  }
+  return 3;
+}
+
+// Totals, then modules and symbols, each largest RAM user first.
+static int compare_rows(const void *a, const void *b)
+{
+  const row_t *left = a;
+  const row_t *right = b;
+  int kind = kind_rank(left->kind) - kind_rank(right->kind);
+
+  if (kind != 0) {
+    return kind;
+  }
+  if (left->ram != right->ram) {
+    return (left->ram < right->ram) ? 1 : -1;
+  }
+  return strcmp(left->name, right->name);
+}
+
+static int report(const char *path)
+{
+  FILE *file = fopen(path, "r");
+  char line[MAX_LINE_LENGTH];
+  char output[MAX_NAME_LENGTH] = "";
+  char input[MAX_NAME_LENGTH] = "";
+  region_t ram = { 0 };
+  region_t flash = { 0 };
+  bool in_map = false;
+  bool output_pending = false;
+  bool output_ram = false;
+  bool output_flash = false;
+  unsigned long heap = 0UL;
+  unsigned long used = 0UL;
+
+  if (file == NULL) {
+    perror(path);
+    return 2;
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char first[MAX_NAME_LENGTH] = "";
+    char second[MAX_NAME_LENGTH] = "";
+    char third[MAX_NAME_LENGTH] = "";
+    const char *rest;
+    const char *load;
+    unsigned long address;
+    unsigned long size;
+    int fields;
+
+    line[strcspn(line, "\r\n")] = '\0';
+    if (!in_map) {
+      region_t region;
+      if (sscanf(line, "%127s %lx %lx", first, &region.origin, &region.length) == 3) {
+        if (strcmp(first, "RAM") == 0) {
+          ram = region;
+        } else if (strcmp(first, "FLASH") == 0) {
+          flash = region;
+        }
+      }
+      in_map = (strcmp(line, "Linker script and memory map") == 0);
+      continue;
+    }
+    if (line[0] == '\0') {
+      continue;
+    }
+
+    // Output sections start in column 0. A long name leaves the address and
+    // size to the next line. Sections outside RAM and FLASH (debug info,
+    // /DISCARD/) are skipped with everything in them.
+    if (line[0] != ' ' || output_pending) {
+      if (line[0] != ' ') {
+        fields = sscanf(line, "%127s %127s %127s", first, second, third);
+        snprintf(output, sizeof(output), "%s", first);
+        output_pending = (fields == 1);
+        rest = skip_fields(line, 1);
+      } else {
+        output_pending = false;
+        rest = line;
+      }
+      output_ram = false;
+      output_flash = false;
+      input[0] = '\0';
+      if (sscanf(rest, "%127s %127s", second, third) == 2
+          && parse_hex(second, &address) && parse_hex(third, &size)) {
+        output_ram = in_region(&ram, address);
+        output_flash = in_region(&flash, address);
+        load = strstr(rest, "load address ");
+        if (load != NULL && parse_hex(load + 13, &address)) {
+          output_flash = output_flash || in_region(&flash, address);
+        }
+        // The heap section runs to the end of RAM, so it is what is left.
+        if (strcmp(output, ".heap") == 0 && output_ram) {
+          heap = size;
+        }
+      }
+      continue;
+    }
+    if ((!output_ram && !output_flash) || strcmp(output, ".heap") == 0) {
+      continue;
+    }
+
+    // Input sections start with one space: name, address, size and object.
+    // A long name leaves the rest to a continuation line indented further,
+    // which is told apart from a symbol line by the size field.
+    if (line[1] != ' ') {
+      fields = sscanf(line, " %127s %127s %127s", first, second, third);
+      if (fields == 1) {
+        snprintf(input, sizeof(input), "%s", first);
+        continue;
+      }
+      input[0] = '\0';
+      if (fields < 3 || !parse_hex(second, &address) || !parse_hex(third, &size)) {
+        continue;
+      }
+      rest = skip_fields(line, 3);
+    } else {
+      if (input[0] == '\0' || sscanf(line, " %127s %127s", second, third) != 2
+          || !parse_hex(second, &address) || !parse_hex(third, &size)) {
+        continue;
+      }
+      snprintf(first, sizeof(first), "%s", input);
+      input[0] = '\0';
+      rest = skip_fields(line, 2);
+    }
+    if (size != 0UL) {
+      add_input_section(output, first, rest,
+                        output_ram ? size : 0UL, output_flash ? size : 0UL);
+      used += output_ram ? size : 0UL;
+    }
+  }
+  fclose(file);
+
+  if (ram.length == 0UL || flash.length == 0UL) {
+    fprintf(stderr, "%s: no RAM and FLASH memory configuration found\n", path);
+    return 2;
+  }
+  qsort(rows, row_count, sizeof(rows[0]), compare_rows);
+  printf("kind,name,ram,flash\n");
+  printf("capacity,memory,%lu,%lu\n", ram.length, flash.length);
+  printf("total,free,%lu,0\n",
+         (heap != 0UL) ? heap : ((ram.length > used) ? ram.length - used : 0UL));
+  for (size_t i = 0U; i < row_count; i++) {
+    printf("%s,%s,%lu,%lu\n", rows[i].kind, rows[i].name, rows[i].ram, rows[i].flash);
+  }
+  return 0;
+}
+
+static int load_csv(const char *path, row_t *table, size_t *count)
+{
+  FILE *file = fopen(path, "r");
+  char line[MAX_LINE_LENGTH];
+
+  if (file == NULL) {
+    perror(path);
+    return -1;
+  }
+  *count = 0U;
+  while (fgets(line, sizeof(line), file) != NULL && *count < MAX_ROWS) {
+    row_t *entry = &table[*count];
+    if (sscanf(line, "%15[^,],%127[^,],%lu,%lu", entry->kind, entry->name,
+               &entry->ram, &entry->flash) == 4) {
+      (*count)++;
+    }
+  }
+  fclose(file);
+  return 0;
+}
+
+static int diff(const char *old_path, const char *new_path, long threshold, bool check_flash)
+{
+  static row_t old_rows[MAX_ROWS];
+  size_t old_count;
+  int grew = 0;
+
+  if (load_csv(old_path, old_rows, &old_count) != 0
+      || load_csv(new_path, rows, &row_count) != 0) {
+    return 2;
+  }
+  printf("%-8s %-48s %10s %8s %10s %8s\n", "kind", "name", "ram", "delta", "flash", "delta");
+  for (size_t pass = 0U; pass < 2U; pass++) {
+    row_t *table = (pass == 0U) ? rows : old_rows;
+    size_t count = (pass == 0U) ? row_count : old_count;
+
+    for (size_t i = 0U; i < count; i++) {
+      const row_t *now = (pass == 0U) ? &table[i]
+                         : find_row(rows, row_count, table[i].kind, table[i].name);
+      const row_t *before = (pass == 0U)
+                            ? find_row(old_rows, old_count, table[i].kind, table[i].name)
+                            : &table[i];
+      long ram_delta;
+      long flash_delta;
+      bool flagged;
+
+      if (pass == 1U && now != NULL) {
+        continue;  // Printed in the first pass.
+      }
+      ram_delta = (long)(now ? now->ram : 0UL) - (long)(before ? before->ram : 0UL);
+      flash_delta = (long)(now ? now->flash : 0UL) - (long)(before ? before->flash : 0UL);
+      if (ram_delta == 0L && flash_delta == 0L) {
+        continue;
+      }
+      // Less free RAM is the same growth seen from the other side.
+      if (strcmp(table[i].kind, "total") == 0 && strcmp(table[i].name, "free") == 0) {
+        flagged = false;
+      } else {
+        flagged = ram_delta > threshold || (check_flash && flash_delta > threshold);
+      }
+      grew |= flagged ? 1 : 0;
+      printf("%-8s %-48s %10lu %+8ld %10lu %+8ld%s\n", table[i].kind, table[i].name,
+             now ? now->ram : 0UL, ram_delta, now ? now->flash : 0UL, flash_delta,
+             flagged ? "  GREW" : "");
+    }
+  }
+  return grew;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc == 3 && strcmp(argv[1], "report") == 0) {
+    return report(argv[2]);
+  }
+  if (argc >= 4 && strcmp(argv[1], "diff") == 0) {
+    long threshold = 0L;
+    bool check_flash = false;
+    int i;
+
+    for (i = 2; i < argc - 2; i++) {
+      if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc - 2) {
+        threshold = strtol(argv[++i], NULL, 0);
+      } else if (strcmp(argv[i], "--flash") == 0) {
+        check_flash = true;
+      } else {
+        break;
+      }
+    }
+    if (i == argc - 2) {
+      return diff(argv[argc - 2], argv[argc - 1], threshold, check_flash);
+    }
+  }
+  fprintf(stderr, "usage: %s report <image.map>\n"
+          "       %s diff [--threshold bytes] [--flash] <old.csv> <new.csv>\n",
+          argv[0], argv[0]);
+  return 2;
+}
@@ -0,0 +1,112 @@
+/***************************************************************************//**
+ * @file kmesh_rssi_decode.c
+ * @brief Host decoder for the binary RSSI stream (setRssiStream).
+ *
+ * Build from the project root:
+ *
+ *   gcc -O2 -Ikmesh -o kmesh_rssi_decode tools/kmesh_rssi_decode.c
+ *
+ * Usage:
+ *
+ *   kmesh_rssi_decode [--text] <capture.bin | ->
+ *
+ * Reads a raw serial capture and writes one CSV line per RSSI sample to
+ * stdout, with the sample time derived from the burst timestamp and period.
+ * Bytes that are not part of a burst (text responses, RX log records, the
+ * prompt) are skipped, or copied to stderr with --text. A summary with the
+ * bursts missing from the sequence and the samples the device reported lost
+ * goes to stderr at the end.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KMESH_RXLOG_HOST
+#define KMESH_RSSI_STREAM_HOST
+#include "kmesh_rssi_stream.h"
+
+#define BUFFER_SIZE 8192U
+
+int main(int argc, char **argv)
+{
+  static uint8_t buffer[BUFFER_SIZE];
+  const char *path = NULL;
+  bool echo_text = false;
+  FILE *file;
+  size_t filled = 0U;
+  size_t at = 0U;
+  bool eof = false;
+  bool have_sequence = false;
+  uint16_t next_sequence = 0U;
+  unsigned long bursts = 0UL;
+  unsigned long samples = 0UL;
+  unsigned long missing = 0UL;
+  unsigned long lost = 0UL;
+  unsigned long skipped = 0UL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--text") == 0) {
+      echo_text = true;
+    } else {
+      path = argv[i];
+    }
+  }
+  if (path == NULL) {
+    fprintf(stderr, "usage: %s [--text] <capture.bin | ->\n", argv[0]);
+    return 2;
+  }
+  file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+  if (file == NULL) {
+    perror(path);
+    return 2;
+  }
+
+  printf("burst,time_us,channel,rssi_dbm\n");
+  while (!eof || at < filled) {
+    kmesh_rssi_burst_t burst;
+
+    // Keep at least one maximum-size burst (1024 samples) in the buffer.
+    if (!eof && filled - at < 2048U) {
+      size_t got;
+      memmove(buffer, &buffer[at], filled - at);
+      filled -= at;
+      at = 0U;
+      got = fread(&buffer[filled], 1U, sizeof(buffer) - filled, file);
+      filled += got;
+      eof = (got == 0U);
+      continue;
+    }
+    if (!kmesh_rssi_stream_decode(&buffer[at], filled - at, &burst)) {
+      if (echo_text) {
+        fputc(buffer[at], stderr);
+      }
+      skipped++;
+      at++;
+      continue;
+    }
+
+    if (have_sequence && burst.sequence != next_sequence) {
+      missing += (uint16_t)(burst.sequence - next_sequence);
+    }
+    have_sequence = true;
+    next_sequence = (uint16_t)(burst.sequence + 1U);
+    bursts++;
+    lost += burst.lost;
+
+    for (uint16_t i = 0U; i < burst.sample_count; i++) {
+      printf("%u,%lu,%u,%d\n", burst.sequence,
+             (unsigned long)(uint32_t)(burst.time + (uint32_t)burst.period_us * i),
+             burst.channel, burst.samples[i]);
+    }
+    samples += burst.sample_count;
+    at += (size_t)burst.sample_count + KMESH_RSSI_STREAM_OVERHEAD;
+  }
+  if (file != stdin) {
+    fclose(file);
+  }
+  fprintf(stderr, "bursts: %lu, samples: %lu, missing bursts: %lu, "
+          "lost samples: %lu, other bytes: %lu\n",
+          bursts, samples, missing, lost, skipped);
+  return 0;
+}
@@ -0,0 +1,110 @@
+/***************************************************************************//**
+ * @file kmesh_rxlog_decode.c
+ * @brief Host decoder for the binary RX log (setRxLog).
+ *
+ * Build from the project root:
+ *
+ *   gcc -O2 -Ikmesh -o kmesh_rxlog_decode tools/kmesh_rxlog_decode.c
+ *
+ * Usage:
+ *
+ *   kmesh_rxlog_decode [--text] <capture.bin | ->
+ *
+ * Reads a raw serial capture, e.g. from `cat /dev/ttyACM0 > capture.bin`,
+ * and writes one CSV line per valid record to stdout. Bytes that are not
+ * part of a record (text responses, the prompt) are skipped, or copied to
+ * stderr with --text. A summary with the number of records missing from the
+ * sequence goes to stderr at the end.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KMESH_RXLOG_HOST
+#include "kmesh_rxlog.h"
+
+#define BUFFER_SIZE 4096U
+
+int main(int argc, char **argv)
+{
+  static uint8_t buffer[BUFFER_SIZE];
+  const char *path = NULL;
+  bool echo_text = false;
+  FILE *file;
+  size_t filled = 0U;
+  size_t at = 0U;
+  bool eof = false;
+  bool have_sequence = false;
+  uint16_t next_sequence = 0U;
+  unsigned long records = 0UL;
+  unsigned long missing = 0UL;
+  unsigned long skipped = 0UL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--text") == 0) {
+      echo_text = true;
+    } else {
+      path = argv[i];
+    }
+  }
+  if (path == NULL) {
+    fprintf(stderr, "usage: %s [--text] <capture.bin | ->\n", argv[0]);
+    return 2;
+  }
+  file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+  if (file == NULL) {
+    perror(path);
+    return 2;
+  }
+
+  printf("sequence,time_us,rssi_dbm,lqi,channel,length,crc_ok,ack,truncated,payload\n");
+  while (!eof || at < filled) {
+    kmesh_rxlog_record_t record;
+
+    // Keep at least one maximum-size record in the buffer while reading.
+    if (!eof && filled - at < 255U) {
+      size_t got;
+      memmove(buffer, &buffer[at], filled - at);
+      filled -= at;
+      at = 0U;
+      got = fread(&buffer[filled], 1U, sizeof(buffer) - filled, file);
+      filled += got;
+      eof = (got == 0U);
+      continue;
+    }
+    if (!kmesh_rxlog_decode(&buffer[at], filled - at, &record)) {
+      if (echo_text) {
+        fputc(buffer[at], stderr);
+      }
+      skipped++;
+      at++;
+      continue;
+    }
+
+    if (have_sequence && record.sequence != next_sequence) {
+      missing += (uint16_t)(record.sequence - next_sequence);
+    }
+    have_sequence = true;
+    next_sequence = (uint16_t)(record.sequence + 1U);
+    records++;
+
+    printf("%u,%lu,%d,%u,%u,%u,%u,%u,%u,", record.sequence,
+           (unsigned long)record.time, record.rssi, record.lqi, record.channel,
+           record.packet_length,
+           (record.flags & KMESH_RXLOG_FLAG_CRC_OK) ? 1U : 0U,
+           (record.flags & KMESH_RXLOG_FLAG_ACK) ? 1U : 0U,
+           (record.flags & KMESH_RXLOG_FLAG_TRUNCATED) ? 1U : 0U);
+    for (uint8_t i = 0U; i < record.payload_length; i++) {
+      printf("%02x", record.payload[i]);
+    }
+    printf("\n");
+    at += (size_t)record.payload_length + KMESH_RXLOG_OVERHEAD;
+  }
+  if (file != stdin) {
+    fclose(file);
+  }
+  fprintf(stderr, "records: %lu, missing: %lu, other bytes: %lu\n",
+          records, missing, skipped);
+  return 0;
+}